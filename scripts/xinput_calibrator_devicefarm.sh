@@ -0,0 +1,71 @@
+#!/bin/sh
+# discovery scaling benchmark: time the device discovery against
+# 1 to 512 uinput touchscreens, and plot it
+#
+# usage: xinput_calibrator_devicefarm.sh [<max devices>] [<output prefix>]
+# run as root from the build tree (needs /dev/uinput and Xorg with the
+# dummy video driver and the evdev input driver); writes <prefix>.dat,
+# and <prefix>.png when gnuplot is available
+#
+# Xvfb does not load input drivers, so a headless Xorg is used instead
+
+MAX=${1:-512}
+PREFIX=${2:-devicefarm}
+DISPLAYNR=:99
+SRCDIR=`dirname $0`/../src
+CONF=`mktemp /tmp/xinput_calibrator_devicefarm.XXXXXX`
+
+cat > $CONF <<EOC
+Section "ServerFlags"
+	Option	"AutoAddDevices"	"true"
+EndSection
+Section "Device"
+	Identifier	"dummy"
+	Driver	"dummy"
+EndSection
+Section "Screen"
+	Identifier	"screen"
+	Device	"dummy"
+	SubSection "Display"
+		Modes	"1024x768"
+	EndSubSection
+EndSection
+Section "InputClass"
+	Identifier	"devicefarm"
+	MatchProduct	"xinput_calibrator farm"
+	Driver	"evdev"
+EndSection
+EOC
+
+Xorg $DISPLAYNR -config $CONF -noreset -nolisten tcp -logfile /tmp/xinput_calibrator_devicefarm.log &
+XPID=$!
+sleep 2
+
+DISPLAY=$DISPLAYNR $SRCDIR/xinput_calibrator_devicefarm --max $MAX \
+    --calibrator $SRCDIR/xinput_calibrator > $PREFIX.dat
+RESULT=$?
+
+kill $XPID
+rm -f $CONF
+if [ $RESULT -ne 0 ] ; then
+  echo "Benchmark failed (Xorg log in /tmp/xinput_calibrator_devicefarm.log)"
+  exit $RESULT
+fi
+echo "Timings in $PREFIX.dat"
+
+if which gnuplot > /dev/null 2>&1 ; then
+  gnuplot <<EOP
+set terminal png size 800,600
+set output "$PREFIX.png"
+set logscale xy
+set xlabel "devices"
+set ylabel "time (us)"
+set key top left
+plot "$PREFIX.dat" using 1:2 with linespoints title "find_device (name)", \
+     "" using 1:3 with linespoints title "find_device (id)", \
+     "" using 1:4 with linespoints title "is_sysfs_name", \
+     "" using 1:5 with linespoints title "make_calibrator", \
+     "" using 1:6 with linespoints title "--list"
+EOP
+  echo "Plot in $PREFIX.png"
+fi
@@ -0,0 +1,37 @@
+#!/bin/sh
+# tap-to-feedback latency benchmark: tap the targets of each given
+# xinput_calibrator build with XTest, under Xvfb, and compare
+#
+# usage: xinput_calibrator_latency.sh [-r <runs>] <xinput_calibrator>...
+# e.g. one build configured --with-gui=x11 and one --with-gui=gtkmm;
+# run from the build tree, prints the latency distribution of each
+# stage per build, in us
+
+RUNS=25
+if [ "$1" = "-r" ] ; then
+  RUNS=$2
+  shift 2
+fi
+if [ $# -eq 0 ] ; then
+  echo "usage: $0 [-r <runs>] <xinput_calibrator>..."
+  exit 1
+fi
+DISPLAYNR=:98
+SRCDIR=`dirname $0`/../src
+
+Xvfb $DISPLAYNR -screen 0 1024x768x24 -nolisten tcp > /tmp/xinput_calibrator_latency.log 2>&1 &
+XPID=$!
+sleep 2
+
+RESULT=0
+for CALIBRATOR in "$@" ; do
+  DISPLAY=$DISPLAYNR $SRCDIR/xinput_calibrator_latency --runs $RUNS \
+      --calibrator $CALIBRATOR || RESULT=1
+  echo
+done
+
+kill $XPID
+if [ $RESULT -ne 0 ] ; then
+  echo "Benchmark failed (Xvfb log in /tmp/xinput_calibrator_latency.log)"
+fi
+exit $RESULT
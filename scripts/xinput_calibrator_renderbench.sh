@@ -0,0 +1,55 @@
+#!/bin/sh
+# render throughput benchmark: drive expose, tap and timer cycles of each
+# given xinput_calibrator build under Xvfb, from 800x480 up to 7680x4320
+#
+# usage: xinput_calibrator_renderbench.sh [-c <cycles>] <xinput_calibrator>...
+# e.g. one build configured --with-gui=x11 and one --with-gui=gtkmm;
+# run from the build tree, writes renderbench-<n>.dat for the n-th build:
+#   WxH kind cycles cycles/s render_p50 render_p90 server_cpu client_cpu bytes
+# (render times and CPU time per cycle in us, bytes sent per cycle)
+
+CYCLES=200
+if [ "$1" = "-c" ] ; then
+  CYCLES=$2
+  shift 2
+fi
+if [ $# -eq 0 ] ; then
+  echo "usage: $0 [-c <cycles>] <xinput_calibrator>..."
+  exit 1
+fi
+SIZES="800x480 1024x600 1280x800 1920x1080 3840x2160 7680x4320"
+DISPLAYNR=:97
+SRCDIR=`dirname $0`/../src
+
+N=0
+for CALIBRATOR in "$@" ; do
+  N=`expr $N + 1`
+  rm -f renderbench-$N.dat
+done
+
+RESULT=0
+for SIZE in $SIZES ; do
+  Xvfb $DISPLAYNR -screen 0 ${SIZE}x24 -nolisten tcp > /tmp/xinput_calibrator_renderbench.log 2>&1 &
+  XPID=$!
+  sleep 2
+
+  N=0
+  for CALIBRATOR in "$@" ; do
+    N=`expr $N + 1`
+    DISPLAY=$DISPLAYNR $SRCDIR/xinput_calibrator_renderbench --cycles $CYCLES \
+        --calibrator $CALIBRATOR --server-pid $XPID >> renderbench-$N.dat || RESULT=1
+  done
+
+  kill $XPID
+  wait $XPID 2> /dev/null
+  if [ $RESULT -ne 0 ] ; then
+    echo "Benchmark failed at $SIZE (Xvfb log in /tmp/xinput_calibrator_renderbench.log)"
+    exit $RESULT
+  fi
+done
+
+N=0
+for CALIBRATOR in "$@" ; do
+  N=`expr $N + 1`
+  echo "$CALIBRATOR: renderbench-$N.dat"
+done
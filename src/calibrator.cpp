@@ -28,21 +28,27 @@
 #include <fstream>
 #include <cstring>
 #include <cmath>
+#include <time.h>
 
 #include "calibrator.hh"
+#include "calibrator/FinishPipeline.hpp"
+#include "correction.hh"
+#include "recording.hh"
+#include "shm_publish.hh"
 
-// static instances
-bool Calibrator::verbose = false;
-const char* Calibrator::SYSFS_INPUT="/sys/class/input";
-const char* Calibrator::SYSFS_DEVNAME="device/name";
-
+const char* const backend_names[NUM_BACKENDS] = {
+    "generic", "evdev", "usbtouchscreen"
+};
 
 Calibrator::Calibrator(const char* const device_name0, const XYinfo& axys0,
     const int thr_misclick, const int thr_doubleclick,
     const OutputType output_type0, const char* geometry0,
-    const bool use_timeout0, const char* output_filename0)
-: device_name(device_name0),
+    const bool use_timeout0, const char* output_filename0,
+    const CalibratorContext& context0)
+: device_name(device_name0), context(context0),
     threshold_doubleclick(thr_doubleclick), threshold_misclick(thr_misclick),
+    threshold_verify(0), verify_grid(0), correction_output(NULL), publish_shm(false),
+    recorder(NULL), latency_trace(NULL),
     output_type(output_type0), geometry(geometry0), use_timeout(use_timeout0),
     output_filename(output_filename0)
 {
@@ -53,6 +59,59 @@ Calibrator::Calibrator(const char* const device_name0, const XYinfo& axys0,
     //clicked.y(NUM_POINTS);
 }
 
+Calibrator::~Calibrator()
+{
+    delete recorder;
+    if (latency_trace != NULL)
+        fclose(latency_trace);
+}
+
+void Calibrator::reset()
+{
+    if (recorder != NULL)
+        recorder->reset();
+
+    clicked.num = 0; clicked.x.clear(); clicked.y.clear();
+    verified.x.clear(); verified.y.clear();
+}
+
+bool Calibrator::set_record_output(const char* filename)
+{
+    delete recorder;
+    recorder = new SessionRecorder();
+    if (!recorder->open(filename, device_name.c_str(), get_backend(), old_axys,
+                        threshold_misclick, threshold_doubleclick)) {
+        delete recorder;
+        recorder = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool Calibrator::set_latency_trace(const char* filename)
+{
+    if (latency_trace != NULL)
+        fclose(latency_trace);
+    latency_trace = fopen(filename, "w");
+    if (latency_trace == NULL) {
+        fprintf(stderr, "Error: Can't open '%s' for writing. Make sure you have the necessary rights\n", filename);
+        return false;
+    }
+    return true;
+}
+
+void Calibrator::trace_latency(const char* stage) const
+{
+    if (latency_trace == NULL)
+        return;
+
+    // CLOCK_MONOTONIC in us, comparable with the injecting process
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    fprintf(latency_trace, "%s %ld\n", stage, now.tv_sec*1000000L + now.tv_nsec/1000);
+    fflush(latency_trace);
+}
+
 bool Calibrator::add_click(int x, int y)
 {
     // Double-click detection
@@ -61,10 +120,12 @@ bool Calibrator::add_click(int x, int y)
         while (i >= 0) {
             if (abs(x - clicked.x[i]) <= threshold_doubleclick
                 && abs(y - clicked.y[i]) <= threshold_doubleclick) {
-                if (verbose) {
+                if (context.verbose) {
                     printf("DEBUG: Not adding click %i (X=%i, Y=%i): within %i pixels of previous click\n",
                          clicked.num, x, y, threshold_doubleclick);
                 }
+                if (recorder != NULL)
+                    recorder->click(x, y, CLICK_DOUBLECLICK);
                 return false;
             }
             i--;
@@ -82,7 +143,7 @@ bool Calibrator::add_click(int x, int y)
                         along_axis(y,clicked.x[UL],clicked.y[UL]))
                 {
                     misclick = false;
-                } else if (verbose) {
+                } else if (context.verbose) {
                     printf("DEBUG: Mis-click detected, click %i (X=%i, Y=%i) not aligned with click 0 (X=%i, Y=%i) (threshold=%i)\n",
                             clicked.num, x, y, clicked.x[UL], clicked.y[UL], threshold_misclick);
                 }
@@ -96,7 +157,7 @@ bool Calibrator::add_click(int x, int y)
                             && along_axis( clicked.y[UR], clicked.x[UL], clicked.y[UL])))
                 {
                     misclick = false;
-                } else if (verbose) {
+                } else if (context.verbose) {
                     printf("DEBUG: Mis-click detected, click %i (X=%i, Y=%i) not aligned with click 0 (X=%i, Y=%i) or click 1 (X=%i, Y=%i) (threshold=%i)\n",
                             clicked.num, x, y, clicked.x[UL], clicked.y[UL], clicked.x[UR], clicked.y[UR], threshold_misclick);
                 }
@@ -110,13 +171,15 @@ bool Calibrator::add_click(int x, int y)
                             &&  along_axis( x, clicked.x[LL], clicked.y[LL]) ) )
                 {
                     misclick = false;
-                } else if (verbose) {
+                } else if (context.verbose) {
                     printf("DEBUG: Mis-click detected, click %i (X=%i, Y=%i) not aligned with click 1 (X=%i, Y=%i) or click 2 (X=%i, Y=%i) (threshold=%i)\n",
                             clicked.num, x, y, clicked.x[UR], clicked.y[UR], clicked.x[LL], clicked.y[LL], threshold_misclick);
                 }
         }
 
         if (misclick) {
+            if (recorder != NULL)
+                recorder->click(x, y, CLICK_MISCLICK);
             reset();
             return false;
         }
@@ -126,8 +189,10 @@ bool Calibrator::add_click(int x, int y)
     clicked.y.push_back(y);
     clicked.num++;
 
-    if (verbose)
+    if (context.verbose)
         printf("DEBUG: Adding click %i (X=%i, Y=%i)\n", clicked.num-1, x, y);
+    if (recorder != NULL)
+        recorder->click(x, y, CLICK_ACCEPTED);
 
     return true;
 }
@@ -140,64 +205,337 @@ inline bool Calibrator::along_axis(int xy, int x0, int y0)
 
 bool Calibrator::finish(int width, int height)
 {
+    if (recorder != NULL)
+        recorder->finish(width, height);
+
     if (get_numclicks() != NUM_POINTS) {
         return false;
     }
 
-    // new axis origin and scaling
-    // based on old_axys: inversion/swapping is relative to the old axis
-    XYinfo new_axis(old_axys);
+    // finish the data, driver/calibrator specific
+    return apply_calibration(calc_new_axys(old_axys, &clicked.x[0], &clicked.y[0],
+                                           width, height));
+}
+
+static const OrientationInfo orientation_infos[NUM_ORIENTATIONS] = {
+    // name                            swap_xy invert_x invert_y
+    { "normal",                         false, false, false },
+    { "mirrored horizontally",          false, true,  false },
+    { "mirrored vertically",            false, false, true  },
+    { "rotated 180 degrees",            false, true,  true  },
+    { "mirrored along the diagonal",    true,  false, false },
+    { "rotated 90 degrees clockwise",   true,  false, true  },
+    { "rotated 90 degrees counter-clockwise", true, true, false },
+    { "mirrored along the anti-diagonal", true, true, true  },
+};
+
+const OrientationInfo& get_orientation_info(Orientation orientation)
+{
+    return orientation_infos[orientation];
+}
+
+/*
+ * Going right from the left targets to the right ones, and down from the
+ * upper targets to the lower ones, the clicks move along one screen axis
+ * each. Which one (swapped or not) and in which direction gives the
+ * orientation, looked up by [swapped][right is negative][down is negative].
+ *
+ * Every click counts, so one bad click can not flip the axes as long as
+ * the others agree.
+ */
+static const Orientation orientation_table[2][2][2] = {
+    { { ORIENT_NORMAL, ORIENT_MIRROR_Y }, { ORIENT_MIRROR_X, ORIENT_ROTATE_180 } },
+    { { ORIENT_TRANSPOSE, ORIENT_ROTATE_90_CW }, { ORIENT_ROTATE_90_CCW, ORIENT_ANTITRANSPOSE } },
+};
+
+Orientation detect_orientation(const int* x, const int* y)
+{
+    const int right_x = (x[UR] - x[UL]) + (x[LR] - x[LL]);
+    const int right_y = (y[UR] - y[UL]) + (y[LR] - y[LL]);
+    const int down_x = (x[LL] - x[UL]) + (x[LR] - x[UR]);
+    const int down_y = (y[LL] - y[UL]) + (y[LR] - y[UR]);
+
+    const bool swapped = abs(right_y) + abs(down_x) > abs(right_x) + abs(down_y);
+    const int right = swapped ? right_y : right_x;
+    const int down = swapped ? down_x : down_y;
+    return orientation_table[swapped][right < 0][down < 0];
+}
 
+/*
+ * RandR turns the picture, not the touchscreen: with rotation r, the point
+ * (u, v) of the screen (both in 0..1) shows on the panel where (u, v)
+ * turned by screen_orientation(r) is. Reflections come after the rotation.
+ */
+static Orientation screen_orientation(int rotation)
+{
+    OrientationInfo turn = get_orientation_info(ORIENT_NORMAL);
+    if (rotation & SCREEN_ROTATE_90)
+        turn = get_orientation_info(ORIENT_ROTATE_90_CW);
+    else if (rotation & SCREEN_ROTATE_180)
+        turn = get_orientation_info(ORIENT_ROTATE_180);
+    else if (rotation & SCREEN_ROTATE_270)
+        turn = get_orientation_info(ORIENT_ROTATE_90_CCW);
+    if (rotation & SCREEN_REFLECT_X)
+        turn.invert_x = !turn.invert_x;
+    if (rotation & SCREEN_REFLECT_Y)
+        turn.invert_y = !turn.invert_y;
+
+    for (int o = 0; o != NUM_ORIENTATIONS; o++) {
+        const OrientationInfo& info = get_orientation_info((Orientation) o);
+        if (info.swap_xy == turn.swap_xy && info.invert_x == turn.invert_x &&
+            info.invert_y == turn.invert_y)
+            return (Orientation) o;
+    }
+    return ORIENT_NORMAL;
+}
 
-    // calculate average of clicks
-    float x_min = (clicked.x[UL] + clicked.x[LL])/2.0;
-    float x_max = (clicked.x[UR] + clicked.x[LR])/2.0;
-    float y_min = (clicked.y[UL] + clicked.y[UR])/2.0;
-    float y_max = (clicked.y[LL] + clicked.y[LR])/2.0;
+/// swap then invert (u, v), or the other way around to undo it
+static void turn_point(Orientation orientation, bool undo, double& u, double& v)
+{
+    const OrientationInfo& info = get_orientation_info(orientation);
+    if (info.swap_xy && !undo)
+        std::swap(u, v);
+    if (info.invert_x)
+        u = 1 - u;
+    if (info.invert_y)
+        v = 1 - v;
+    if (info.swap_xy && undo)
+        std::swap(u, v);
+}
 
-    // Should x and y be swapped?
-    if (abs(clicked.x[UL] - clicked.x[UR]) < abs(clicked.y[UL] - clicked.y[UR])) {
-        new_axis.swap_xy = !new_axis.swap_xy;
-        std::swap(x_min, y_min);
-        std::swap(x_max, y_max);
+XYinfo Calibrator::rederive_axys(const XYinfo& axys, int old_rotation, int new_rotation) const
+{
+    // the driver scales to the whole screen, so only the turn matters:
+    // a large square screen keeps the rounding of the clicks small
+    // the finish pipeline puts the targets one block in from 0 and size:
+    // the last pixel of the GUI layout on a screen one pixel larger
+    const int size = num_blocks*8192;
+
+    int x[NUM_POINTS], y[NUM_POINTS];
+    for (int i = 0; i != NUM_POINTS; i++) {
+        // where target i shows on the panel, and where that was on the old screen
+        int tx, ty;
+        get_calibration_target(i, size + 1, size + 1, tx, ty);
+        double u = tx/(double)size, v = ty/(double)size;
+        turn_point(screen_orientation(new_rotation), false, u, v);
+        turn_point(screen_orientation(old_rotation), true, u, v);
+        x[i] = (int) round(u*size);
+        y[i] = (int) round(v*size);
     }
+    return calc_new_axys(axys, x, y, size, size);
+}
 
-    // the screen was divided in num_blocks blocks, and the touch points were at
-    // one block away from the true edges of the screen.
-    const float block_x = width/(float)num_blocks;
-    const float block_y = height/(float)num_blocks;
-    // rescale these blocks from the range of the drawn touchpoints to the range of the 
-    // actually clicked coordinates, and substract/add from the clicked coordinates
-    // to obtain the coordinates corresponding to the edges of the screen.
-    float scale_x = (x_max - x_min)/(width - 2*block_x);
-    x_min -= block_x * scale_x;
-    x_max += block_x * scale_x;
-    float scale_y = (y_max - y_min)/(height - 2*block_y);
-    y_min -= block_y * scale_y;
-    y_max += block_y * scale_y;
-    
-    // now, undo the transformations done by the X server, to obtain the true 'raw' value in X.
-    // The raw value was scaled from old_axis to the device min/max, and from the device min/max
-    // to the screen min/max
-    // hence, the reverse transformation is from screen to old_axis
-    x_min = scaleAxis(x_min, old_axys.x.max, old_axys.x.min, width, 0);
-    x_max = scaleAxis(x_max, old_axys.x.max, old_axys.x.min, width, 0);
-    y_min = scaleAxis(y_min, old_axys.y.max, old_axys.y.min, height, 0);
-    y_max = scaleAxis(y_max, old_axys.y.max, old_axys.y.min, height, 0);
-
-
-    // round and put in new_axis struct
-    new_axis.x.min = round(x_min); new_axis.x.max = round(x_max);
-    new_axis.y.min = round(y_min); new_axis.y.max = round(y_max);
+bool Calibrator::follow_screen_changes()
+{
+    fprintf(stderr, "Error: this calibrator does not apply the calibration dynamically, it can't follow screen changes.\n");
+    return false;
+}
 
-    // finish the data, driver/calibrator specific
-    return finish_data(new_axis);
+XYinfo Calibrator::calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                 int width, int height) const
+{
+    return calc_axys(axys, x, y, width, height);
+}
+
+XYinfo Calibrator::calc_axys(const XYinfo& old_axys, const int* x, const int* y,
+                             int width, int height)
+{
+#ifdef CALIBRATOR_FIXED_POINT
+    return calc_axys_fixed(old_axys, x, y, width, height);
+#else
+    return calc_axys_float(old_axys, x, y, width, height);
+#endif
+}
+
+XYinfo Calibrator::calc_axys_float(const XYinfo& old_axys, const int* x, const int* y,
+                                   int width, int height)
+{
+    return GenericFinish::run<FloatFinishState>(FinishInput(old_axys, x, y, width, height));
+}
+
+/*
+ * calc_axys_float() works in single precision (unit roundoff u = 2^-24).
+ * With S the largest click (plus the screen size, for the evdev inversion):
+ * the extended click is at most 1.2*S and gets at most 5*u*S of error, the
+ * scaling to the old axis multiplies it by |old.max - old.min|/size and
+ * adds at most 3 roundings of the result. All of that stays below
+ * 16*u*(|old.min| + |old.max - old.min|*S/size), and rounding to an integer
+ * is exact, so the float result only differs from the exact one (by one)
+ * if the exact value lies within this bound of a half-integer.
+ */
+double Calibrator::float_tie_bound(const AxisInfo& old, int max_click, int size)
+{
+    const double S = abs(max_click) + (double)abs(size);
+    return 16.0/(1 << 24) * (abs(old.min) + fabs((double)old.max - old.min)*S/abs(size));
+}
+
+XYinfo Calibrator::calc_axys_fixed(const XYinfo& old_axys, const int* x, const int* y,
+                                   int width, int height)
+{
+    return GenericFixedFinish::run<FixedFinishState>(FinishInput(old_axys, x, y, width, height));
+}
+
+bool Calibrator::apply_calibration(const XYinfo& new_axys)
+{
+    calibrated_axys = new_axys;
+    const bool success = finish_data(new_axys);
+    trace_latency("finish");
+    if (recorder != NULL)
+        recorder->result(success, new_axys);
+    if (!success)
+        return false;
+
+    publish_calibration(new_axys);
+    return true;
+}
+
+void Calibrator::publish_calibration(const XYinfo& axys) const
+{
+    if (!publish_shm)
+        return;
+
+    CalibrationPublisher publisher(device_name.c_str());
+    if (publisher.publish(axys) && context.verbose)
+        printf("DEBUG: Published the calibration of '%s' in shared memory\n", device_name.c_str());
+}
+
+void Calibrator::add_verify_click(int x, int y)
+{
+    verified.x.push_back(x);
+    verified.y.push_back(y);
+    if (recorder != NULL)
+        recorder->verify_click(x, y);
+}
+
+void Calibrator::get_verify_target(int i, int width, int height, int& x, int& y) const
+{
+    // the rectangle spanned by the calibration targets
+    int left, top, right, bottom;
+    get_calibration_target(UL, width, height, left, top);
+    get_calibration_target(LR, width, height, right, bottom);
+
+    if (verify_grid > 1) {
+        // rows of targets, spanning the rectangle of the calibration targets
+        const int col = i % verify_grid, row = i / verify_grid;
+        x = left + col * (right - left) / (verify_grid - 1);
+        y = top + row * (bottom - top) / (verify_grid - 1);
+        return;
+    }
+
+    // the middle of each side of that rectangle, and the center of the
+    // screen: none of them were clicked before
+    switch (i) {
+        case 0: x = width/2;  y = top; break;
+        case 1: x = right;    y = height/2; break;
+        case 2: x = width/2;  y = bottom; break;
+        case 3: x = left;     y = height/2; break;
+        default: x = width/2; y = height/2;
+    }
+}
+
+#ifdef CALIBRATOR_FIXED_POINT
+// the scaling of remap_click() as one fraction: p is scaled from 0..size_in
+// to the old axis, that raw value from the new axis to 0..size_out
+static int fixed_remap(int p, const AxisInfo& old, int size_in,
+                       const AxisInfo& calib, int size_out)
+{
+    int64_t den = (int64_t)(calib.max - calib.min)*size_in;
+    int64_t num = ((int64_t)(old.max - old.min)*p +
+                   (int64_t)size_in*(old.min - calib.min))*size_out;
+    if (den == 0) {
+        printf("Divide by Zero in scaleAxis\n");
+        exit(1);
+    }
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+    return div_round(num, den);
+}
+#endif
+
+void Calibrator::remap_click(int& x, int& y, int width, int height) const
+{
+    // same model as finish(): the clicked screen coordinates are scaled back
+    // to raw values using the old axis, each on its own screen axis; when the
+    // new calibration swaps the axes, the raw x value is scaled to the screen
+    // y axis with the new y axis (and the other way around)
+    const bool swap = calibrated_axys.swap_xy != old_axys.swap_xy;
+#ifdef CALIBRATOR_FIXED_POINT
+    const int a = x, b = y;
+    if (swap) {
+        x = fixed_remap(b, old_axys.y, height, calibrated_axys.x, width);
+        y = fixed_remap(a, old_axys.x, width, calibrated_axys.y, height);
+    } else {
+        x = fixed_remap(a, old_axys.x, width, calibrated_axys.x, width);
+        y = fixed_remap(b, old_axys.y, height, calibrated_axys.y, height);
+    }
+#else
+    float a = scaleAxis(x, old_axys.x.max, old_axys.x.min, width, 0);
+    float b = scaleAxis(y, old_axys.y.max, old_axys.y.min, height, 0);
+    if (swap)
+        std::swap(a, b);
+
+    x = round(scaleAxis(a, width, 0, calibrated_axys.x.max, calibrated_axys.x.min));
+    y = round(scaleAxis(b, height, 0, calibrated_axys.y.max, calibrated_axys.y.min));
+#endif
+}
+
+bool Calibrator::verify(int width, int height)
+{
+    const int num = get_num_verify_points();
+    if (get_numverifyclicks() != num) {
+        return false;
+    }
+
+    std::vector<int> xs(num), ys(num), targets_x(num), targets_y(num);
+    float sum_sq = 0, max_err = 0;
+    for (int i = 0; i != num; i++) {
+        int x = verified.x[i];
+        int y = verified.y[i];
+        if (!applies_dynamically())
+            remap_click(x, y, width, height);
+
+        int target_x, target_y;
+        get_verify_target(i, width, height, target_x, target_y);
+
+        const float err = sqrt(float((x - target_x)*(x - target_x) +
+                                     (y - target_y)*(y - target_y)));
+        sum_sq += err*err;
+        max_err = std::max(max_err, err);
+
+        printf("VERIFY: point=%i target_x=%i target_y=%i x=%i y=%i error=%.2f\n",
+               i, target_x, target_y, x, y, err);
+
+        xs[i] = x; ys[i] = y;
+        targets_x[i] = target_x; targets_y[i] = target_y;
+    }
+
+    const float rms = sqrt(sum_sq / num);
+    const bool pass = (threshold_verify <= 0 || rms <= threshold_verify);
+    printf("VERIFY: rms=%.2f max=%.2f threshold=%.2f result=%s\n",
+           rms, max_err, threshold_verify, pass ? "PASS" : "FAIL");
+    if (recorder != NULL)
+        recorder->verified(threshold_verify, verify_grid, pass);
+
+    if (correction_output != NULL) {
+        // the remaining (non-linear) error, on top of the new calibration
+        CorrectionGrid grid;
+        if (!grid.fit(verify_grid, verify_grid, targets_x, targets_y, xs, ys, width, height) ||
+            !grid.save(correction_output)) {
+            fprintf(stderr, "Error: unable to fit the correction grid, NOT saved\n");
+            return false;
+        }
+        printf("Non-linear correction grid written to '%s'\n", correction_output);
+    }
+
+    return pass;
 }
 
 const char* Calibrator::get_sysfs_name()
 {
-    if (is_sysfs_name(device_name))
-        return device_name;
+    if (is_sysfs_name(device_name.c_str()))
+        return device_name.c_str();
 
     // TODO: more mechanisms
 
@@ -205,24 +543,25 @@ const char* Calibrator::get_sysfs_name()
 }
 
 bool Calibrator::is_sysfs_name(const char* name) {
-    DIR* dp = opendir(SYSFS_INPUT);
+    DIR* dp = opendir(context.sysfs_input.c_str());
     if (dp == NULL)
         return false;
 
     while (dirent* ep = readdir(dp)) {
         if (strncmp(ep->d_name, "event", strlen("event")) == 0) {
             // got event name, get its sysfs device name
-            char filename[40]; // actually 35, but hey...
-            (void) sprintf(filename, "%s/%s/%s", SYSFS_INPUT, ep->d_name, SYSFS_DEVNAME);
+            const std::string filename = context.sysfs_input + "/" + ep->d_name +
+                                         "/" + context.sysfs_devname;
 
-            std::ifstream ifile(filename);
+            std::ifstream ifile(filename.c_str());
             if (ifile.is_open()) {
                 if (!ifile.eof()) {
                     std::string devname;
                     std::getline(ifile, devname);
                     if (devname == name) {
-                        if (verbose)
+                        if (context.verbose)
                             printf("DEBUG: Found that '%s' is a sysfs name.\n", name);
+                        (void) closedir(dp);
                         return true;
                     }
                 }
@@ -232,76 +571,12 @@ bool Calibrator::is_sysfs_name(const char* name) {
     }
     (void) closedir(dp);
 
-    if (verbose)
+    if (context.verbose)
         printf("DEBUG: Name '%s' does not match any in '%s/event*/%s'\n",
-                    name, SYSFS_INPUT, SYSFS_DEVNAME);
+                    name, context.sysfs_input.c_str(), context.sysfs_devname.c_str());
     return false;
 }
 
-bool Calibrator::has_xorgconfd_support(Display* dpy) {
-    bool has_support = false;
-
-    Display* display = dpy;
-    if (dpy == NULL) // no connection to reuse
-        display = XOpenDisplay(NULL);
-
-    if (display == NULL) {
-        fprintf(stderr, "Unable to connect to X server\n");
-        exit(1);
-    }
-
-    if (strstr(ServerVendor(display), "X.Org") &&
-        VendorRelease(display) >= 10800000) {
-        has_support = true;
-    }
-
-    if (dpy == NULL) // no connection to reuse
-        XCloseDisplay(display);
-
-    return has_support;
-}
-
-/*
- * FROM xf86Xinput.c
- *
- * Cx     - raw data from touch screen
- * to_max - scaled highest dimension
- *          (remember, this is of rows - 1 because of 0 origin)
- * to_min  - scaled lowest dimension
- * from_max - highest raw value from touch screen calibration
- * from_min  - lowest raw value from touch screen calibration
- *
- * This function is the same for X or Y coordinates.
- * You may have to reverse the high and low values to compensate for
- * different orgins on the touch screen vs X.
- *
- * e.g. to scale from device coordinates into screen coordinates, call
- * xf86ScaleAxis(x, 0, screen_width, dev_min, dev_max);
- */
-int
-xf86ScaleAxis(int Cx, int to_max, int to_min, int from_max, int from_min)
-{
-    int X;
-    int64_t to_width = to_max - to_min;
-    int64_t from_width = from_max - from_min;
-
-    if (from_width) {
-        X = (int) (((to_width * (Cx - from_min)) / from_width) + to_min);
-    }
-    else {
-        X = 0;
-        printf("Divide by Zero in xf86ScaleAxis\n");
-        exit(1);
-    }
-
-    if (X > to_max)
-        X = to_max;
-    if (X < to_min)
-        X = to_min;
-
-    return X;
-}
-
 // same but without rounding to min/max
 float
 scaleAxis(float Cx, int to_max, int to_min, int from_max, int from_min)
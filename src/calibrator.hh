@@ -26,16 +26,58 @@
 #define _calibrator_hh
 
 #include <stdexcept>
-#include <X11/Xlib.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string>
 #include <vector>
 
 // XXX: we currently don't handle lines that are longer than this
 #define MAX_LINE_LEN 1024
 
-int xf86ScaleAxis(int Cx, int to_max, int to_min, int from_max, int from_min);
 float scaleAxis(float Cx, int to_max, int to_min, int from_max, int from_min);
 
+/*
+ * FROM xf86Xinput.c
+ *
+ * Cx     - raw data from touch screen
+ * to_max - scaled highest dimension
+ *          (remember, this is of rows - 1 because of 0 origin)
+ * to_min  - scaled lowest dimension
+ * from_max - highest raw value from touch screen calibration
+ * from_min  - lowest raw value from touch screen calibration
+ *
+ * This function is the same for X or Y coordinates.
+ * You may have to reverse the high and low values to compensate for
+ * different orgins on the touch screen vs X.
+ *
+ * e.g. to scale from device coordinates into screen coordinates, call
+ * xf86ScaleAxis(x, 0, screen_width, dev_min, dev_max);
+ */
+inline int
+xf86ScaleAxis(int Cx, int to_max, int to_min, int from_max, int from_min)
+{
+    int X;
+    int64_t to_width = to_max - to_min;
+    int64_t from_width = from_max - from_min;
+
+    if (from_width) {
+        X = (int) (((to_width * (Cx - from_min)) / from_width) + to_min);
+    }
+    else {
+        X = 0;
+        printf("Divide by Zero in xf86ScaleAxis\n");
+        exit(1);
+    }
+
+    if (X > to_max)
+        X = to_max;
+    if (X < to_min)
+        X = to_min;
+
+    return X;
+}
+
 /*
  * Number of blocks. We partition the screen into 'num_blocks' x 'num_blocks'
  * rectangles of equal size. We then ask the user to press points that are
@@ -102,7 +144,7 @@ struct XYinfo {
         y.max = xf86ScaleAxis(y.max, to.y.max, to.y.min, from.y.max, from.y.min);
     }
 
-    void print(const char* xtra="\n") {
+    void print(const char* xtra="\n") const {
         printf("XYinfo: x.min=%i, x.max=%i, y.min=%i, y.max=%i, swap_xy=%i, invert_x=%i, invert_y=%i%s",
                x.min, x.max, y.min, y.max, swap_xy, x.invert, y.invert, xtra);
     }
@@ -117,6 +159,69 @@ enum {
     NUM_POINTS
 };
 
+/// the screen coordinates of calibration target i (UL, UR, LL or LR) on a
+/// width x height screen: the 'O' of its corner block, as the GUIs draw it
+inline void get_calibration_target(int i, int width, int height, int& x, int& y)
+{
+    const int delta_x = width/num_blocks;
+    const int delta_y = height/num_blocks;
+    x = (i == UR || i == LR) ? width - delta_x - 1 : delta_x;
+    y = (i == LL || i == LR) ? height - delta_y - 1 : delta_y;
+}
+
+/// Number of extra targets shown by default in the verification pass (--verify)
+const int NUM_VERIFY_POINTS = 5;
+
+/// Exit status when the verification pass fails or is aborted
+const int EXIT_VERIFY_FAILED = 3;
+
+/// The calibration routines of the backends, as recorded by --record
+enum CalibratorBackend {
+    BACKEND_GENERIC = 0,    // XorgPrint, and every backend without its own
+    BACKEND_EVDEV,
+    BACKEND_USBTOUCHSCREEN,
+    NUM_BACKENDS
+};
+
+/// "generic", "evdev" and "usbtouchscreen"
+extern const char* const backend_names[NUM_BACKENDS];
+
+/// The eight ways the touch axes can be turned relative to the screen
+/// (the symmetries of a square), as seen in the clicks
+enum Orientation {
+    ORIENT_NORMAL,
+    ORIENT_MIRROR_X,
+    ORIENT_MIRROR_Y,
+    ORIENT_ROTATE_180,
+    ORIENT_TRANSPOSE,       // mirrored along the UL-LR diagonal
+    ORIENT_ROTATE_90_CW,
+    ORIENT_ROTATE_90_CCW,
+    ORIENT_ANTITRANSPOSE,   // mirrored along the UR-LL diagonal
+    NUM_ORIENTATIONS
+};
+
+/// What an orientation takes to correct: swap the axes, then invert
+struct OrientationInfo {
+    const char* name;
+    bool swap_xy, invert_x, invert_y;
+};
+
+const OrientationInfo& get_orientation_info(Orientation orientation);
+
+/// the orientation of the clicks (in the order UL, UR, LL, LR) against
+/// the targets, from all four clicks
+Orientation detect_orientation(const int* x, const int* y);
+
+/// RandR screen rotations and reflections, as RR_Rotate_0, ... in randr.h
+enum ScreenRotation {
+    SCREEN_ROTATE_0 = 1,
+    SCREEN_ROTATE_90 = 2,
+    SCREEN_ROTATE_180 = 4,
+    SCREEN_ROTATE_270 = 8,
+    SCREEN_REFLECT_X = 16,
+    SCREEN_REFLECT_Y = 32
+};
+
 /// Output types
 enum OutputType {
     OUTYPE_AUTO,
@@ -131,7 +236,39 @@ class WrongCalibratorException : public std::invalid_argument {
             std::invalid_argument(msg) {}
 };
 
-/// Base class for calculating new calibration parameters
+class SessionRecorder;
+class XServer;
+
+/*
+ * What a calibration runs with besides its device and clicks: the debug
+ * output and where the input devices are found in sysfs. Each Calibrator
+ * keeps its own copy.
+ */
+struct CalibratorContext
+{
+    /// print debug messages
+    bool verbose;
+    /// the input class directory in sysfs, and the file with the
+    /// device name below its eventN entries
+    std::string sysfs_input;
+    std::string sysfs_devname;
+
+    CalibratorContext()
+      : verbose(false), sysfs_input("/sys/class/input"),
+        sysfs_devname("device/name") {}
+};
+
+/*
+ * Base class for calculating new calibration parameters
+ *
+ * The engine has no global mutable state: a Calibrator holds everything
+ * of its calibration, including its context, the device name and the
+ * connections to the X server it opens. So calibrators can be used one
+ * after the other in one process, or concurrently from several threads,
+ * as long as each calibrator is used by one thread at a time. Calibrators
+ * that talk to an X server from several threads need XInitThreads() first
+ * (libX11 1.8 and later call it on their own).
+ */
 class Calibrator
 {
 public:
@@ -149,9 +286,17 @@ public:
                const OutputType output_type=OUTYPE_AUTO,
                const char* geometry=0,
                const bool use_timeout=1,
-               const char* output_filename = 0);
+               const char* output_filename = 0,
+               const CalibratorContext& context = CalibratorContext());
+
+    virtual ~Calibrator();
+
+    const CalibratorContext& get_context() const
+    { return context; }
 
-    virtual ~Calibrator() {}
+    /// get the name of the device
+    const char* get_device_name() const
+    { return device_name.c_str(); }
 
     /// set the doubleclick treshold
     void set_threshold_doubleclick(int t)
@@ -170,13 +315,34 @@ public:
     { return geometry; }
 
     /// reset clicks
-    void reset()
-    {  clicked.num = 0; clicked.x.clear(); clicked.y.clear();}
+    void reset();
 
     /// add a click with the given coordinates
     bool add_click(int x, int y);
     /// calculate and apply the calibration
     virtual bool finish(int width, int height);
+    /// the new axys that finish() computes for the clicks x, y
+    /// (in the order UL, UR, LL, LR) on a width x height screen;
+    /// calc_axys_fixed() when built with --enable-fixed-point
+    static XYinfo calc_axys(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height);
+    static XYinfo calc_axys_float(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height);
+    /// calc_axys() in integer arithmetic, for CPUs without an FPU: the
+    /// exactly rounded result. calc_axys_float() gives the same, except
+    /// when the exact value is within float_tie_bound() of a half-integer.
+    static XYinfo calc_axys_fixed(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height);
+    /// how far calc_axys_float() can be from the exact value on an axis,
+    /// for clicks of at most max_click (in absolute value)
+    static double float_tie_bound(const AxisInfo& old, int max_click, int size);
+    /// the calibration 'axys' for the screen turned from RandR rotation
+    /// old_rotation to new_rotation (ScreenRotation flags): the clicks
+    /// exactly on the targets, through the backend's calculation
+    XYinfo rederive_axys(const XYinfo& axys, int old_rotation, int new_rotation) const;
+    /// re-derive and apply the calibration on each RandR screen change,
+    /// until the server goes away; false if the backend can't do that
+    virtual bool follow_screen_changes();
     /// get the sysfs name of the device,
     /// returns NULL if it can not be found
     const char* get_sysfs_name();
@@ -188,6 +354,61 @@ public:
     const char* get_output_filename() const
     { return output_filename; }
 
+    /// set the verification threshold (RMS error in pixels, 0=off)
+    void set_threshold_verify(float t)
+    { threshold_verify = t; }
+
+    /// use a grid of n x n targets for the verification pass (0=default)
+    void set_verify_grid(int n)
+    { verify_grid = n; }
+
+    /// fit a non-linear correction from the verification pass, save it to file
+    void set_correction_output(const char* filename)
+    { correction_output = filename; }
+
+    /// record the session to the given file, returns false on failure
+    bool set_record_output(const char* filename);
+
+    /// write timestamps of the GUI stages to the given file, returns false on failure
+    bool set_latency_trace(const char* filename);
+
+    /// whether a latency trace is written
+    bool get_latency_trace() const
+    { return latency_trace != NULL; }
+
+    /// timestamp a stage ("receipt", "expose", "timer", "redraw" or "finish") in the latency trace
+    void trace_latency(const char* stage) const;
+
+    /// get the new calibration, as passed to finish_data()
+    const XYinfo& get_calibrated_axys() const
+    { return calibrated_axys; }
+
+    /// publish the new calibration in shared memory after finish()
+    void set_publish_shm(bool publish)
+    { publish_shm = publish; }
+
+    /// whether a verification pass should follow finish()
+    bool get_verify() const
+    { return threshold_verify > 0 || correction_output != NULL; }
+
+    /// get the number of targets in the verification pass
+    int get_num_verify_points() const
+    { return verify_grid > 0 ? verify_grid*verify_grid : NUM_VERIFY_POINTS; }
+
+    /// get the number of verification clicks already registered
+    int get_numverifyclicks() const
+    { return verified.x.size(); }
+
+    /// get the screen coordinates of verification target i
+    void get_verify_target(int i, int width, int height, int& x, int& y) const;
+
+    /// add a verification click, made after finish() succeeded
+    void add_verify_click(int x, int y);
+
+    /// report the error of the verification clicks (and fit the correction),
+    /// returns false if the RMS error exceeds the threshold
+    bool verify(int width, int height);
+
 protected:
     /// check whether the coordinates are along the respective axis
     bool along_axis(int xy, int x0, int y0);
@@ -195,24 +416,50 @@ protected:
     /// Apply new calibration, implementation dependent
     virtual bool finish_data(const XYinfo &new_axys) =0;
 
+    /// The new calibration for the clicks x, y from calibration axys,
+    /// calc_axys() of the backend's finish pipeline (see calibrator/FinishPipeline.hpp)
+    virtual XYinfo calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                 int width, int height) const;
+
+    /// Remember the new calibration, apply it with finish_data()
+    /// and publish it if requested
+    bool apply_calibration(const XYinfo& new_axys);
+
+    /// Publish the calibration in shared memory, if requested
+    void publish_calibration(const XYinfo& axys) const;
+
+    /// The calibration routine, for the session recording
+    virtual CalibratorBackend get_backend() const
+    { return BACKEND_GENERIC; }
+
+    /// Whether finish_data() applies the calibration to the running session,
+    /// if not, verification clicks are mapped to the new calibration first
+    virtual bool applies_dynamically() const
+    { return false; }
+
+    /// Map a click made with the old calibration to the new calibration
+    void remap_click(int& x, int& y, int width, int height) const;
+
     /// Check whether the given name is a sysfs device name
     bool is_sysfs_name(const char* name);
 
-    /// Check whether the X server has xorg.conf.d support
-    bool has_xorgconfd_support(Display* display=NULL);
-
-    static int find_device(const char* pre_device, bool list_devices,
-            XID& device_id, const char*& device_name, XYinfo& device_axys);
+    /// find a calibratable device, see main_common.cpp; -1 if the
+    /// X server or its X Input extension is not available.
+    /// device_id is an XID (the core itself does not use Xlib)
+    static int find_device(const CalibratorContext& context,
+            const char* pre_device, bool list_devices,
+            unsigned long& device_id, std::string& device_name, XYinfo& device_axys,
+            XServer* server=NULL);
 
 protected:
     /// Name of the device (driver)
-    const char* const device_name;
+    const std::string device_name;
 
     /// Original values
     XYinfo old_axys;
 
-    /// Be verbose or not
-    static bool verbose;
+    /// Verbosity and sysfs paths
+    const CalibratorContext context;
 
     /// Clicked values (screen coordinates)
     struct {
@@ -222,6 +469,14 @@ protected:
         std::vector<int> x, y;
     } clicked;
 
+    /// New values, as passed to finish_data()
+    XYinfo calibrated_axys;
+
+    /// Verification clicks (screen coordinates)
+    struct {
+        std::vector<int> x, y;
+    } verified;
+
     // Threshold to keep the same point from being clicked twice.
     // Set to zero if you don't want this check
     int threshold_doubleclick;
@@ -231,6 +486,25 @@ protected:
     // Set to zero if you don't want this check
     int threshold_misclick;
 
+    // Threshold on the RMS error of the verification pass, in pixels
+    // Set to zero to skip the verification pass
+    float threshold_verify;
+
+    // Number of rows/columns of verification targets, 0 for the default points
+    int verify_grid;
+
+    // file to write the non-linear correction grid to, or NULL
+    const char* correction_output;
+
+    // publish the calibration in shared memory
+    bool publish_shm;
+
+    // session recording, or NULL
+    SessionRecorder* recorder;
+
+    // latency trace, or NULL
+    FILE* latency_trace;
+
     // Type of output
     OutputType output_type;
 
@@ -241,16 +515,14 @@ protected:
 
     // manually specified output filename
     const char* output_filename;
-
-    // sysfs path/file
-    static const char* SYSFS_INPUT;
-    static const char* SYSFS_DEVNAME;
 };
 
 // Interfance for a CalibratorTester
 class CalibratorTesterInterface
 {
 public:
+    virtual ~CalibratorTesterInterface() {}
+
     // emulate the driver processing the coordinates in 'raw'
     virtual XYinfo emulate_driver(const XYinfo& raw, bool useNewAxis, const XYinfo& screen, const XYinfo& device) = 0;
 
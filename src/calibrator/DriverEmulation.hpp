@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef CALIBRATOR_DRIVER_EMULATION_HPP
+#define CALIBRATOR_DRIVER_EMULATION_HPP
+
+#include "calibrator.hh"
+#include "calibrator/EvdevAxys.hpp"
+#include "calibrator/Tester.hpp"
+
+/***************************************
+ * Driver emulations as policy types, for sweeps that instantiate
+ * one inlined loop per driver instead of going through the
+ * virtual CalibratorTesterInterface.
+ *
+ * A driver policy has:
+ *   static const char* name();
+ *   // the new calibration its calibrator computes from the clicks
+ *   static XYinfo calibrate(const XYinfo& old_axys, const int* x,
+ *                           const int* y, int width, int height);
+ *   // raw coordinates vals[2] to device coordinates, with calibration 'axis'
+ *   static void process(const XYinfo& devAxis, const XYinfo& axis, int* vals);
+ ***************************************/
+
+/// Emulate the driver processing the coordinates in 'raw' (the mins and
+/// the maxs as two points) with calibration 'axis', up to the screen
+template <class Driver>
+inline XYinfo driver_emulate(const XYinfo& raw, const XYinfo& axis,
+                             const XYinfo& screen, const XYinfo& device)
+{
+    int mins[2] = {raw.x.min, raw.y.min};
+    Driver::process(device, axis, mins);
+    int maxs[2] = {raw.x.max, raw.y.max};
+    Driver::process(device, axis, maxs);
+
+    XYinfo result(mins[0], maxs[0], mins[1], maxs[1]);
+
+    // the last step is usually done by the X server,
+    // or transparently somewhere on the way
+    result.do_xf86ScaleAxis(screen, device);
+    return result;
+}
+
+/**
+ * The most simple and intuitive calibration implementation
+ * if only all drivers sticked to this...
+ * Note that axis inversion is automatically supported
+ * by the ScaleAxis implementation (swapping max/min on
+ * one axis will result in the inversion being calculated)
+ */
+struct Xf86Driver {
+    static const char* name()
+    { return "xf86"; }
+
+    static XYinfo calibrate(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height)
+    { return Calibrator::calc_axys(old_axys, x, y, width, height); }
+
+    static void process(const XYinfo& devAxis, const XYinfo& axis, int* vals)
+    {
+        // swap coordinates if asked
+        if (axis.swap_xy) {
+            const int tmp = vals[0];
+            vals[0] = vals[1];
+            vals[1] = tmp;
+        }
+
+        vals[0] = xf86ScaleAxis(vals[0], devAxis.x.max, devAxis.x.min, axis.x.max, axis.x.min);
+        vals[1] = xf86ScaleAxis(vals[1], devAxis.y.max, devAxis.y.min, axis.y.max, axis.y.min);
+    }
+};
+
+/// evdev 2.7.0 EvdevProcessValuators code, modified to fit us
+struct Evdev270Driver {
+    static const char* name()
+    { return "evdev"; }
+
+    static XYinfo calibrate(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height)
+    { return EvdevAxys::calc_axys(old_axys, x, y, width, height); }
+
+    static void process(const XYinfo& devAxis, const XYinfo& axis, int* vals)
+    {
+        const int absinfo_min[2] = {devAxis.x.min, devAxis.y.min};
+        const int absinfo_max[2] = {devAxis.x.max, devAxis.y.max};
+
+        /*
+         * Code from xf86-input-evdev: src/evdev.c
+         * function: static void EvdevProcessValuators(InputInfoPtr pInfo)
+         * last change: 2011-12-14 'Fix absolute events with swapped axes'
+         * last change id: 8d6dfd13b0c4177305555294218e366a6cddc83f
+         *
+         * All valuator_mask_isset() test can be skipped here:
+         * its a requirement to have both X and Y coordinates
+         */
+        if (axis.swap_xy) {
+            /* in all sensible cases, the absinfo is the same for the
+             * X and Y axis. In that case, the below simplifies to:
+             * swapped_values[1 - i] = vals[i]
+             * However, the code below accounts for the oddball
+             * device for which this would not be the case.
+             */
+            const int swapped_x = xf86ScaleAxis(vals[1], absinfo_max[0], absinfo_min[0],
+                                                absinfo_max[1], absinfo_min[1]);
+            const int swapped_y = xf86ScaleAxis(vals[0], absinfo_max[1], absinfo_min[1],
+                                                absinfo_max[0], absinfo_min[0]);
+            vals[0] = swapped_x;
+            vals[1] = swapped_y;
+        }
+
+        // if (pEvdev->flags & EVDEV_CALIBRATED)
+        vals[0] = xf86ScaleAxis(vals[0], absinfo_max[0], absinfo_min[0],
+                                axis.x.max, axis.x.min);
+        vals[1] = xf86ScaleAxis(vals[1], absinfo_max[1], absinfo_min[1],
+                                axis.y.max, axis.y.min);
+
+        if (axis.x.invert)
+            vals[0] = absinfo_max[0] - vals[0] + absinfo_min[0];
+        if (axis.y.invert)
+            vals[1] = absinfo_max[1] - vals[1] + absinfo_min[1];
+    }
+};
+
+/**
+ * The usbtouchscreen kernel module with transform_xy: swaps if swap_xy,
+ * then maps [min, max] linearly onto the device range in integer
+ * arithmetic; flip_x and flip_y follow from min > max.
+ * Unlike the X server, the kernel does not clamp to the device range.
+ */
+struct UsbtouchscreenDriver {
+    static const char* name()
+    { return "usbtouchscreen"; }
+
+    static XYinfo calibrate(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height)
+    { return Calibrator::calc_axys(old_axys, x, y, width, height); }
+
+    static void process(const XYinfo& devAxis, const XYinfo& axis, int* vals)
+    {
+        if (axis.swap_xy) {
+            const int tmp = vals[0];
+            vals[0] = vals[1];
+            vals[1] = tmp;
+        }
+
+        vals[0] = transform(vals[0], devAxis.x, axis.x);
+        vals[1] = transform(vals[1], devAxis.y, axis.y);
+    }
+
+    static int transform(int val, const AxisInfo& dev, const AxisInfo& calib)
+    {
+        if (calib.max == calib.min)
+            return dev.min;
+        return (int) ((int64_t)(val - calib.min) * (dev.max - dev.min) /
+                      (calib.max - calib.min)) + dev.min;
+    }
+};
+
+/***************************************
+ * Class for testing the calibration routine and
+ * the processing of a driver policy, without X
+ * (CalibratorEvdevTester is a CalibratorEvdev,
+ * which needs the X libraries)
+ ***************************************/
+template <class Driver>
+class CalibratorDriverTester: public CalibratorTester
+{
+public:
+    CalibratorDriverTester(const char* const device_name, const XYinfo& axys,
+        const int thr_misclick=0, const int thr_doubleclick=0)
+      : CalibratorTester(device_name, axys, thr_misclick, thr_doubleclick) {}
+
+    // emulate the driver processing the coordinates in 'raw'
+    virtual XYinfo emulate_driver(const XYinfo& raw, bool useNewAxis,
+                                  const XYinfo& screen, const XYinfo& device)
+    { return driver_emulate<Driver>(raw, useNewAxis ? new_axis : old_axys, screen, device); }
+
+protected:
+    virtual XYinfo calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                 int width, int height) const
+    { return Driver::calibrate(axys, x, y, width, height); }
+};
+
+#endif
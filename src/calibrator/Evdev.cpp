@@ -23,9 +23,13 @@
  */
 
 #include "calibrator/Evdev.hpp"
+#include "calibrator/EvdevAxys.hpp"
+#include "output.hh"
+#include "recording.hh"
+#include "xserver/XlibServer.hpp"
 
 #include <X11/Xlib.h>
-#include <X11/Xatom.h>
+#include <X11/extensions/XInput.h>
 #include <ctype.h>
 #include <cstdio>
 #include <cstring>
@@ -42,66 +46,63 @@
 // Constructor
 CalibratorEvdev::CalibratorEvdev(const char* const device_name0,
                                  const XYinfo& axys0,
-                                 XID device_id,
+                                 XID device_id0,
                                  const int thr_misclick,
                                  const int thr_doubleclick,
                                  const OutputType output_type,
                                  const char* geometry,
                                  const bool use_timeout,
-                                 const char* output_filename)
-  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename)
+                                 const char* output_filename,
+                                 XServer* server0,
+                                 const CalibratorContext& context0)
+  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename, context0),
+    server(server0), own_server(false), device_id(device_id0)
 {
     // init
-    display = XOpenDisplay(NULL);
-    if (display == NULL) {
+    if (server == NULL) {
+        server = new XlibServer();
+        own_server = true;
+    }
+    if (!server->is_connected()) {
+        close_server();
         throw WrongCalibratorException("Evdev: Unable to connect to X server");
     }
 
     // normaly, we already have the device id
     if (device_id == (XID)-1) {
-        devInfo = xinput_find_device_info(display, device_name, False);
-        if (!devInfo) {
-            XCloseDisplay(display);
+        device_id = find_device_id(server, device_name.c_str(), false);
+        if (device_id == (XID)-1) {
+            close_server();
             throw WrongCalibratorException("Evdev: Unable to find device");
         }
-        device_id = devInfo->id;
     }
 
-    dev = XOpenDevice(display, device_id);
-    if (!dev) {
-        XCloseDisplay(display);
+    if (!server->open_device(device_id)) {
+        close_server();
         throw WrongCalibratorException("Evdev: Unable to open device");
     }
 
 #ifndef HAVE_XI_PROP
+    close_server();
     throw WrongCalibratorException("Evdev: you need at least libXi 1.2 and inputproto 1.5 for dynamic recalibration of evdev.");
 #else
 
-    // XGetDeviceProperty vars
-    Atom            property;
-    Atom            act_type;
-    int             act_format;
-    unsigned long   nitems, bytes_after;
-    unsigned char   *data, *ptr;
+    int format;
+    std::vector<long> values;
 
     // get "Evdev Axis Calibration" property
-    property = xinput_parse_atom(display, "Evdev Axis Calibration");
-    if (XGetDeviceProperty(display, dev, property, 0, 1000, False,
-                           AnyPropertyType, &act_type, &act_format,
-                           &nitems, &bytes_after, &data) != Success)
+    if (!server->get_int_property(device_id, "Evdev Axis Calibration", format, values))
     {
-        XCloseDevice(display, dev);
-        XCloseDisplay(display);
+        close_server();
         throw WrongCalibratorException("Evdev: \"Evdev Axis Calibration\" property missing, not a (valid) evdev device");
 
     } else {
-        if (act_format != 32 || act_type != XA_INTEGER) {
-            XCloseDevice(display, dev);
-            XCloseDisplay(display);
+        if (format != 32) {
+            close_server();
             throw WrongCalibratorException("Evdev: invalid \"Evdev Axis Calibration\" property format");
 
-        } else if (nitems == 0) {
-            if (verbose)
+        } else if (values.size() < 4) {
+            if (context.verbose)
                 printf("DEBUG: Evdev Axis Calibration not set, setting to axis valuators to be sure.\n");
 
             // No axis calibration set, set it to the default one
@@ -110,51 +111,37 @@ CalibratorEvdev::CalibratorEvdev(const char* const device_name0,
             // not setting the values here would result in a wrong first calibration
             (void) set_calibration(old_axys);
 
-        } else if (nitems > 0) {
-            ptr = data;
-
-            old_axys.x.min = *((long*)ptr);
-            ptr += sizeof(long);
-            old_axys.x.max = *((long*)ptr);
-            ptr += sizeof(long);
-            old_axys.y.min = *((long*)ptr);
-            ptr += sizeof(long);
-            old_axys.y.max = *((long*)ptr);
-            ptr += sizeof(long);
+        } else {
+            old_axys.x.min = values[0];
+            old_axys.x.max = values[1];
+            old_axys.y.min = values[2];
+            old_axys.y.max = values[3];
         }
-
-        XFree(data);
     }
 
     // get "Evdev Axes Swap" property
-    property = xinput_parse_atom(display, "Evdev Axes Swap");
-    if (XGetDeviceProperty(display, dev, property, 0, 1000, False,
-                           AnyPropertyType, &act_type, &act_format,
-                           &nitems, &bytes_after, &data) == Success)
+    if (server->get_int_property(device_id, "Evdev Axes Swap", format, values))
     {
-        if (act_format == 8 && act_type == XA_INTEGER && nitems == 1) {
-            old_axys.swap_xy = *((char*)data);
+        if (format == 8 && values.size() == 1) {
+            old_axys.swap_xy = values[0];
 
-            if (verbose)
+            if (context.verbose)
                 printf("DEBUG: Read axes swap value of %i.\n", old_axys.swap_xy);
         }
     }
 
     // get "Evdev Axes Inversion" property
-    property = xinput_parse_atom(display, "Evdev Axis Inversion");
-    if (XGetDeviceProperty(display, dev, property, 0, 1000, False,
-                AnyPropertyType, &act_type, &act_format,
-                &nitems, &bytes_after, &data) == Success) {
-        if (act_format == 8 && act_type == XA_INTEGER && nitems == 2) {
-            old_axys.x.invert = *((char*)data++);
-            old_axys.y.invert = *((char*)data);
-
-            if (verbose)
+    if (server->get_int_property(device_id, "Evdev Axis Inversion", format, values)) {
+        if (format == 8 && values.size() == 2) {
+            old_axys.x.invert = values[0];
+            old_axys.y.invert = values[1];
+
+            if (context.verbose)
                 printf("DEBUG: Read InvertX=%i, InvertY=%i.\n", old_axys.x.invert, old_axys.y.invert);
         }
     }
 
-    printf("Calibrating EVDEV driver for \"%s\" id=%i\n", device_name, (int)device_id);
+    printf("Calibrating EVDEV driver for \"%s\" id=%i\n", device_name.c_str(), (int)device_id);
     printf("\tcurrent calibration values (from XInput): min_x=%d, max_x=%d and min_y=%d, max_y=%d\n",
                 old_axys.x.min, old_axys.x.max, old_axys.y.min, old_axys.y.max);
 #endif // HAVE_XI_PROP
@@ -168,123 +155,42 @@ CalibratorEvdev::CalibratorEvdev(const char* const device_name0,
                                  const OutputType output_type,
                                  const char* geometry,
                                  const bool use_timeout,
-                                 const char* output_filename)
-  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, output_filename) { }
+                                 const char* output_filename,
+                                 const CalibratorContext& context0)
+  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename, context0),
+    server(NULL), own_server(false), device_id((XID)-1) { }
 
 // Destructor
 CalibratorEvdev::~CalibratorEvdev () {
-    XCloseDevice(display, dev);
-    XCloseDisplay(display);
+    close_server();
 }
 
-// From Calibrator but with evdev specific invertion option
-// KEEP IN SYNC with Calibrator::finish() !!
-bool CalibratorEvdev::finish(int width, int height)
+void CalibratorEvdev::close_server()
 {
-    if (get_numclicks() != NUM_POINTS) {
-        return false;
-    }
-
-    // new axis origin and scaling
-    // based on old_axys: inversion/swapping is relative to the old axis
-    XYinfo new_axis(old_axys);
-
-
-    // calculate average of clicks
-    float x_min = (clicked.x[UL] + clicked.x[LL])/2.0;
-    float x_max = (clicked.x[UR] + clicked.x[LR])/2.0;
-    float y_min = (clicked.y[UL] + clicked.y[UR])/2.0;
-    float y_max = (clicked.y[LL] + clicked.y[LR])/2.0;
-
-
-    // When evdev detects an invert_X/Y option,
-    // it performs the following *crazy* code just before returning
-    // val = (pEvdev->absinfo[i].maximum - val + pEvdev->absinfo[i].minimum);
-    // undo this crazy step before doing the regular calibration routine
-    if (old_axys.x.invert) {
-        x_min = width - x_min;
-        x_max = width - x_max;
-        // avoid invert_x property from here on,
-        // the calibration code can handle this dynamically!
-        new_axis.x.invert = false;
-    }
-    if (old_axys.y.invert) {
-        y_min = height - y_min;
-        y_max = height - y_max;
-        // avoid invert_y property from here on,
-        // the calibration code can handle this dynamically!
-        new_axis.y.invert = false;
-    }
-    // end of evdev inversion crazyness
-
-
-    // Should x and y be swapped?
-    if (abs(clicked.x[UL] - clicked.x[UR]) < abs(clicked.y[UL] - clicked.y[UR])) {
-        new_axis.swap_xy = !new_axis.swap_xy;
-        std::swap(x_min, y_min);
-        std::swap(x_max, y_max);
-    }
+    if (own_server)
+        delete server;
+    server = NULL;
+    own_server = false;
+}
 
-    // the screen was divided in num_blocks blocks, and the touch points were at
-    // one block away from the true edges of the screen.
-    const float block_x = width/(float)num_blocks;
-    const float block_y = height/(float)num_blocks;
-    // rescale these blocks from the range of the drawn touchpoints to the range of the 
-    // actually clicked coordinates, and substract/add from the clicked coordinates
-    // to obtain the coordinates corresponding to the edges of the screen.
-    float scale_x = (x_max - x_min)/(width - 2*block_x);
-    x_min -= block_x * scale_x;
-    x_max += block_x * scale_x;
-    float scale_y = (y_max - y_min)/(height - 2*block_y);
-    y_min -= block_y * scale_y;
-    y_max += block_y * scale_y;
-    
-    // now, undo the transformations done by the X server, to obtain the true 'raw' value in X.
-    // The raw value was scaled from old_axis to the device min/max, and from the device min/max
-    // to the screen min/max
-    // hence, the reverse transformation is from screen to old_axis
-    x_min = scaleAxis(x_min, old_axys.x.max, old_axys.x.min, width, 0);
-    x_max = scaleAxis(x_max, old_axys.x.max, old_axys.x.min, width, 0);
-    y_min = scaleAxis(y_min, old_axys.y.max, old_axys.y.min, height, 0);
-    y_max = scaleAxis(y_max, old_axys.y.max, old_axys.y.min, height, 0);
-
-
-    // round and put in new_axis struct
-    new_axis.x.min = round(x_min); new_axis.x.max = round(x_max);
-    new_axis.y.min = round(y_min); new_axis.y.max = round(y_max);
-
-    // finish the data, driver/calibrator specific
-    return finish_data(new_axis);
+// From Calibrator but with evdev specific invertion option
+XYinfo CalibratorEvdev::calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                      int width, int height) const
+{
+    return EvdevAxys::calc_axys(axys, x, y, width, height);
 }
 
 // Activate calibrated data and output it
 bool CalibratorEvdev::finish_data(const XYinfo &new_axys)
 {
-    bool success = true;
-
     printf("\nDoing dynamic recalibration:\n");
-    // Evdev Axes Swap
-    if (old_axys.swap_xy != new_axys.swap_xy) {
-        success &= set_swapxy(new_axys.swap_xy);
-    }
-
-   // Evdev Axis Inversion
-   if (old_axys.x.invert != new_axys.x.invert ||
-       old_axys.y.invert != new_axys.y.invert) {
-        success &= set_invert_xy(new_axys.x.invert, new_axys.y.invert);
-    }
-
-    // Evdev Axis Calibration
-    success &= set_calibration(new_axys);
-
-    // close
-    XSync(display, False);
+    bool success = set_properties(new_axys);
 
     printf("\t--> Making the calibration permanent <--\n");
     switch (output_type) {
         case OUTYPE_AUTO:
             // xorg.conf.d or alternatively xinput commands
-            if (has_xorgconfd_support()) {
+            if (server->has_xorgconfd_support()) {
                 success &= output_xorgconfd(new_axys);
             } else {
                 success &= output_xinput(new_axys);
@@ -307,6 +213,60 @@ bool CalibratorEvdev::finish_data(const XYinfo &new_axys)
     return success;
 }
 
+bool CalibratorEvdev::set_properties(const XYinfo& new_axys)
+{
+    bool success = true;
+
+    // Evdev Axes Swap
+    if (old_axys.swap_xy != new_axys.swap_xy) {
+        success &= set_swapxy(new_axys.swap_xy);
+    }
+
+   // Evdev Axis Inversion
+   if (old_axys.x.invert != new_axys.x.invert ||
+       old_axys.y.invert != new_axys.y.invert) {
+        success &= set_invert_xy(new_axys.x.invert, new_axys.y.invert);
+    }
+
+    // Evdev Axis Calibration
+    success &= set_calibration(new_axys);
+
+    // close
+    server->sync();
+
+    return success;
+}
+
+bool CalibratorEvdev::follow_screen_changes()
+{
+    int rotation = server->screen_rotation();
+    int new_rotation;
+    if (!server->has_screen_changes()) {
+        fprintf(stderr, "Error: the X server offers no screen change events (RandR), can not follow the screen rotation.\n");
+        return false;
+    }
+    printf("Following the screen rotation, calibration: %d, %d, %d, %d, swap_xy=%d\n",
+           old_axys.x.min, old_axys.x.max, old_axys.y.min, old_axys.y.max, old_axys.swap_xy);
+    while (server->wait_screen_change(new_rotation)) {
+        // the driver scales to whatever size the screen has
+        if (new_rotation == rotation) {
+            if (context.verbose)
+                printf("DEBUG: Screen resized, the calibration still matches.\n");
+            continue;
+        }
+
+        const XYinfo new_axys = rederive_axys(old_axys, rotation, new_rotation);
+        printf("\nScreen rotation changed from %d to %d:\n", rotation, new_rotation);
+        if (!set_properties(new_axys))
+            return false;
+        publish_calibration(new_axys);
+
+        old_axys = new_axys;
+        rotation = new_rotation;
+    }
+    return true;
+}
+
 bool CalibratorEvdev::set_swapxy(const int swap_xy)
 {
     printf("\tSwapping X and Y axis...\n");
@@ -315,9 +275,9 @@ bool CalibratorEvdev::set_swapxy(const int swap_xy)
     int arr_cmd[1];
     arr_cmd[0] = swap_xy;
 
-    bool ret = xinput_do_set_int_prop("Evdev Axes Swap", display, 8, 1, arr_cmd);
+    bool ret = set_int_prop("Evdev Axes Swap", 8, 1, arr_cmd);
 
-    if (verbose) {
+    if (context.verbose) {
         if (ret == true)
             printf("DEBUG: Successfully set swapped X and Y axes = %d.\n", swap_xy);
         else
@@ -336,9 +296,9 @@ bool CalibratorEvdev::set_invert_xy(const int invert_x, const int invert_y)
     arr_cmd[0] = invert_x;
     arr_cmd[1] = invert_y;
 
-    bool ret = xinput_do_set_int_prop("Evdev Axis Inversion", display, 8, 2, arr_cmd);
+    bool ret = set_int_prop("Evdev Axis Inversion", 8, 2, arr_cmd);
 
-    if (verbose) {
+    if (context.verbose) {
         if (ret == true)
             printf("DEBUG: Successfully set invert axis X=%d, Y=%d.\n", invert_x, invert_y);
         else
@@ -359,9 +319,9 @@ bool CalibratorEvdev::set_calibration(const XYinfo new_axys)
     arr_cmd[2] = new_axys.y.min;
     arr_cmd[3] = new_axys.y.max;
 
-    bool ret = xinput_do_set_int_prop("Evdev Axis Calibration", display, 32, 4, arr_cmd);
+    bool ret = set_int_prop("Evdev Axis Calibration", 32, 4, arr_cmd);
 
-    if (verbose) {
+    if (context.verbose) {
         if (ret == true)
             printf("DEBUG: Successfully applied axis calibration.\n");
         else
@@ -371,60 +331,40 @@ bool CalibratorEvdev::set_calibration(const XYinfo new_axys)
     return ret;
 }
 
-Atom CalibratorEvdev::xinput_parse_atom(Display *display, const char *name)
+XID CalibratorEvdev::find_device_id(XServer* server, const char *name, bool only_extended)
 {
-    Bool is_atom = True;
-    int i;
+    XID found = (XID)-1;
+    int len = strlen(name);
+    bool is_id = true;
 
-    for (i = 0; name[i] != '\0'; i++) {
-        if (!isdigit(name[i])) {
-            is_atom = False;
-            break;
-        }
-    }
-
-    if (is_atom)
-        return atoi(name);
-    else
-        return XInternAtom(display, name, False);
-}
-
-XDeviceInfo* CalibratorEvdev::xinput_find_device_info(
-Display *display, const char *name, Bool only_extended)
-{
-    XDeviceInfo	*devices;
-    XDeviceInfo *found = NULL;
-    int		loop;
-    int		num_devices;
-    int		len = strlen(name);
-    Bool	is_id = True;
-    XID		id = (XID)-1;
-
-    for (loop=0; loop<len; loop++) {
+    for (int loop=0; loop<len; loop++) {
         if (!isdigit(name[loop])) {
-            is_id = False;
+            is_id = false;
             break;
         }
     }
 
     if (is_id) {
-        id = atoi(name);
+        // only this device, no need to list them all
+        XInputDevice dev;
+        if (!server->query_device(atoi(name), dev) ||
+            (only_extended && dev.use < IsXExtensionDevice))
+            return (XID)-1;
+        return dev.id;
     }
 
-    devices = XListInputDevices(display, &num_devices);
-
-    for (loop=0; loop<num_devices; loop++) {
+    std::vector<XInputDevice> devices = server->list_devices();
+    for (size_t loop=0; loop<devices.size(); loop++) {
         if ((!only_extended || (devices[loop].use >= IsXExtensionDevice)) &&
-            ((!is_id && strcmp(devices[loop].name, name) == 0) ||
-             (is_id && devices[loop].id == id))) {
-            if (found) {
+            devices[loop].name == name) {
+            if (found != (XID)-1) {
                 fprintf(stderr,
                         "Warning: There are multiple devices named \"%s\".\n"
                         "To ensure the correct one is selected, please use "
                         "the device ID instead.\n\n", name);
-                return NULL;
+                return (XID)-1;
             } else {
-                found = &devices[loop];
+                found = devices[loop].id;
             }
         }
     }
@@ -432,82 +372,14 @@ Display *display, const char *name, Bool only_extended)
     return found;
 }
 
-// Set Integer property on  X
-bool CalibratorEvdev::xinput_do_set_int_prop( const char * name,
-                                         Display *display,
-                                         int format,
-                                         int argc,
-                                         const int *argv )
+// Set Integer property on X
+bool CalibratorEvdev::set_int_prop(const char* name, int format, int argc, const int* argv)
 {
-#ifndef HAVE_XI_PROP
-    return false;
-#else
-
-    Atom          prop;
-    Atom          old_type;
-    int           i;
-    int           old_format;
-    unsigned long act_nitems, bytes_after;
-
-    union {
-        unsigned char *c;
-        short *s;
-        long *l;
-        Atom *a;
-    } data;
-
-    if (argc < 1)
-    {
-        fprintf(stderr, "Wrong usage of xinput_do_set_prop, need at least 1 arguments\n");
-        return false;
-    }
-
-    prop = xinput_parse_atom(display, name);
-
-    if (prop == None) {
-        fprintf(stderr, "invalid property %s\n", name);
+    if (server == NULL)
         return false;
-    }
-
-    if ( format == 0) {
-        if (XGetDeviceProperty(display, dev, prop, 0, 0, False, AnyPropertyType,
-                               &old_type, &old_format, &act_nitems,
-                               &bytes_after, &data.c) != Success) {
-            fprintf(stderr, "failed to get property type and format for %s\n",
-                    name);
-            return false;
-        } else {
-            format = old_format;
-        }
-
-        XFree(data.c);
-    }
-
-    data.c = (unsigned char*)calloc(argc, sizeof(long));
-
-    for (i = 0; i < argc; i++) {
-      switch (format) {
-        case 8:
-            data.c[i] = argv[i];
-        case 16:
-            data.s[i] = argv[i];
-            break;
-        case 32:
-            data.l[i] = argv[i];
-            break;
-
-        default:
-            fprintf(stderr, "unexpected size for property %s\n", name);
-            return false;
-      }
-    }
-
-    XChangeDeviceProperty(display, dev, prop, XA_INTEGER, format, PropModeReplace,
-                      data.c, argc);
-    free(data.c);
-    return true;
-#endif // HAVE_XI_PROP
 
+    std::vector<long> values(argv, argv + argc);
+    return server->set_int_property(device_id, name, format, values);
 }
 
 bool CalibratorEvdev::output_xorgconfd(const XYinfo new_axys)
@@ -523,19 +395,7 @@ bool CalibratorEvdev::output_xorgconfd(const XYinfo new_axys)
         printf("  writing xorg.conf calibration data to '%s'\n", output_filename);
 
     // xorg.conf.d snippet
-    char line[MAX_LINE_LEN];
-    std::string outstr;
-
-    outstr += "Section \"InputClass\"\n";
-    outstr += "	Identifier	\"calibration\"\n";
-    sprintf(line, "	MatchProduct	\"%s\"\n", sysfs_name);
-    outstr += line;
-    sprintf(line, "	Option	\"Calibration\"	\"%d %d %d %d\"\n",
-                new_axys.x.min, new_axys.x.max, new_axys.y.min, new_axys.y.max);
-    outstr += line;
-    sprintf(line, "	Option	\"SwapAxes\"	\"%d\"\n", new_axys.swap_xy);
-    outstr += line;
-    outstr += "EndSection\n";
+    const std::string outstr = format_xorgconfd(sysfs_name, new_axys, true);
 
     // console out
     printf("%s", outstr.c_str());
@@ -569,17 +429,8 @@ bool CalibratorEvdev::output_hal(const XYinfo new_axys)
         printf("  writing HAL calibration data to '%s'\n", output_filename);
 
     // HAL policy output
-    char line[MAX_LINE_LEN];
-    std::string outstr;
-
-    sprintf(line, "<match key=\"info.product\" contains=\"%s\">\n", sysfs_name);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.calibration\" type=\"string\">%d %d %d %d</merge>\n",
-        new_axys.x.min, new_axys.x.max, new_axys.y.min, new_axys.y.max);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.swapaxes\" type=\"string\">%d</merge>\n",
-        new_axys.swap_xy);
-    outstr += "</match>\n";
+    const std::string outstr = format_hal(sysfs_name, new_axys, true);
+
     // console out
     printf("%s", outstr.c_str());
     if (not_sysfs_name)
@@ -607,13 +458,7 @@ bool CalibratorEvdev::output_xinput(const XYinfo new_axys)
         printf("  writing calibration script to '%s'\n", output_filename);
 
     // create startup script
-    char line[MAX_LINE_LEN];
-    std::string outstr;
-
-    sprintf(line, "    xinput set-int-prop \"%s\" \"Evdev Axis Calibration\" 32 %d %d %d %d\n", device_name, new_axys.x.min, new_axys.x.max, new_axys.y.min, new_axys.y.max);
-    outstr += line;
-    sprintf(line, "    xinput set-int-prop \"%s\" \"Evdev Axes Swap\" 8 %d\n", device_name, new_axys.swap_xy);
-    outstr += line;
+    const std::string outstr = format_xinput(device_name.c_str(), new_axys);
 
     // console out
     printf("%s", outstr.c_str());
@@ -25,7 +25,7 @@
 #define CALIBRATOR_EVDEV_HPP
 
 #include "calibrator.hh"
-#include <X11/extensions/XInput.h>
+#include "xserver/XServer.hpp"
 
 /***************************************
  * Class for dynamic evdev calibration
@@ -34,9 +34,12 @@
 class CalibratorEvdev: public Calibrator
 {
 private:
-    Display     *display;
-    XDeviceInfo *devInfo;
-    XDevice     *dev;
+    XServer     *server;
+    // whether server was created by us
+    bool        own_server;
+    XID         device_id;
+
+    void close_server();
 
 protected:
     // protected constructor: should only be used by subclasses!
@@ -48,7 +51,8 @@ protected:
                     const OutputType output_type=OUTYPE_AUTO,
                     const char* geometry=0,
                     const bool use_timeout=false,
-                    const char* output_filename = 0);
+                    const char* output_filename = 0,
+                    const CalibratorContext& context = CalibratorContext());
 
 public:
     CalibratorEvdev(const char* const device_name,
@@ -59,26 +63,33 @@ public:
                     const OutputType output_type=OUTYPE_AUTO,
                     const char* geometry=0,
                     const bool use_timeout=false,
-                    const char* output_filename = 0);
+                    const char* output_filename = 0,
+                    XServer* server = 0,
+                    const CalibratorContext& context = CalibratorContext());
     virtual ~CalibratorEvdev();
 
-    /// calculate and apply the calibration
-    virtual bool finish(int width, int height);
     virtual bool finish_data(const XYinfo &new_axys);
+    virtual bool applies_dynamically() const
+    { return true; }
+    virtual CalibratorBackend get_backend() const
+    { return BACKEND_EVDEV; }
+    virtual bool follow_screen_changes();
+
+    /// set the swap, inversion and calibration properties that differ
+    /// from old_axys, with one round-trip to the server
+    bool set_properties(const XYinfo& new_axys);
 
     bool set_swapxy(const int swap_xy);
     bool set_invert_xy(const int invert_x, const int invert_y);
     bool set_calibration(const XYinfo new_axys);
 
-    // xinput_ functions (from the xinput project)
-    Atom xinput_parse_atom(Display *display, const char* name);
-    XDeviceInfo* xinput_find_device_info(Display *display, const char* name, Bool only_extended);
-    bool xinput_do_set_int_prop( const char * name,
-                                 Display *display,
-                                 int format,
-                                 int argc,
-                                 const int* argv);
+    /// find a device by name or id, (XID)-1 if not found or not unique
+    static XID find_device_id(XServer* server, const char* name, bool only_extended);
+    bool set_int_prop(const char* name, int format, int argc, const int* argv);
 protected:
+    virtual XYinfo calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                 int width, int height) const;
+
     bool output_xorgconfd(const XYinfo new_axys);
     bool output_hal(const XYinfo new_axys);
     bool output_xinput(const XYinfo new_axys);
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "calibrator/EvdevAxys.hpp"
+#include "calibrator/FinishPipeline.hpp"
+
+XYinfo EvdevAxys::calc_axys(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height)
+{
+#ifdef CALIBRATOR_FIXED_POINT
+    return calc_axys_fixed(old_axys, x, y, width, height);
+#else
+    return calc_axys_float(old_axys, x, y, width, height);
+#endif
+}
+
+XYinfo EvdevAxys::calc_axys_float(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height)
+{
+    return EvdevFinish::run<FloatFinishState>(FinishInput(old_axys, x, y, width, height));
+}
+
+XYinfo EvdevAxys::calc_axys_fixed(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height)
+{
+    return EvdevFixedFinish::run<FixedFinishState>(FinishInput(old_axys, x, y, width, height));
+}
@@ -1,6 +1,5 @@
 /*
- * Copyright (c) 2009 Tias Guns
- * Copyright (c) 2009 Soren Hauberg
+ * Copyright (c) 2026 The xinput_calibrator authors
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -21,40 +20,24 @@
  * THE SOFTWARE.
  */
 
-// Must be before Xlib stuff
-#include <gtkmm/main.h>
-#include <gtkmm/window.h>
-#include <cairomm/context.h>
+#ifndef CALIBRATOR_EVDEV_AXYS_HPP
+#define CALIBRATOR_EVDEV_AXYS_HPP
 
 #include "calibrator.hh"
-#include "gui/gtkmm.hpp"
 
-int main(int argc, char** argv)
+/*
+ * The finish pipeline of the evdev driver, without X: CalibratorEvdev
+ * and the X-free library (xinput_calibrator.h) both use it.
+ */
+struct EvdevAxys
 {
-    Calibrator* calibrator = Calibrator::make_calibrator(argc, argv);
-
-    // GTK-mm setup
-    Gtk::Main kit(argc, argv);
-
-    Glib::RefPtr< Gdk::Screen > screen = Gdk::Screen::get_default();
-    //int num_monitors = screen->get_n_monitors(); TODO, multiple monitors?
-    Gdk::Rectangle rect;
-    screen->get_monitor_geometry(0, rect);
-
-    Gtk::Window win;
-    // when no window manager: explicitely take size of full screen
-    win.move(rect.get_x(), rect.get_y());
-    win.resize(rect.get_width(), rect.get_height());
-    // in case of window manager: set as full screen to hide window decorations
-    win.fullscreen();
-
-    CalibrationArea area(calibrator);
-    win.add(area);
-    area.show();
-
-    Gtk::Main::run(win);
-
-    Gtk::Main::quit();
-    delete calibrator;
-    return 0;
-}
+    /// as Calibrator::calc_axys(), undoing the evdev axis inversion first
+    static XYinfo calc_axys(const XYinfo& old_axys, const int* x, const int* y,
+                            int width, int height);
+    static XYinfo calc_axys_float(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height);
+    static XYinfo calc_axys_fixed(const XYinfo& old_axys, const int* x, const int* y,
+                                  int width, int height);
+};
+
+#endif
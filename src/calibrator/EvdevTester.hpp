@@ -39,7 +39,8 @@ protected:
 public:
     CalibratorEvdevTester(const char* const device_name, const XYinfo& axys,
         const int thr_misclick=0, const int thr_doubleclick=0,
-        const OutputType output_type=OUTYPE_AUTO, const char* geometry=0);
+        const OutputType output_type=OUTYPE_AUTO, const char* geometry=0,
+        const CalibratorContext& context = CalibratorContext());
 
     virtual bool finish_data(const XYinfo &new_axis);
 
@@ -57,9 +58,6 @@ public:
     virtual bool finish(int width, int height) {
         return CalibratorEvdev::finish(width, height);
     }
-    
-    // evdev 2.7.0 EvdevProcessValuators code, modified to fit us
-    void evdev_270_processvaluator(const XYinfo& devAxis, const XYinfo& axis, int* vals);
 };
 
 #endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef CALIBRATOR_FINISH_PIPELINE_HPP
+#define CALIBRATOR_FINISH_PIPELINE_HPP
+
+#include "calibrator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+/***************************************
+ * The calculation of finish(), as stages composed at compile time.
+ *
+ * A stage is a struct with
+ *   template <class State>
+ *   static void apply(const FinishInput& in, State& st);
+ * and FinishPipeline<S1, S2, ...> applies them in order; backends typedef
+ * their pipeline, new stages go in between without copying the others.
+ ***************************************/
+
+/// what finish() starts from
+struct FinishInput {
+    const XYinfo& old_axys;
+    /// the clicks, in the order UL, UR, LL, LR
+    const int* x;
+    const int* y;
+    int width, height;
+
+    FinishInput(const XYinfo& old_axys0, const int* x0, const int* y0,
+                int width0, int height0)
+      : old_axys(old_axys0), x(x0), y(y0), width(width0), height(height0) {}
+};
+
+/// the intermediate values: the clicked edges of each click axis,
+/// in 1/unit pixels, and the new axis being built
+template <class T, int Unit>
+struct FinishState {
+    static const int unit = Unit;
+
+    // new axis origin and scaling
+    // based on old_axys: inversion/swapping is relative to the old axis
+    XYinfo new_axis;
+    /// of the clicks, the values are along the click axes until SwapAxes
+    Orientation orientation;
+    T x_min, x_max, y_min, y_max;
+
+    FinishState(const XYinfo& old_axys)
+      : new_axis(old_axys), orientation(ORIENT_NORMAL),
+        x_min(0), x_max(0), y_min(0), y_max(0) {}
+};
+
+/// single precision, in pixels
+typedef FinishState<float, 1> FloatFinishState;
+/// integer, the sums of two clicks (half pixels)
+typedef FinishState<int64_t, 2> FixedFinishState;
+
+/// num/den rounded as round() does, halves away from zero (den > 0)
+inline int div_round(int64_t num, int64_t den)
+{
+    if (num >= 0)
+        return (int) ((2*num + den) / (2*den));
+    else
+        return (int) -((-2*num + den) / (2*den));
+}
+
+/// the orientation of the clicks, from all of them (see detect_orientation())
+struct DetectOrientation {
+    template <class State>
+    static void apply(const FinishInput& in, State& st)
+    {
+        st.orientation = detect_orientation(in.x, in.y);
+    }
+};
+
+/// the average (float) or sum (fixed) of the clicks on each side: along
+/// the click x axis, the left and right targets, or when the axes are
+/// swapped, the upper and lower ones (and the other way around for y)
+struct CombineClicks {
+    template <class State>
+    static void apply(const FinishInput& in, State& st)
+    {
+        // calculate average of clicks
+        if (!get_orientation_info(st.orientation).swap_xy) {
+            st.x_min = combine(in.x[UL], in.x[LL], st);
+            st.x_max = combine(in.x[UR], in.x[LR], st);
+            st.y_min = combine(in.y[UL], in.y[UR], st);
+            st.y_max = combine(in.y[LL], in.y[LR], st);
+        } else {
+            st.x_min = combine(in.x[UL], in.x[UR], st);
+            st.x_max = combine(in.x[LL], in.x[LR], st);
+            st.y_min = combine(in.y[UL], in.y[LL], st);
+            st.y_max = combine(in.y[UR], in.y[LR], st);
+        }
+    }
+
+    static float combine(int a, int b, const FloatFinishState&)
+    { return (a + b)/2.0; }
+    static int64_t combine(int a, int b, const FixedFinishState&)
+    { return (int64_t)a + b; }
+};
+
+/*
+ * When evdev detects an invert_X/Y option,
+ * it performs the following *crazy* code just before returning
+ * val = (pEvdev->absinfo[i].maximum - val + pEvdev->absinfo[i].minimum);
+ * undo this crazy step before doing the regular calibration routine
+ */
+struct UndoEvdevInversion {
+    template <class State>
+    static void apply(const FinishInput& in, State& st)
+    {
+        if (in.old_axys.x.invert) {
+            st.x_min = State::unit*in.width - st.x_min;
+            st.x_max = State::unit*in.width - st.x_max;
+            // avoid invert_x property from here on,
+            // the calibration code can handle this dynamically!
+            st.new_axis.x.invert = false;
+        }
+        if (in.old_axys.y.invert) {
+            st.y_min = State::unit*in.height - st.y_min;
+            st.y_max = State::unit*in.height - st.y_max;
+            // avoid invert_y property from here on,
+            // the calibration code can handle this dynamically!
+            st.new_axis.y.invert = false;
+        }
+    }
+};
+
+/// the screen was divided in num_blocks blocks, and the touch points were at
+/// one block away from the true edges of the screen (float)
+struct ExtrapolateBlocks {
+    static void apply(const FinishInput& in, FloatFinishState& st)
+    {
+        const float block_x = in.width/(float)num_blocks;
+        const float block_y = in.height/(float)num_blocks;
+        // rescale these blocks from the range of the drawn touchpoints to the range of the
+        // actually clicked coordinates, and substract/add from the clicked coordinates
+        // to obtain the coordinates corresponding to the edges of the screen.
+        float scale_x = (st.x_max - st.x_min)/(in.width - 2*block_x);
+        st.x_min -= block_x * scale_x;
+        st.x_max += block_x * scale_x;
+        float scale_y = (st.y_max - st.y_min)/(in.height - 2*block_y);
+        st.y_min -= block_y * scale_y;
+        st.y_max += block_y * scale_y;
+    }
+};
+
+/// now, undo the transformations done by the X server, to obtain the true 'raw' value in X.
+/// The raw value was scaled from old_axis to the device min/max, and from the device min/max
+/// to the screen min/max
+/// hence, the reverse transformation is from screen to old_axis (float)
+struct ScaleToOldAxis {
+    static void apply(const FinishInput& in, FloatFinishState& st)
+    {
+        const XYinfo& old = in.old_axys;
+        st.x_min = scaleAxis(st.x_min, old.x.max, old.x.min, in.width, 0);
+        st.x_max = scaleAxis(st.x_max, old.x.max, old.x.min, in.width, 0);
+        st.y_min = scaleAxis(st.y_min, old.y.max, old.y.min, in.height, 0);
+        st.y_max = scaleAxis(st.y_max, old.y.max, old.y.min, in.height, 0);
+    }
+};
+
+/// round and put in new_axis struct (float)
+struct RoundAxis {
+    static void apply(const FinishInput&, FloatFinishState& st)
+    {
+        st.new_axis.x.min = round(st.x_min); st.new_axis.x.max = round(st.x_max);
+        st.new_axis.y.min = round(st.y_min); st.new_axis.y.max = round(st.y_max);
+    }
+};
+
+/*
+ * ExtrapolateBlocks, ScaleToOldAxis and RoundAxis in integer arithmetic.
+ *
+ * With a and b the sums of the two clicks on the min and the max side of an
+ * axis and n = num_blocks, the extrapolation gives
+ *   min = a/2 - (b-a)/(2(n-2)) = (a(n-1) - b) / (2(n-2))
+ * (the block size cancels out), then scaling from 0..size to the old axis
+ *   old.min + (old.max - old.min) * min / size
+ * which is one fraction of integers, rounded exactly here.
+ */
+struct ExactScaleToOldAxis {
+    static void apply(const FinishInput& in, FixedFinishState& st)
+    {
+        const XYinfo& old = in.old_axys;
+        st.new_axis.x.min = value(st.x_min, st.x_max, old.x, in.width);
+        st.new_axis.x.max = value(st.x_max, st.x_min, old.x, in.width);
+        st.new_axis.y.min = value(st.y_min, st.y_max, old.y, in.height);
+        st.new_axis.y.max = value(st.y_max, st.y_min, old.y, in.height);
+    }
+
+    static int value(int64_t a, int64_t b, const AxisInfo& old, int size)
+    {
+        const int64_t den = 2*(int64_t)(num_blocks - 2)*size;
+        const int64_t num = (int64_t)old.min*den +
+                            (int64_t)(old.max - old.min)*(a*(num_blocks - 1) - b);
+        if (den == 0) {
+            printf("Divide by Zero in scaleAxis\n");
+            exit(1);
+        }
+        return den > 0 ? div_round(num, den) : div_round(-num, -den);
+    }
+};
+
+/// Should x and y be swapped? The click x values became the new y axis
+/// (and the other way around); inversions follow from min > max
+struct SwapAxes {
+    template <class State>
+    static void apply(const FinishInput&, State& st)
+    {
+        if (get_orientation_info(st.orientation).swap_xy) {
+            st.new_axis.swap_xy = !st.new_axis.swap_xy;
+            std::swap(st.new_axis.x.min, st.new_axis.y.min);
+            std::swap(st.new_axis.x.max, st.new_axis.y.max);
+        }
+    }
+};
+
+/// does nothing, fills the unused stages of FinishPipeline
+struct NoStage {
+    template <class State>
+    static void apply(const FinishInput&, State&) {}
+};
+
+template <class S1, class S2 = NoStage, class S3 = NoStage, class S4 = NoStage,
+          class S5 = NoStage, class S6 = NoStage, class S7 = NoStage, class S8 = NoStage>
+struct FinishPipeline {
+    template <class State>
+    static void apply(const FinishInput& in, State& st)
+    {
+        S1::apply(in, st);
+        S2::apply(in, st);
+        S3::apply(in, st);
+        S4::apply(in, st);
+        S5::apply(in, st);
+        S6::apply(in, st);
+        S7::apply(in, st);
+        S8::apply(in, st);
+    }
+
+    /// the new axys for the clicks
+    template <class State>
+    static XYinfo run(const FinishInput& in)
+    {
+        State st(in.old_axys);
+        apply(in, st);
+        return st.new_axis;
+    }
+};
+
+/// Calibrator::finish()
+typedef FinishPipeline<DetectOrientation, CombineClicks, ExtrapolateBlocks,
+                       ScaleToOldAxis, RoundAxis, SwapAxes> GenericFinish;
+typedef FinishPipeline<DetectOrientation, CombineClicks,
+                       ExactScaleToOldAxis, SwapAxes> GenericFixedFinish;
+
+/// CalibratorEvdev::finish(): inversion/swapping is relative to the old axis
+typedef FinishPipeline<DetectOrientation, CombineClicks, UndoEvdevInversion,
+                       ExtrapolateBlocks, ScaleToOldAxis, RoundAxis, SwapAxes> EvdevFinish;
+typedef FinishPipeline<DetectOrientation, CombineClicks, UndoEvdevInversion,
+                       ExactScaleToOldAxis, SwapAxes> EvdevFixedFinish;
+
+#endif
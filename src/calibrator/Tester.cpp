@@ -21,11 +21,12 @@
  */
 
 #include "calibrator/Tester.hpp"
+#include "calibrator/DriverEmulation.hpp"
 
 #include <cstdio>
 
-CalibratorTester::CalibratorTester(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry)
-  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry)
+CalibratorTester::CalibratorTester(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry, const CalibratorContext& context0)
+  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, 1, 0, context0)
 {
     //printf("Starting test driver\n");
 }
@@ -44,29 +45,5 @@ XYinfo CalibratorTester::emulate_driver(const XYinfo& raw, bool useNewAxis, cons
     else
         calibAxis = old_axys;
 
-    /**
-     * The most simple and intuitive calibration implementation
-     * if only all drivers sticked to this...
-     * Note that axis inversion is automatically supported
-     * by the ScaleAxis implementation (swapping max/min on
-     * one axis will result in the inversion being calculated)
-     */
-
-    // placeholder for the new coordinates
-    XYinfo result(raw);
-
-    // swap coordinates if asked
-    if (calibAxis.swap_xy) {
-        result.x.min = raw.y.min;
-        result.x.max = raw.y.max;
-        result.y.min = raw.x.min;
-        result.y.max = raw.x.max;
-    }
-
-    result.do_xf86ScaleAxis(device, calibAxis);
-
-    // the last step is usually done by the X server,
-    // or transparently somewhere on the way
-    result.do_xf86ScaleAxis(screen, device);
-    return result;
+    return driver_emulate<Xf86Driver>(raw, calibAxis, screen, device);
 }
@@ -38,7 +38,8 @@ protected:
 public:
     CalibratorTester(const char* const device_name, const XYinfo& axys,
         const int thr_misclick=0, const int thr_doubleclick=0,
-        const OutputType output_type=OUTYPE_AUTO, const char* geometry=0);
+        const OutputType output_type=OUTYPE_AUTO, const char* geometry=0,
+        const CalibratorContext& context = CalibratorContext());
 
     virtual bool finish_data(const XYinfo &new_axis);
 
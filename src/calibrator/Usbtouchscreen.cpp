@@ -31,27 +31,27 @@
  *************************/
 // The file to which the calibration parameters are saved.
 // (XXX: is this distribution dependend?)
-static const char *modprobe_conf_local = "/etc/modprobe.conf.local";
+static const char* const modprobe_conf_local = "/etc/modprobe.conf.local";
 
 // Prefix to the kernel path where we can set the parameters
-static const char *module_prefix = "/sys/module/usbtouchscreen/parameters";
+static const char* const module_prefix = "/sys/module/usbtouchscreen/parameters";
 
 // Names of kernel parameters
-static const char *p_range_x = "range_x";
-static const char *p_range_y = "range_y";
-static const char *p_min_x = "min_x";
-static const char *p_min_y = "min_y";
-static const char *p_max_x = "max_x";
-static const char *p_max_y = "max_y";
-static const char *p_transform_xy = "transform_xy";
-static const char *p_flip_x = "flip_x";
-static const char *p_flip_y = "flip_y";
-static const char *p_swap_xy = "swap_xy";
-
-CalibratorUsbtouchscreen::CalibratorUsbtouchscreen(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry, const bool use_timeout, const char* output_filename)
-  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename)
+static const char* const p_range_x = "range_x";
+static const char* const p_range_y = "range_y";
+static const char* const p_min_x = "min_x";
+static const char* const p_min_y = "min_y";
+static const char* const p_max_x = "max_x";
+static const char* const p_max_y = "max_y";
+static const char* const p_transform_xy = "transform_xy";
+static const char* const p_flip_x = "flip_x";
+static const char* const p_flip_y = "flip_y";
+static const char* const p_swap_xy = "swap_xy";
+
+CalibratorUsbtouchscreen::CalibratorUsbtouchscreen(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry, const bool use_timeout, const char* output_filename, const CalibratorContext& context0)
+  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename, context0)
 {
-    if (strcmp(device_name, "Usbtouchscreen") != 0)
+    if (device_name != "Usbtouchscreen")
         throw WrongCalibratorException("Not a usbtouchscreen device");
 
     // Reset the currently running kernel
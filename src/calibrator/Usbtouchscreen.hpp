@@ -35,10 +35,15 @@ public:
     CalibratorUsbtouchscreen(const char* const device_name, const XYinfo& axys,
          const int thr_misclick=0, const int thr_doubleclick=0,
         const OutputType output_type=OUTYPE_AUTO, const char* geometry=0,
-        const bool use_timeout=false, const char* output_filename = 0);
+        const bool use_timeout=false, const char* output_filename = 0,
+        const CalibratorContext& context = CalibratorContext());
     virtual ~CalibratorUsbtouchscreen();
 
     virtual bool finish_data(const XYinfo &new_axys);
+    virtual bool applies_dynamically() const
+    { return true; }
+    virtual CalibratorBackend get_backend() const
+    { return BACKEND_USBTOUCHSCREEN; }
 
 protected:
     // Globals for kernel parameters from startup.
@@ -21,13 +21,14 @@
  */
 
 #include "calibrator/XorgPrint.hpp"
+#include "output.hh"
 
 #include <cstdio>
 
-CalibratorXorgPrint::CalibratorXorgPrint(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry, const bool use_timeout, const char* output_filename)
-  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename)
+CalibratorXorgPrint::CalibratorXorgPrint(const char* const device_name0, const XYinfo& axys0, const int thr_misclick, const int thr_doubleclick, const OutputType output_type, const char* geometry, const bool use_timeout, const char* output_filename, const CalibratorContext& context0)
+  : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick, output_type, geometry, use_timeout, output_filename, context0)
 {
-    printf("Calibrating standard Xorg driver \"%s\"\n", device_name);
+    printf("Calibrating standard Xorg driver \"%s\"\n", device_name.c_str());
     printf("\tcurrent calibration values: min_x=%d, max_x=%d and min_y=%d, max_y=%d\n",
                 old_axys.x.min, old_axys.x.max, old_axys.y.min, old_axys.y.max);
     printf("\tIf these values are estimated wrong, either supply it manually with the --precalib option, or run the 'get_precalib.sh' script to automatically get it (through HAL).\n");
@@ -41,13 +42,8 @@ bool CalibratorXorgPrint::finish_data(const XYinfo &new_axys)
     printf("\t--> Making the calibration permanent <--\n");
     switch (output_type) {
         case OUTYPE_AUTO:
-            // xorg.conf.d or alternatively hal config
-            if (has_xorgconfd_support()) {
-                success &= output_xorgconfd(new_axys);
-            } else {
-                success &= output_hal(new_axys);
-            }
-            break;
+            // the caller did not ask the X server (see main_common.cpp),
+            // every X.Org since 1.8 reads xorg.conf.d
         case OUTYPE_XORGCONFD:
             success &= output_xorgconfd(new_axys);
             break;
@@ -75,28 +71,7 @@ bool CalibratorXorgPrint::output_xorgconfd(const XYinfo new_axys)
         printf("  writing calibration script to '%s'\n", output_filename);
 
     // xorg.conf.d snippet
-    char line[MAX_LINE_LEN];
-    std::string outstr;
-
-    outstr += "Section \"InputClass\"\n";
-    outstr += "	Identifier	\"calibration\"\n";
-    sprintf(line, "	MatchProduct	\"%s\"\n", sysfs_name);
-    outstr += line;
-    sprintf(line, "	Option	\"MinX\"	\"%d\"\n", new_axys.x.min);
-    outstr += line;
-    sprintf(line, "	Option	\"MaxX\"	\"%d\"\n", new_axys.x.max);
-    outstr += line;
-    sprintf(line, "	Option	\"MinY\"	\"%d\"\n", new_axys.y.min);
-    outstr += line;
-    sprintf(line, "	Option	\"MaxY\"	\"%d\"\n", new_axys.y.max);
-    outstr += line;
-    sprintf(line, "	Option	\"SwapXY\"	\"%d\" # unless it was already set to 1\n", new_axys.swap_xy);
-    outstr += line;
-    sprintf(line, "	Option	\"InvertX\"	\"%d\"  # unless it was already set\n", new_axys.x.invert);
-    outstr += line;
-    sprintf(line, "	Option	\"InvertY\"	\"%d\"  # unless it was already set\n", new_axys.y.invert);
-    outstr += line;
-    outstr += "EndSection\n";
+    const std::string outstr = format_xorgconfd(sysfs_name, new_axys, false);
 
     // console out
     printf("%s", outstr.c_str());
@@ -130,26 +105,7 @@ bool CalibratorXorgPrint::output_hal(const XYinfo new_axys)
         printf("  writing HAL calibration data to '%s'\n", output_filename);
 
     // HAL policy output
-    char line[MAX_LINE_LEN];
-    std::string outstr;
-
-    sprintf(line, "<match key=\"info.product\" contains=\"%s\">\n", sysfs_name);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.minx\" type=\"string\">%d</merge>\n", new_axys.x.min);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.maxx\" type=\"string\">%d</merge>\n", new_axys.x.max);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.miny\" type=\"string\">%d</merge>\n", new_axys.y.min);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.maxy\" type=\"string\">%d</merge>\n", new_axys.y.max);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.swapxy\" type=\"string\">%d</merge>\n", new_axys.swap_xy);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.invertx\" type=\"string\">%d</merge>\n", new_axys.x.invert);
-    outstr += line;
-    sprintf(line, "  <merge key=\"input.x11_options.inverty\" type=\"string\">%d</merge>\n", new_axys.y.invert);
-    outstr += line;
-    outstr += "</match>\n";
+    const std::string outstr = format_hal(sysfs_name, new_axys, false);
 
     // console out
     printf("%s", outstr.c_str());
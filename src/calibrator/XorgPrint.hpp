@@ -27,7 +27,9 @@
 
 /***************************************
  * Class for generic Xorg driver,
- * outputs new Xorg.conf and FDI policy, on stdout
+ * outputs new Xorg.conf and FDI policy, on stdout.
+ * Does not use X: OUTYPE_AUTO is resolved by the caller,
+ * otherwise it means xorg.conf.d
  ***************************************/
 class CalibratorXorgPrint: public Calibrator
 {
@@ -35,7 +37,8 @@ public:
     CalibratorXorgPrint(const char* const device_name, const XYinfo& axys,
         const int thr_misclick=0, const int thr_doubleclick=0,
         const OutputType output_type=OUTYPE_AUTO, const char* geometry=0,
-        const bool use_timeout=false, const char* output_filename = 0);
+        const bool use_timeout=false, const char* output_filename = 0,
+        const CalibratorContext& context = CalibratorContext());
 
     virtual bool finish_data(const XYinfo &new_axys);
 
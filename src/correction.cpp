@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "correction.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+static const char magic[4] = {'X', 'I', 'C', 'G'};
+static const uint32_t version = 1;
+static const int max_shift = 7; // keeps the interpolation within 32 bits
+static const int max_size = 1 << 15; // as the screen size in X
+static const int64_t max_nodes = 1 << 22;
+
+CorrectionGrid::CorrectionGrid()
+  : width(0), height(0), shift(default_shift), cols(0), rows(0)
+{
+}
+
+/*
+ * Barycentric coordinates of (px, py) in the triangle a, b, c.
+ * Returns false if the triangle is degenerate.
+ */
+static bool barycentric(double px, double py,
+                        double ax, double ay, double bx, double by,
+                        double cx, double cy, double w[3])
+{
+    const double det = (by - cy)*(ax - cx) + (cx - bx)*(ay - cy);
+    if (fabs(det) < 1e-9)
+        return false;
+
+    w[0] = ((by - cy)*(px - cx) + (cx - bx)*(py - cy)) / det;
+    w[1] = ((cy - ay)*(px - cx) + (ax - cx)*(py - cy)) / det;
+    w[2] = 1.0 - w[0] - w[1];
+    return true;
+}
+
+bool CorrectionGrid::fit(int nx, int ny,
+                         const std::vector<int>& target_x, const std::vector<int>& target_y,
+                         const std::vector<int>& click_x, const std::vector<int>& click_y,
+                         int width0, int height0, int shift0)
+{
+    if (nx < 2 || ny < 2 || nx > max_size || ny > max_size)
+        return false;
+    const unsigned n = nx * ny;
+    // the bounds load() checks
+    if (width0 <= 0 || height0 <= 0 || width0 > max_size || height0 > max_size ||
+        shift0 < 0 || shift0 > max_shift ||
+        target_x.size() != n || target_y.size() != n ||
+        click_x.size() != n || click_y.size() != n)
+        return false;
+
+    width = width0;
+    height = height0;
+    shift = shift0;
+    // one extra node, so that the right/lower neighbour always exists
+    cols = ((width - 1) >> shift) + 2;
+    rows = ((height - 1) >> shift) + 2;
+    nodes.resize(cols * rows);
+
+    // every grid cell gives two triangles, as indices in the point arrays
+    std::vector<int> tri;
+    for (int j = 0; j != ny - 1; j++) {
+        for (int i = 0; i != nx - 1; i++) {
+            const int ul = j*nx + i, ur = ul + 1;
+            const int ll = ul + nx, lr = ll + 1;
+            tri.push_back(ul); tri.push_back(ur); tri.push_back(ll);
+            tri.push_back(ur); tri.push_back(lr); tri.push_back(ll);
+        }
+    }
+
+    for (int r = 0; r != rows; r++) {
+        for (int c = 0; c != cols; c++) {
+            const double px = c << shift, py = r << shift;
+
+            // find the triangle of clicks containing the node, or the one it is
+            // least outside of: the warp is then linearly extrapolated
+            double best_w[3] = {0, 0, 0};
+            double best_out = -1;
+            unsigned best = 0;
+            for (unsigned t = 0; t < tri.size(); t += 3) {
+                double w[3];
+                if (!barycentric(px, py,
+                        click_x[tri[t]], click_y[tri[t]],
+                        click_x[tri[t+1]], click_y[tri[t+1]],
+                        click_x[tri[t+2]], click_y[tri[t+2]], w))
+                    continue;
+
+                const double out = std::max(0.0, -std::min(w[0], std::min(w[1], w[2])));
+                if (best_out < 0 || out < best_out) {
+                    best_out = out;
+                    best = t;
+                    memcpy(best_w, w, sizeof(w));
+                    if (out == 0)
+                        break;
+                }
+            }
+            if (best_out < 0) {
+                // all triangles degenerate
+                nodes.clear();
+                return false;
+            }
+
+            // same weights in the triangle of targets
+            double tx = 0, ty = 0;
+            for (int k = 0; k != 3; k++) {
+                tx += best_w[k] * target_x[tri[best + k]];
+                ty += best_w[k] * target_y[tri[best + k]];
+            }
+
+            const double scale = 1 << frac_bits;
+            const double lim = 32767;
+            Node& node = nodes[r * cols + c];
+            node.dx = (int16_t) std::max(-lim, std::min(lim, floor((tx - px) * scale + 0.5)));
+            node.dy = (int16_t) std::max(-lim, std::min(lim, floor((ty - py) * scale + 0.5)));
+        }
+    }
+
+    return true;
+}
+
+// little-endian helpers, the file can be read on any architecture
+static void put32(unsigned char* p, uint32_t v)
+{
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+}
+static uint32_t get32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool CorrectionGrid::save(const char* filename) const
+{
+    if (nodes.empty())
+        return false;
+
+    FILE* fid = fopen(filename, "wb");
+    if (fid == NULL) {
+        fprintf(stderr, "Error: Can't open '%s' for writing. Make sure you have the necessary rights\n", filename);
+        return false;
+    }
+
+    unsigned char header[28];
+    memcpy(header, magic, 4);
+    put32(header + 4, version);
+    put32(header + 8, width);
+    put32(header + 12, height);
+    put32(header + 16, shift);
+    put32(header + 20, cols);
+    put32(header + 24, rows);
+    bool ok = (fwrite(header, sizeof(header), 1, fid) == 1);
+
+    std::vector<unsigned char> data(nodes.size() * 4);
+    for (unsigned i = 0; i != nodes.size(); i++) {
+        data[4*i]     = (uint16_t)nodes[i].dx & 0xff;
+        data[4*i + 1] = (uint16_t)nodes[i].dx >> 8;
+        data[4*i + 2] = (uint16_t)nodes[i].dy & 0xff;
+        data[4*i + 3] = (uint16_t)nodes[i].dy >> 8;
+    }
+    ok &= (fwrite(&data[0], data.size(), 1, fid) == 1);
+
+    ok &= (fclose(fid) == 0);
+    if (!ok)
+        fprintf(stderr, "Error: failed writing correction grid to '%s'\n", filename);
+    return ok;
+}
+
+bool CorrectionGrid::load(const char* filename, bool report_errors)
+{
+    FILE* fid = fopen(filename, "rb");
+    if (fid == NULL) {
+        if (report_errors)
+            fprintf(stderr, "Error: Can't open '%s' for reading.\n", filename);
+        return false;
+    }
+
+    unsigned char header[28];
+    if (fread(header, sizeof(header), 1, fid) != 1 ||
+        memcmp(header, magic, 4) != 0 || get32(header + 4) != version) {
+        if (report_errors)
+            fprintf(stderr, "Error: '%s' is not a correction grid file.\n", filename);
+        fclose(fid);
+        return false;
+    }
+
+    const int w = get32(header + 8), h = get32(header + 12);
+    const int s = get32(header + 16);
+    const int c = get32(header + 20), r = get32(header + 24);
+    // the sizes first, so cols * rows can't overflow
+    if (w <= 0 || h <= 0 || w > max_size || h > max_size || s < 0 || s > max_shift ||
+        c != ((w - 1) >> s) + 2 || r != ((h - 1) >> s) + 2 || (int64_t)c * r > max_nodes) {
+        if (report_errors)
+            fprintf(stderr, "Error: invalid correction grid in '%s'.\n", filename);
+        fclose(fid);
+        return false;
+    }
+
+    std::vector<unsigned char> data(c * r * 4);
+    const bool ok = (fread(&data[0], data.size(), 1, fid) == 1);
+    fclose(fid);
+    if (!ok) {
+        if (report_errors)
+            fprintf(stderr, "Error: truncated correction grid in '%s'.\n", filename);
+        return false;
+    }
+
+    width = w; height = h; shift = s; cols = c; rows = r;
+    nodes.resize(c * r);
+    for (unsigned i = 0; i != nodes.size(); i++) {
+        nodes[i].dx = (int16_t)(data[4*i] | (data[4*i + 1] << 8));
+        nodes[i].dy = (int16_t)(data[4*i + 2] | (data[4*i + 3] << 8));
+    }
+
+    return true;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _correction_hh
+#define _correction_hh
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Non-linear correction of the remaining error after the (linear) calibration,
+ * eg. resistive panels that bow near the edges.
+ *
+ * The correction is fitted from a dense grid of targets and the clicks on them,
+ * as a triangulated mesh warp: every grid cell is split in two triangles, and
+ * a point is mapped from the triangle of clicks to the triangle of targets.
+ *
+ * The warp is then sampled on a regular lookup grid with a cell size of
+ * 2^shift pixels, storing the displacement of every node. Correcting a point
+ * is a bilinear interpolation between the 4 nodes around it, using only
+ * shifts and multiplications.
+ *
+ * File format (all values little-endian):
+ *   char[4]  magic "XICG"
+ *   uint32   version (1)
+ *   int32    width, height   screen size the grid was fitted for
+ *   int32    shift           cell size is 2^shift pixels
+ *   int32    cols, rows      number of nodes
+ *   int16[2] dx, dy          per node, row-major, in 1/16th of a pixel
+ */
+class CorrectionGrid
+{
+public:
+    CorrectionGrid();
+
+    /// fit the grid from nx*ny targets (row-major) and the clicks on them,
+    /// returns false if they don't match or the screen size is out of range
+    bool fit(int nx, int ny,
+             const std::vector<int>& target_x, const std::vector<int>& target_y,
+             const std::vector<int>& click_x, const std::vector<int>& click_y,
+             int width, int height, int shift = default_shift);
+
+    /// whether a grid is fitted or loaded
+    bool empty() const
+    { return nodes.empty(); }
+
+    /// correct the given screen coordinates
+    void correct(int& x, int& y) const
+    {
+        if (nodes.empty())
+            return;
+
+        // clamp to the screen, the grid only covers that
+        const int px = x < 0 ? 0 : (x >= width ? width - 1 : x);
+        const int py = y < 0 ? 0 : (y >= height ? height - 1 : y);
+
+        const int size = 1 << shift;
+        const int fx = px & (size - 1), fy = py & (size - 1);
+        const Node* n = &nodes[(py >> shift) * cols + (px >> shift)];
+        const Node* s = n + cols;
+
+        // bilinear interpolation, in 1/16th pixels * size^2
+        const int32_t dx =
+            (n[0].dx * (size - fx) + n[1].dx * fx) * (size - fy) +
+            (s[0].dx * (size - fx) + s[1].dx * fx) * fy;
+        const int32_t dy =
+            (n[0].dy * (size - fx) + n[1].dy * fx) * (size - fy) +
+            (s[0].dy * (size - fx) + s[1].dy * fx) * fy;
+
+        // round to whole pixels (arithmetic shift, also for negative values)
+        const int out_shift = 2*shift + frac_bits;
+        x += (dx + (1 << (out_shift - 1))) >> out_shift;
+        y += (dy + (1 << (out_shift - 1))) >> out_shift;
+    }
+
+    /// write the grid to a file, returns false on failure
+    bool save(const char* filename) const;
+    /// read a grid from a file, returns false on failure
+    /// (and prints why, unless report_errors is false)
+    bool load(const char* filename, bool report_errors = true);
+
+    /// the screen size the grid was fitted for
+    int get_width() const
+    { return width; }
+    int get_height() const
+    { return height; }
+
+    /// default cell size of 32 pixels
+    static const int default_shift = 5;
+
+private:
+    /// fixed-point precision of the stored displacements
+    static const int frac_bits = 4;
+
+    struct Node {
+        int16_t dx, dy;
+    };
+
+    int width, height;
+    int shift;
+    int cols, rows;
+    std::vector<Node> nodes;
+};
+
+#endif
@@ -0,0 +1,631 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "gui/fb.hpp"
+#include "gui/gui_common.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include <linux/fb.h>
+
+/*
+ * 8x16 glyphs of the printable ASCII characters (space to '~'), one byte
+ * per row with the leftmost pixel in the top bit, baseline at row 11.
+ * Rasterized from DejaVu Sans Mono at 13 pixels.
+ */
+static const unsigned char font_glyphs[95][16] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // ' '
+    {0x00,0x00,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x10,0x10,0x00,0x00,0x00,0x00,0x00}, // '!'
+    {0x00,0x00,0x28,0x28,0x28,0x28,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '"'
+    {0x00,0x12,0x12,0x16,0x7f,0x24,0x24,0xfe,0x28,0x48,0x48,0x00,0x00,0x00,0x00,0x00}, // '#'
+    {0x00,0x00,0x08,0x3e,0x49,0x48,0x38,0x0e,0x09,0x49,0x3e,0x08,0x08,0x00,0x00,0x00}, // '$'
+    {0x00,0x00,0x60,0x90,0x90,0x62,0x1c,0x66,0x09,0x09,0x06,0x00,0x00,0x00,0x00,0x00}, // '%'
+    {0x00,0x00,0x1c,0x20,0x20,0x30,0x49,0x4d,0x45,0x62,0x3d,0x00,0x00,0x00,0x00,0x00}, // '&'
+    {0x00,0x00,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '\''
+    {0x0c,0x08,0x08,0x10,0x10,0x10,0x10,0x10,0x10,0x08,0x08,0x04,0x00,0x00,0x00,0x00}, // '('
+    {0x30,0x10,0x10,0x08,0x08,0x08,0x08,0x08,0x08,0x10,0x10,0x30,0x00,0x00,0x00,0x00}, // ')'
+    {0x00,0x00,0x08,0x49,0x3e,0x1c,0x6b,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '*'
+    {0x00,0x00,0x00,0x10,0x10,0x10,0xfe,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00,0x00}, // '+'
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x10,0x20,0x00,0x00,0x00}, // ','
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '-'
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00}, // '.'
+    {0x00,0x00,0x02,0x04,0x04,0x08,0x08,0x18,0x10,0x10,0x20,0x20,0x40,0x00,0x00,0x00}, // '/'
+    {0x00,0x00,0x1c,0x22,0x41,0x41,0x49,0x41,0x41,0x22,0x1c,0x00,0x00,0x00,0x00,0x00}, // '0'
+    {0x00,0x00,0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x3e,0x00,0x00,0x00,0x00,0x00}, // '1'
+    {0x00,0x00,0x3e,0x43,0x01,0x01,0x02,0x0c,0x18,0x20,0x7f,0x00,0x00,0x00,0x00,0x00}, // '2'
+    {0x00,0x00,0x3e,0x41,0x01,0x03,0x1c,0x03,0x01,0x43,0x3e,0x00,0x00,0x00,0x00,0x00}, // '3'
+    {0x00,0x00,0x06,0x0a,0x1a,0x12,0x22,0x42,0x7f,0x02,0x02,0x00,0x00,0x00,0x00,0x00}, // '4'
+    {0x00,0x00,0x7e,0x40,0x40,0x7c,0x03,0x01,0x01,0x43,0x3c,0x00,0x00,0x00,0x00,0x00}, // '5'
+    {0x00,0x00,0x1e,0x21,0x40,0x5e,0x63,0x41,0x41,0x23,0x1e,0x00,0x00,0x00,0x00,0x00}, // '6'
+    {0x00,0x00,0x7f,0x02,0x02,0x04,0x04,0x08,0x18,0x10,0x20,0x00,0x00,0x00,0x00,0x00}, // '7'
+    {0x00,0x00,0x3e,0x41,0x41,0x41,0x3e,0x63,0x41,0x61,0x3e,0x00,0x00,0x00,0x00,0x00}, // '8'
+    {0x00,0x00,0x3c,0x62,0x41,0x41,0x63,0x3d,0x01,0x42,0x3c,0x00,0x00,0x00,0x00,0x00}, // '9'
+    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00}, // ':'
+    {0x00,0x00,0x00,0x00,0x18,0x18,0x00,0x00,0x00,0x18,0x18,0x10,0x20,0x00,0x00,0x00}, // ';'
+    {0x00,0x00,0x00,0x00,0x01,0x0e,0x70,0x70,0x0e,0x01,0x00,0x00,0x00,0x00,0x00,0x00}, // '<'
+    {0x00,0x00,0x00,0x00,0x00,0x7f,0x00,0x00,0x7f,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '='
+    {0x00,0x00,0x00,0x00,0x40,0x38,0x07,0x07,0x38,0x40,0x00,0x00,0x00,0x00,0x00,0x00}, // '>'
+    {0x00,0x00,0x38,0x44,0x04,0x08,0x10,0x10,0x00,0x10,0x10,0x00,0x00,0x00,0x00,0x00}, // '?'
+    {0x00,0x00,0x1e,0x33,0x21,0x47,0x49,0x49,0x49,0x47,0x20,0x30,0x1e,0x00,0x00,0x00}, // '@'
+    {0x00,0x00,0x08,0x14,0x14,0x14,0x22,0x22,0x3e,0x63,0x41,0x00,0x00,0x00,0x00,0x00}, // 'A'
+    {0x00,0x00,0x7e,0x41,0x41,0x41,0x7e,0x41,0x41,0x41,0x7e,0x00,0x00,0x00,0x00,0x00}, // 'B'
+    {0x00,0x00,0x1e,0x21,0x40,0x40,0x40,0x40,0x40,0x21,0x1e,0x00,0x00,0x00,0x00,0x00}, // 'C'
+    {0x00,0x00,0x7c,0x42,0x41,0x41,0x41,0x41,0x41,0x42,0x7c,0x00,0x00,0x00,0x00,0x00}, // 'D'
+    {0x00,0x00,0x7f,0x40,0x40,0x40,0x7f,0x40,0x40,0x40,0x7f,0x00,0x00,0x00,0x00,0x00}, // 'E'
+    {0x00,0x00,0x7f,0x40,0x40,0x40,0x7f,0x40,0x40,0x40,0x40,0x00,0x00,0x00,0x00,0x00}, // 'F'
+    {0x00,0x00,0x1e,0x21,0x40,0x40,0x43,0x41,0x41,0x21,0x1e,0x00,0x00,0x00,0x00,0x00}, // 'G'
+    {0x00,0x00,0x41,0x41,0x41,0x41,0x7f,0x41,0x41,0x41,0x41,0x00,0x00,0x00,0x00,0x00}, // 'H'
+    {0x00,0x00,0x7c,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x7c,0x00,0x00,0x00,0x00,0x00}, // 'I'
+    {0x00,0x00,0x1c,0x04,0x04,0x04,0x04,0x04,0x04,0x44,0x38,0x00,0x00,0x00,0x00,0x00}, // 'J'
+    {0x00,0x00,0x42,0x44,0x48,0x50,0x70,0x48,0x44,0x44,0x42,0x00,0x00,0x00,0x00,0x00}, // 'K'
+    {0x00,0x00,0x40,0x40,0x40,0x40,0x40,0x40,0x40,0x40,0x7f,0x00,0x00,0x00,0x00,0x00}, // 'L'
+    {0x00,0x00,0x63,0x63,0x55,0x55,0x55,0x49,0x41,0x41,0x41,0x00,0x00,0x00,0x00,0x00}, // 'M'
+    {0x00,0x00,0x61,0x61,0x51,0x51,0x49,0x45,0x45,0x43,0x43,0x00,0x00,0x00,0x00,0x00}, // 'N'
+    {0x00,0x00,0x1c,0x22,0x41,0x41,0x41,0x41,0x41,0x22,0x1c,0x00,0x00,0x00,0x00,0x00}, // 'O'
+    {0x00,0x00,0x7e,0x43,0x41,0x41,0x43,0x7e,0x40,0x40,0x40,0x00,0x00,0x00,0x00,0x00}, // 'P'
+    {0x00,0x00,0x1c,0x22,0x41,0x41,0x41,0x41,0x41,0x23,0x1e,0x06,0x02,0x00,0x00,0x00}, // 'Q'
+    {0x00,0x00,0xfc,0x86,0x82,0x82,0xfc,0x84,0x82,0x82,0x81,0x00,0x00,0x00,0x00,0x00}, // 'R'
+    {0x00,0x00,0x3e,0x61,0x40,0x60,0x3e,0x03,0x01,0x43,0x3e,0x00,0x00,0x00,0x00,0x00}, // 'S'
+    {0x00,0x00,0xfe,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00}, // 'T'
+    {0x00,0x00,0x41,0x41,0x41,0x41,0x41,0x41,0x41,0x41,0x3e,0x00,0x00,0x00,0x00,0x00}, // 'U'
+    {0x00,0x00,0x41,0x63,0x22,0x22,0x22,0x14,0x14,0x14,0x08,0x00,0x00,0x00,0x00,0x00}, // 'V'
+    {0x00,0x00,0x81,0x81,0x81,0x5a,0x5a,0x5a,0x66,0x66,0x66,0x00,0x00,0x00,0x00,0x00}, // 'W'
+    {0x00,0x00,0x63,0x22,0x14,0x1c,0x08,0x14,0x36,0x22,0x41,0x00,0x00,0x00,0x00,0x00}, // 'X'
+    {0x00,0x00,0x82,0x44,0x28,0x28,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00}, // 'Y'
+    {0x00,0x00,0x7f,0x03,0x06,0x04,0x08,0x10,0x30,0x60,0x7f,0x00,0x00,0x00,0x00,0x00}, // 'Z'
+    {0x1c,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x1c,0x00,0x00,0x00,0x00}, // '['
+    {0x00,0x00,0x40,0x20,0x20,0x10,0x10,0x18,0x08,0x08,0x04,0x04,0x02,0x00,0x00,0x00}, // '\\'
+    {0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x38,0x00,0x00,0x00,0x00}, // ']'
+    {0x00,0x00,0x10,0x28,0x44,0xc6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '^'
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xff,0x00,0x00}, // '_'
+    {0x00,0x10,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // '`'
+    {0x00,0x00,0x00,0x00,0x1c,0x22,0x02,0x3e,0x42,0x46,0x3a,0x00,0x00,0x00,0x00,0x00}, // 'a'
+    {0x40,0x40,0x40,0x40,0x7c,0x66,0x42,0x42,0x42,0x66,0x7c,0x00,0x00,0x00,0x00,0x00}, // 'b'
+    {0x00,0x00,0x00,0x00,0x1c,0x22,0x40,0x40,0x40,0x22,0x1c,0x00,0x00,0x00,0x00,0x00}, // 'c'
+    {0x02,0x02,0x02,0x02,0x3e,0x66,0x42,0x42,0x42,0x66,0x3e,0x00,0x00,0x00,0x00,0x00}, // 'd'
+    {0x00,0x00,0x00,0x00,0x3c,0x66,0x42,0x7e,0x40,0x62,0x3c,0x00,0x00,0x00,0x00,0x00}, // 'e'
+    {0x0c,0x10,0x10,0x10,0x7c,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00,0x00,0x00}, // 'f'
+    {0x00,0x00,0x00,0x00,0x3e,0x66,0x42,0x42,0x42,0x66,0x3a,0x02,0x22,0x1c,0x00,0x00}, // 'g'
+    {0x40,0x40,0x40,0x40,0x5c,0x62,0x42,0x42,0x42,0x42,0x42,0x00,0x00,0x00,0x00,0x00}, // 'h'
+    {0x10,0x00,0x00,0x00,0x70,0x10,0x10,0x10,0x10,0x10,0x7c,0x00,0x00,0x00,0x00,0x00}, // 'i'
+    {0x08,0x00,0x00,0x00,0x38,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x70,0x00,0x00}, // 'j'
+    {0x40,0x40,0x40,0x40,0x44,0x48,0x50,0x70,0x48,0x44,0x42,0x00,0x00,0x00,0x00,0x00}, // 'k'
+    {0x70,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x0e,0x00,0x00,0x00,0x00,0x00}, // 'l'
+    {0x00,0x00,0x00,0x00,0x7f,0x49,0x49,0x49,0x49,0x49,0x49,0x00,0x00,0x00,0x00,0x00}, // 'm'
+    {0x00,0x00,0x00,0x00,0x5c,0x62,0x42,0x42,0x42,0x42,0x42,0x00,0x00,0x00,0x00,0x00}, // 'n'
+    {0x00,0x00,0x00,0x00,0x3c,0x66,0x42,0x42,0x42,0x66,0x3c,0x00,0x00,0x00,0x00,0x00}, // 'o'
+    {0x00,0x00,0x00,0x00,0x7c,0x66,0x42,0x42,0x42,0x66,0x7c,0x40,0x40,0x40,0x00,0x00}, // 'p'
+    {0x00,0x00,0x00,0x00,0x3e,0x66,0x42,0x42,0x42,0x66,0x3a,0x02,0x02,0x02,0x00,0x00}, // 'q'
+    {0x00,0x00,0x00,0x00,0x3c,0x32,0x20,0x20,0x20,0x20,0x20,0x00,0x00,0x00,0x00,0x00}, // 'r'
+    {0x00,0x00,0x00,0x00,0x3c,0x42,0x40,0x3c,0x02,0x42,0x3c,0x00,0x00,0x00,0x00,0x00}, // 's'
+    {0x00,0x00,0x10,0x10,0x7e,0x10,0x10,0x10,0x10,0x10,0x0e,0x00,0x00,0x00,0x00,0x00}, // 't'
+    {0x00,0x00,0x00,0x00,0x42,0x42,0x42,0x42,0x42,0x46,0x3a,0x00,0x00,0x00,0x00,0x00}, // 'u'
+    {0x00,0x00,0x00,0x00,0x42,0x66,0x24,0x24,0x3c,0x18,0x18,0x00,0x00,0x00,0x00,0x00}, // 'v'
+    {0x00,0x00,0x00,0x00,0x81,0x81,0x5a,0x5a,0x5a,0x24,0x24,0x00,0x00,0x00,0x00,0x00}, // 'w'
+    {0x00,0x00,0x00,0x00,0x66,0x24,0x18,0x18,0x18,0x24,0x66,0x00,0x00,0x00,0x00,0x00}, // 'x'
+    {0x00,0x00,0x00,0x00,0x42,0x22,0x24,0x24,0x14,0x18,0x08,0x08,0x10,0x30,0x00,0x00}, // 'y'
+    {0x00,0x00,0x00,0x00,0x7e,0x02,0x04,0x18,0x20,0x40,0x7e,0x00,0x00,0x00,0x00,0x00}, // 'z'
+    {0x1c,0x10,0x10,0x10,0x10,0x60,0x10,0x10,0x10,0x10,0x10,0x0c,0x00,0x00,0x00,0x00}, // '{'
+    {0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x10,0x00,0x00,0x00}, // '|'
+    {0x70,0x10,0x10,0x10,0x10,0x0c,0x10,0x10,0x10,0x10,0x10,0x60,0x00,0x00,0x00,0x00}, // '}'
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x39,0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00} // '~'
+};
+static const int glyph_width = 8;
+
+static const double pi = 3.14159265358979323846;
+
+Framebuffer::Framebuffer(const char* path, int width0, int height0)
+  : fd(-1), width(width0), height(height0), bits_per_pixel(32),
+    line_length(width0*4), red_offset(16), red_length(8), green_offset(8),
+    green_length(8), blue_offset(0), blue_length(8), map(NULL),
+    map_length(0), screen(NULL)
+{
+    size_t screen_offset = 0;
+    if (width0 > 0) {
+        // a file as XRGB8888 image
+        if (height0 <= 0)
+            throw std::runtime_error("Invalid framebuffer geometry");
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            throw std::runtime_error(std::string("Unable to open ") + path + ": " + strerror(errno));
+        map_length = (size_t) line_length * height;
+        if (ftruncate(fd, map_length) != 0) {
+            const std::string err = strerror(errno);
+            close(fd);
+            throw std::runtime_error(std::string("Unable to resize ") + path + ": " + err);
+        }
+    } else {
+        fd = open(path, O_RDWR);
+        if (fd < 0)
+            throw std::runtime_error(std::string("Unable to open ") + path + ": " + strerror(errno));
+
+        struct fb_var_screeninfo var;
+        struct fb_fix_screeninfo fix;
+        if (ioctl(fd, FBIOGET_VSCREENINFO, &var) < 0 ||
+            ioctl(fd, FBIOGET_FSCREENINFO, &fix) < 0) {
+            close(fd);
+            throw std::runtime_error(std::string(path) + " is not a framebuffer device, give the geometry of an image file");
+        }
+        if (fix.visual != FB_VISUAL_TRUECOLOR ||
+            (var.bits_per_pixel != 16 && var.bits_per_pixel != 24 && var.bits_per_pixel != 32)) {
+            close(fd);
+            throw std::runtime_error(std::string(path) + " has an unsupported pixel format");
+        }
+        width = var.xres;
+        height = var.yres;
+        bits_per_pixel = var.bits_per_pixel;
+        line_length = fix.line_length;
+        red_offset = var.red.offset;
+        red_length = var.red.length;
+        green_offset = var.green.offset;
+        green_length = var.green.length;
+        blue_offset = var.blue.offset;
+        blue_length = var.blue.length;
+        map_length = fix.smem_len;
+        screen_offset = (size_t) var.yoffset * line_length + var.xoffset * (bits_per_pixel/8);
+    }
+
+    void* p = mmap(NULL, map_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        const std::string err = strerror(errno);
+        close(fd);
+        throw std::runtime_error(std::string("Unable to map ") + path + ": " + err);
+    }
+    map = (unsigned char*) p;
+    screen = map + screen_offset;
+    back.assign((size_t) width * height, 0);
+}
+
+Framebuffer::~Framebuffer()
+{
+    munmap(map, map_length);
+    close(fd);
+}
+
+uint32_t Framebuffer::get_pixel(int x, int y) const
+{
+    const unsigned char* p = screen + (size_t) y * line_length + x * (bits_per_pixel/8);
+    uint32_t v = 0;
+    for (int i = bits_per_pixel/8 - 1; i >= 0; i--)
+        v = (v << 8) | p[i];
+
+    const int r = (v >> red_offset) & ((1 << red_length) - 1);
+    const int g = (v >> green_offset) & ((1 << green_length) - 1);
+    const int b = (v >> blue_offset) & ((1 << blue_length) - 1);
+    return rgb(r << (8 - red_length), g << (8 - green_length), b << (8 - blue_length));
+}
+
+void Framebuffer::fill_rect(int x, int y, int w, int h, uint32_t color)
+{
+    const int x0 = std::max(x, 0), x1 = std::min(x + w, width);
+    const int y0 = std::max(y, 0), y1 = std::min(y + h, height);
+    for (int j = y0; j < y1; j++)
+        std::fill(back.begin() + (size_t) j*width + x0,
+                  back.begin() + (size_t) j*width + std::max(x0, x1), color);
+}
+
+void Framebuffer::draw_rect(int x, int y, int w, int h, uint32_t color)
+{
+    fill_rect(x, y, w, 1, color);
+    fill_rect(x, y + h - 1, w, 1, color);
+    fill_rect(x, y, 1, h, color);
+    fill_rect(x + w - 1, y, 1, h, color);
+}
+
+void Framebuffer::draw_circle(int cx, int cy, int r, uint32_t color)
+{
+    // midpoint circle
+    int x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        put_pixel(cx + x, cy + y, color); put_pixel(cx - x, cy + y, color);
+        put_pixel(cx + x, cy - y, color); put_pixel(cx - x, cy - y, color);
+        put_pixel(cx + y, cy + x, color); put_pixel(cx - y, cy + x, color);
+        put_pixel(cx + y, cy - x, color); put_pixel(cx - y, cy - x, color);
+        y++;
+        if (err < 0) {
+            err += 2*y + 1;
+        } else {
+            x--;
+            err += 2*(y - x) + 1;
+        }
+    }
+}
+
+void Framebuffer::fill_ring(int cx, int cy, int r_outer, int r_inner, double fraction,
+                            uint32_t color)
+{
+    for (int dy = -r_outer; dy <= r_outer; dy++) {
+        for (int dx = -r_outer; dx <= r_outer; dx++) {
+            const int d2 = dx*dx + dy*dy;
+            if (d2 > r_outer*r_outer || d2 < r_inner*r_inner)
+                continue;
+            if (fraction < 1) {
+                // clockwise from 12 o'clock, in turns
+                double turn = atan2((double) dx, (double) -dy) / (2*pi);
+                if (turn < 0)
+                    turn += 1;
+                if (turn > fraction)
+                    continue;
+            }
+            put_pixel(cx + dx, cy + dy, color);
+        }
+    }
+}
+
+int Framebuffer::text_width(const char* text)
+{
+    return strlen(text) * glyph_width;
+}
+
+void Framebuffer::draw_text(int x, int y, const char* text, uint32_t color)
+{
+    for (; *text != '\0'; text++, x += glyph_width) {
+        const unsigned char c = *text;
+        if (c <= ' ' || c > '~')
+            continue;
+        const unsigned char* glyph = font_glyphs[c - ' '];
+        for (int row = 0; row < text_height; row++)
+            for (int col = 0; col < glyph_width; col++)
+                if (glyph[row] & (0x80 >> col))
+                    put_pixel(x + col, y + row, color);
+    }
+}
+
+void Framebuffer::present(int x, int y, int w, int h)
+{
+    const int x0 = std::max(x, 0), x1 = std::min(x + w, width);
+    const int y0 = std::max(y, 0), y1 = std::min(y + h, height);
+    const int bytes = bits_per_pixel/8;
+    for (int j = y0; j < y1; j++) {
+        const uint32_t* src = &back[(size_t) j*width];
+        unsigned char* dst = screen + (size_t) j*line_length + x0*bytes;
+        for (int i = x0; i < x1; i++, dst += bytes) {
+            const uint32_t c = src[i];
+            const uint32_t v =
+                (((c >> 16) & 0xff) >> (8 - red_length)) << red_offset |
+                (((c >> 8) & 0xff) >> (8 - green_length)) << green_offset |
+                ((c & 0xff) >> (8 - blue_length)) << blue_offset;
+            for (int b = 0; b < bytes; b++)
+                dst[b] = v >> (8*b);
+        }
+    }
+}
+
+
+TouchInput::TouchInput(const char* node)
+  : fd(-1), mt_only(false), slot(0), cur_x(0), cur_y(0), touching(false),
+    pressed(false)
+{
+    fd = open(node, O_RDONLY | O_NONBLOCK);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Unable to open ") + node + ": " + strerror(errno));
+
+    struct input_absinfo abs_x, abs_y;
+    if (ioctl(fd, EVIOCGABS(ABS_X), &abs_x) < 0 ||
+        ioctl(fd, EVIOCGABS(ABS_Y), &abs_y) < 0) {
+        mt_only = true;
+        if (ioctl(fd, EVIOCGABS(ABS_MT_POSITION_X), &abs_x) < 0 ||
+            ioctl(fd, EVIOCGABS(ABS_MT_POSITION_Y), &abs_y) < 0) {
+            close(fd);
+            throw std::runtime_error(std::string(node) + " has no absolute X/Y axes");
+        }
+    }
+    range = XYinfo(abs_x.minimum, abs_x.maximum, abs_y.minimum, abs_y.maximum);
+
+    char buf[256];
+    memset(buf, 0, sizeof(buf));
+    ioctl(fd, EVIOCGNAME(sizeof(buf) - 1), buf);
+    name = buf;
+
+    // keep the taps from anything else reading the device
+    ioctl(fd, EVIOCGRAB, (void*)1);
+}
+
+TouchInput::TouchInput(const XYinfo& range0)
+  : fd(-1), range(range0), mt_only(false), slot(0), cur_x(0), cur_y(0),
+    touching(false), pressed(false)
+{
+}
+
+TouchInput::~TouchInput()
+{
+    if (fd >= 0) {
+        ioctl(fd, EVIOCGRAB, (void*)0);
+        close(fd);
+    }
+}
+
+bool TouchInput::decode(const input_event& ev, int& x, int& y)
+{
+    switch (ev.type) {
+        case EV_ABS:
+            if (ev.code == ABS_MT_SLOT)
+                slot = ev.value;
+            else if (!mt_only && ev.code == ABS_X)
+                cur_x = ev.value;
+            else if (!mt_only && ev.code == ABS_Y)
+                cur_y = ev.value;
+            else if (mt_only && slot == 0 && ev.code == ABS_MT_POSITION_X)
+                cur_x = ev.value;
+            else if (mt_only && slot == 0 && ev.code == ABS_MT_POSITION_Y)
+                cur_y = ev.value;
+            break;
+
+        case EV_KEY:
+            if (ev.code == BTN_TOUCH || ev.code == BTN_LEFT) {
+                if (ev.value && !touching)
+                    pressed = true;
+                touching = (ev.value != 0);
+            }
+            break;
+
+        case EV_SYN:
+            if (ev.code == SYN_REPORT && pressed) {
+                pressed = false;
+                x = cur_x;
+                y = cur_y;
+                return true;
+            }
+            break;
+    }
+    return false;
+}
+
+bool TouchInput::read_taps(std::vector<int>& taps)
+{
+    struct input_event ev[64];
+    ssize_t n;
+    while ((n = read(fd, ev, sizeof(ev))) > 0) {
+        for (int i = 0; i < n / (ssize_t) sizeof(ev[0]); i++) {
+            int x, y;
+            if (decode(ev[i], x, y)) {
+                taps.push_back(x);
+                taps.push_back(y);
+            }
+        }
+    }
+    return n < 0 && (errno == EAGAIN || errno == EINTR);
+}
+
+
+const uint32_t GuiCalibratorFB::colors[GuiCalibratorFB::NUM_COLORS] = {
+    Framebuffer::rgb(0, 0, 0),          // BLACK
+    Framebuffer::rgb(255, 255, 255),    // WHITE
+    Framebuffer::rgb(190, 190, 190),    // GRAY
+    Framebuffer::rgb(105, 105, 105),    // DIMGRAY
+    Framebuffer::rgb(255, 0, 0)         // RED
+};
+
+/// CLOCK_MONOTONIC in ms
+static long now_ms()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000L + t.tv_nsec/1000000;
+}
+
+GuiCalibratorFB::GuiCalibratorFB(Calibrator* calibrator0, Framebuffer& fb0,
+                                 TouchInput& touch0, const XYinfo& axys0)
+  : calibrator(calibrator0), session(calibrator0), fb(fb0), touch(touch0),
+    axys(axys0)
+{
+    session.set_display_size(fb.get_width(), fb.get_height());
+    fprintf(stderr, "INFO: width=%d, height=%d\n", fb.get_width(), fb.get_height());
+}
+
+// terminal settings of stdin, restored on exit
+static struct termios saved_termios;
+
+static void restore_termios()
+{
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+}
+
+int GuiCalibratorFB::run()
+{
+    // on a console, any key aborts (as in the other GUIs)
+    const bool keys = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_termios) == 0;
+    if (keys) {
+        struct termios raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        atexit(restore_termios);
+    }
+
+    // the first frame
+    calibrator->trace_latency("expose");
+    redraw();
+    fb.present();
+    trace_redraw();
+
+    long next_tick = now_ms() + time_step;
+    while (1) {
+        struct pollfd pfd[2];
+        pfd[0].fd = touch.get_fd();
+        pfd[0].events = POLLIN;
+        pfd[1].fd = STDIN_FILENO;
+        pfd[1].events = POLLIN;
+        int timeout = -1;
+        if (calibrator->get_use_timeout())
+            timeout = std::max(0L, next_tick - now_ms());
+
+        const int ret = poll(pfd, keys ? 2 : 1, timeout);
+        if (ret < 0 && errno != EINTR) {
+            fprintf(stderr, "Error: waiting for the touchscreen: %s\n", strerror(errno));
+            return 1;
+        }
+
+        if (ret > 0 && keys && (pfd[1].revents & POLLIN))
+            session.key_press();
+
+        if (ret > 0 && pfd[0].revents != 0) {
+            std::vector<int> taps;
+            const bool ok = touch.read_taps(taps);
+            for (size_t i = 0; i + 1 < taps.size(); i += 2)
+                on_tap(taps[i], taps[i+1]);
+            if (!ok) {
+                fprintf(stderr, "Error: lost the touchscreen\n");
+                return 1;
+            }
+        }
+
+        if (calibrator->get_use_timeout() && now_ms() >= next_tick) {
+            next_tick += time_step;
+            on_timer();
+        }
+    }
+    return 0;
+}
+
+void GuiCalibratorFB::on_tap(int x, int y)
+{
+    calibrator->trace_latency("receipt");
+
+    // to the screen, as a driver with the current calibration would
+    const int sx = xf86ScaleAxis(x, fb.get_width() - 1, 0, axys.x.max, axys.x.min);
+    const int sy = xf86ScaleAxis(y, fb.get_height() - 1, 0, axys.y.max, axys.y.min);
+    session.click(sx, sy);
+
+    redraw();
+    fb.present();
+    trace_redraw();
+}
+
+void GuiCalibratorFB::on_timer()
+{
+    // Update clock
+    if (session.tick()) {
+        calibrator->trace_latency("timer");
+        draw_clock();
+        present_clock();
+        trace_redraw();
+    }
+}
+
+void GuiCalibratorFB::redraw()
+{
+    const int display_width = session.get_display_width();
+    const int display_height = session.get_display_height();
+    fb.fill_rect(0, 0, display_width, display_height, colors[GRAY]);
+
+    // Print the text, as the x11 GUI does
+    const std::list<std::string>& display_texts = session.get_display_texts();
+    const int text_height = Framebuffer::text_height;
+    int text_width = 0;
+    for (std::list<std::string>::const_iterator it = display_texts.begin();
+         it != display_texts.end(); it++)
+        text_width = std::max(text_width, Framebuffer::text_width(it->c_str()));
+
+    int x = (display_width - text_width) / 2;
+    int y = (display_height - text_height) / 2 - 60;
+    const int lines = display_texts.size();
+    draw_text_block(x - 11, y - lines*text_height - 11, text_width, lines, 0);
+    // baseline of the first line
+    int baseline = y - 3 - (lines - 1)*text_height;
+    for (std::list<std::string>::const_iterator it = display_texts.begin();
+         it != display_texts.end(); it++) {
+        const int w = Framebuffer::text_width(it->c_str());
+        fb.draw_text(x + (text_width - w)/2, baseline - Framebuffer::text_ascent,
+                     it->c_str(), colors[BLACK]);
+        baseline += text_height;
+    }
+
+    // Draw the points
+    std::vector<GuiTarget> targets;
+    session.get_targets(targets);
+    for (size_t i = 0; i < targets.size(); i++)
+        draw_point((int) targets[i].x, (int) targets[i].y, targets[i].clicked);
+
+    // Draw the clock
+    if (calibrator->get_use_timeout())
+        draw_clock();
+
+    // Draw the message (if any)
+    const char* msg = session.get_message();
+    if (msg != NULL) {
+        const int w = Framebuffer::text_width(msg);
+        x = (display_width - w) / 2;
+        y = (display_height - text_height) / 2 + clock_radius + 60;
+        draw_text_block(x - 11, y - text_height - 11, w, 1, 5);
+        fb.draw_text(x, y - Framebuffer::text_ascent, msg, colors[BLACK]);
+    }
+}
+
+void GuiCalibratorFB::draw_point(int x, int y, bool clicked)
+{
+    // set color: already clicked or not
+    const uint32_t color = clicked ? colors[WHITE] : colors[RED];
+
+    fb.fill_rect(x - cross_lines, y, 2*cross_lines + 1, 1, color);
+    fb.fill_rect(x, y - cross_lines, 1, 2*cross_lines + 1, color);
+    fb.draw_circle(x, y, cross_circle, color);
+}
+
+/// the background and the frame of a text box of 'lines' lines,
+/// the frame is 11 pixels away from the text ('extra' more below it)
+void GuiCalibratorFB::draw_text_block(int x, int y, int text_width, int lines, int extra)
+{
+    const int w = text_width + 22;
+    const int h = lines*Framebuffer::text_height + 22 + extra;
+    fb.fill_rect(x, y, w, h, colors[GRAY]);
+    fb.draw_rect(x + 1, y + 1, w - 2, h - 2, colors[BLACK]);
+    fb.draw_rect(x + 2, y + 2, w - 4, h - 4, colors[BLACK]);
+}
+
+void GuiCalibratorFB::draw_clock()
+{
+    const int cx = session.get_display_width()/2;
+    const int cy = session.get_display_height()/2;
+    const int r = clock_radius/2;
+    fb.fill_ring(cx, cy, r, 0, 1, colors[DIMGRAY]);
+    fb.fill_ring(cx, cy, r, r - clock_line_width, (double) session.get_time_elapsed()/max_time,
+                 colors[BLACK]);
+}
+
+void GuiCalibratorFB::present_clock()
+{
+    const int r = clock_radius/2;
+    fb.present(session.get_display_width()/2 - r, session.get_display_height()/2 - r,
+               2*r + 1, 2*r + 1);
+}
+
+/// with a latency trace, timestamp once the frame is in the framebuffer
+void GuiCalibratorFB::trace_redraw()
+{
+    if (calibrator->get_latency_trace())
+        calibrator->trace_latency("redraw");
+}
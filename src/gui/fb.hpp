@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef GUI_FB_HPP
+#define GUI_FB_HPP
+
+#include "calibrator.hh"
+#include "gui/gui_common.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <linux/input.h>
+
+/*
+ * A memory-mapped framebuffer: an fbdev device (/dev/fb0) or, for tests,
+ * a plain file holding a width x height XRGB8888 image.
+ *
+ * Drawing goes to an XRGB8888 back buffer, present() converts the given
+ * rectangle to the pixel format of the framebuffer and copies it out.
+ */
+class Framebuffer
+{
+public:
+    /// map the fbdev device 'path', or when width > 0 the file 'path'
+    /// as a width x height image (created or resized),
+    /// throws std::runtime_error on failure
+    Framebuffer(const char* path, int width = 0, int height = 0);
+    ~Framebuffer();
+
+    int get_width() const
+    { return width; }
+    int get_height() const
+    { return height; }
+
+    /// an XRGB8888 color
+    static uint32_t rgb(int r, int g, int b)
+    { return (r << 16) | (g << 8) | b; }
+    /// the presented color at x, y, as XRGB8888
+    uint32_t get_pixel(int x, int y) const;
+
+    void fill_rect(int x, int y, int w, int h, uint32_t color);
+    /// one pixel wide outline of the rectangle
+    void draw_rect(int x, int y, int w, int h, uint32_t color);
+    /// one pixel wide circle
+    void draw_circle(int cx, int cy, int r, uint32_t color);
+    /// the part 'fraction' of a ring (a disc when r_inner is 0), clockwise
+    /// from 12 o'clock
+    void fill_ring(int cx, int cy, int r_outer, int r_inner, double fraction,
+                   uint32_t color);
+    /// 'text' with its top left corner at x, y
+    void draw_text(int x, int y, const char* text, uint32_t color);
+
+    static int text_width(const char* text);
+    static const int text_height = 16;
+    /// distance from the top of the text to the baseline
+    static const int text_ascent = 12;
+
+    /// copy the rectangle to the framebuffer
+    void present(int x, int y, int w, int h);
+    void present()
+    { present(0, 0, width, height); }
+
+private:
+    void put_pixel(int x, int y, uint32_t color)
+    {
+        if (x >= 0 && y >= 0 && x < width && y < height)
+            back[y*width + x] = color;
+    }
+
+    int fd;
+    int width, height;
+    int bits_per_pixel;
+    int line_length;
+    // bit offsets and lengths of red, green and blue in a pixel
+    int red_offset, red_length;
+    int green_offset, green_length;
+    int blue_offset, blue_length;
+
+    unsigned char* map;
+    size_t map_length;
+    // start of the visible screen in map
+    unsigned char* screen;
+
+    std::vector<uint32_t> back;
+};
+
+/*
+ * Taps on an evdev touchscreen: the position of each touch down
+ * (BTN_TOUCH or BTN_LEFT), in device units, when its frame is complete.
+ * Uses ABS_X/ABS_Y, or the first slot of ABS_MT_POSITION_X/Y on
+ * devices with multi-touch axes only.
+ */
+class TouchInput
+{
+public:
+    /// open the event node, throws std::runtime_error on failure
+    TouchInput(const char* node);
+    /// decode events fed with decode() only, on axes of the given range
+    TouchInput(const XYinfo& range);
+    ~TouchInput();
+
+    int get_fd() const
+    { return fd; }
+    const char* get_name() const
+    { return name.c_str(); }
+    /// the range of the X and Y axes
+    const XYinfo& get_range() const
+    { return range; }
+
+    /// take one event, true when it completes a tap at x, y
+    bool decode(const input_event& ev, int& x, int& y);
+    /// read the pending events and add their taps as x, y pairs,
+    /// false when the device is gone
+    bool read_taps(std::vector<int>& taps);
+
+private:
+    int fd;
+    std::string name;
+    XYinfo range;
+    bool mt_only;
+    int slot;
+    int cur_x, cur_y;
+    bool touching, pressed;
+};
+
+/*******************************************
+ * Framebuffer class for the calibration GUI,
+ * for systems without an X server
+ *******************************************/
+class GuiCalibratorFB
+{
+public:
+    /// map the taps from the device range 'axys' to the framebuffer
+    /// (the axys the calibrator was made with)
+    GuiCalibratorFB(Calibrator* calibrator, Framebuffer& fb, TouchInput& touch,
+                    const XYinfo& axys);
+
+    /// run the session until it exits, returns 1 on an input error
+    int run();
+
+private:
+    Calibrator* calibrator;
+    GuiSession session;
+    Framebuffer& fb;
+    TouchInput& touch;
+    XYinfo axys;
+
+    enum { BLACK=0, WHITE=1, GRAY=2, DIMGRAY=3, RED=4, NUM_COLORS };
+    static const uint32_t colors[NUM_COLORS];
+
+    void on_tap(int x, int y);
+    void on_timer();
+
+    void redraw();
+    void draw_point(int x, int y, bool clicked);
+    void draw_text_block(int x, int y, int text_width, int lines, int extra);
+    void draw_clock();
+    void present_clock();
+    void trace_redraw();
+};
+
+#endif
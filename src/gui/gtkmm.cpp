@@ -21,14 +21,19 @@
  * THE SOFTWARE.
  */
 
+// Must be before Xlib stuff
+#include <gtkmm/main.h>
+#include <gtkmm/window.h>
+
 #include "gui/gtkmm.hpp"
 #include "gui/gui_common.hpp"
 
+#include <cmath>
+
 CalibrationArea::CalibrationArea(Calibrator* calibrator0)
-  : calibrator(calibrator0), time_elapsed(0), message(NULL)
+  : calibrator(calibrator0), session(calibrator0),
+    drawn_message(NULL), trace_pending(false)
 {
-    // setup strings
-    get_display_texts(&display_texts, calibrator0);
     // Listen for mouse events
     add_events(Gdk::KEY_PRESS_MASK | Gdk::BUTTON_PRESS_MASK);
     set_flags(Gtk::CAN_FOCUS);
@@ -56,154 +61,290 @@ CalibrationArea::CalibrationArea(Calibrator* calibrator0)
 }
 
 void CalibrationArea::set_display_size(int width, int height) {
-    display_width = width;
-    display_height = height;
-
-    // Compute absolute circle centers
-    const int delta_x = display_width/num_blocks;
-    const int delta_y = display_height/num_blocks;
-    X[UL] = delta_x;                     Y[UL] = delta_y;
-    X[UR] = display_width - delta_x - 1; Y[UR] = delta_y;
-    X[LL] = delta_x;                     Y[LL] = display_height - delta_y - 1;
-    X[LR] = display_width - delta_x - 1; Y[LR] = display_height - delta_y - 1;
+    session.set_display_size(width, height);
 
-    // reset calibration if already started
-    calibrator->reset();
+    // the text blocks are laid out again on the next expose
+    help_block.surface = Cairo::RefPtr<Cairo::Surface>();
+    message_blocks.clear();
 }
 
 bool CalibrationArea::on_expose_event(GdkEventExpose *event)
 {
+    calibrator->trace_latency("expose");
+
     // check that screensize did not change (if no manually specified geometry)
     if (calibrator->get_geometry() == NULL &&
-         (display_width != get_width() ||
-         display_height != get_height()) ) {
+         (session.get_display_width() != get_width() ||
+         session.get_display_height() != get_height()) ) {
         set_display_size(get_width(), get_height());
     }
 
+    const int display_width = session.get_display_width();
+    const int display_height = session.get_display_height();
     Glib::RefPtr<Gdk::Window> window = get_window();
     if (window) {
         Cairo::RefPtr<Cairo::Context> cr = window->create_cairo_context();
         cr->save();
 
-        cr->rectangle(event->area.x, event->area.y, event->area.width, event->area.height);
+        // only the damaged regions, not their bounding box
+        gdk_cairo_region(cr->cobj(), event->region);
         cr->clip();
 
         // Print the text
-        cr->set_font_size(font_size);
-        double text_height = -1;
-        double text_width = -1;
-        Cairo::TextExtents extent;
-        for (std::list<std::string>::iterator it = display_texts.begin();
-            it != display_texts.end(); it++) {
-            cr->get_text_extents(*it, extent);
-            text_width = std::max(text_width, extent.width);
-            text_height = std::max(text_height, extent.height);
-        }
-        text_height += 2;
-
-        double x = (display_width - text_width) / 2;
-        double y = (display_height - text_height) / 2 - 60;
-        cr->set_line_width(2);
-        cr->rectangle(x - 10, y - (display_texts.size()*text_height) - 10,
-                text_width + 20, (display_texts.size()*text_height) + 20);
-
-        // Print help lines
-        y -= 3;
-        for (std::list<std::string>::reverse_iterator rev_it = display_texts.rbegin();
-	         rev_it != display_texts.rend(); rev_it++) {
-            cr->get_text_extents(*rev_it, extent);
-            cr->move_to(x + (text_width-extent.width)/2, y);
-            cr->show_text(*rev_it);
-            y -= text_height;
-        }
-        cr->stroke();
+        if (!help_block.surface)
+            render_help_block(cr);
+        if (is_damaged(event, help_block.area))
+            paint_block(cr, help_block);
 
         // Draw the points
-        for (int i = 0; i <= calibrator->get_numclicks(); i++) {
-            // set color: already clicked or not
-            if (i < calibrator->get_numclicks())
-                cr->set_source_rgb(1.0, 1.0, 1.0);
-            else
-                cr->set_source_rgb(0.8, 0.0, 0.0);
-
-            cr->set_line_width(1);
-            cr->move_to(X[i] - cross_lines, Y[i]);
-            cr->rel_line_to(cross_lines*2, 0);
-            cr->move_to(X[i], Y[i] - cross_lines);
-            cr->rel_line_to(0, cross_lines*2);
-            cr->stroke();
-
-            cr->arc(X[i], Y[i], cross_circle, 0.0, 2.0 * M_PI);
-            cr->stroke();
+        if (!target_surfaces[0])
+            render_targets(cr);
+        std::vector<GuiTarget> targets;
+        session.get_targets(targets);
+        for (size_t i = 0; i < targets.size(); i++) {
+            const Gdk::Rectangle rect = target_rect(targets[i]);
+            if (is_damaged(event, rect)) {
+                cr->set_source(target_surfaces[targets[i].clicked], rect.get_x(), rect.get_y());
+                cr->paint();
+            }
         }
-        if(calibrator->get_use_timeout()){
-            // Draw the clock background
-            cr->arc(display_width/2, display_height/2, clock_radius/2, 0.0, 2.0 * M_PI);
-            cr->set_source_rgb(0.5, 0.5, 0.5);
-            cr->fill_preserve();
+
+        if (is_damaged(event, clock_rect())) {
+            if(calibrator->get_use_timeout()){
+                // Draw the clock background
+                cr->arc(display_width/2, display_height/2, clock_radius/2, 0.0, 2.0 * M_PI);
+                cr->set_source_rgb(0.5, 0.5, 0.5);
+                cr->fill_preserve();
+                cr->stroke();
+            }
+
+            cr->set_line_width(clock_line_width);
+            cr->arc(display_width/2, display_height/2, (clock_radius - clock_line_width)/2,
+                 3/2.0*M_PI, (3/2.0*M_PI) + ((double)session.get_time_elapsed()/(double)max_time) * 2*M_PI);
+            cr->set_source_rgb(0.0, 0.0, 0.0);
             cr->stroke();
         }
 
-        cr->set_line_width(clock_line_width);
-        cr->arc(display_width/2, display_height/2, (clock_radius - clock_line_width)/2,
-             3/2.0*M_PI, (3/2.0*M_PI) + ((double)time_elapsed/(double)max_time) * 2*M_PI);
-        cr->set_source_rgb(0.0, 0.0, 0.0);
-        cr->stroke();
-
-
         // Draw the message (if any)
-        if (message != NULL) {
-            // Frame the message
-            cr->set_font_size(font_size);
-            Cairo::TextExtents extent;
-            cr->get_text_extents(this->message, extent);
-            text_width = extent.width;
-            text_height = extent.height;
-
-            x = (display_width - text_width) / 2;
-            y = (display_height - text_height + clock_radius) / 2 + 60;
-            cr->set_line_width(2);
-            cr->rectangle(x - 10, y - text_height - 10,
-                    text_width + 20, text_height + 25);
-
-            // Print the message
-            cr->move_to(x, y);
-            cr->show_text(this->message);
-            cr->stroke();
+        if (session.get_message() != NULL) {
+            const TextBlock& block = get_message_block(cr, session.get_message());
+            if (is_damaged(event, block.area))
+                paint_block(cr, block);
         }
 
         cr->restore();
     }
 
+    // the double buffer is copied to the window after this handler,
+    // so timestamp from an idle callback, after GDK's redraw priority
+    if (calibrator->get_latency_trace() && !trace_pending) {
+        trace_pending = true;
+        Glib::signal_idle().connect(sigc::mem_fun(*this, &CalibrationArea::on_redraw_done));
+    }
+
     return true;
 }
 
+bool CalibrationArea::on_redraw_done()
+{
+    get_display()->sync();
+    calibrator->trace_latency("redraw");
+    trace_pending = false;
+    return false;
+}
+
+/// a context to render a block at x, y of width x height (in window
+/// coordinates) into a new surface
+Cairo::RefPtr<Cairo::Context> CalibrationArea::create_block(Cairo::RefPtr<Cairo::Context> window_cr,
+    TextBlock& block, double x, double y, double width, double height)
+{
+    // on whole pixels, painting the surface is then a plain copy
+    const int left = (int) floor(x);
+    const int top = (int) floor(y);
+    block.area = Gdk::Rectangle(left, top, (int) ceil(x + width) - left,
+                                (int) ceil(y + height) - top);
+    block.surface = Cairo::Surface::create(window_cr->get_target(), Cairo::CONTENT_COLOR_ALPHA,
+                                           block.area.get_width(), block.area.get_height());
+
+    Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(block.surface);
+    cr->translate(-left, -top);
+    cr->set_font_size(font_size);
+    cr->set_line_width(2);
+    return cr;
+}
+
+void CalibrationArea::render_help_block(Cairo::RefPtr<Cairo::Context> window_cr)
+{
+    const std::list<std::string>& display_texts = session.get_display_texts();
+    window_cr->save();
+    window_cr->set_font_size(font_size);
+    double text_height = -1;
+    double text_width = -1;
+    Cairo::TextExtents extent;
+    for (std::list<std::string>::const_iterator it = display_texts.begin();
+        it != display_texts.end(); it++) {
+        window_cr->get_text_extents(*it, extent);
+        text_width = std::max(text_width, extent.width);
+        text_height = std::max(text_height, extent.height);
+    }
+    text_height += 2;
+    window_cr->restore();
+
+    double x = (session.get_display_width() - text_width) / 2;
+    double y = (session.get_display_height() - text_height) / 2 - 60;
+    Cairo::RefPtr<Cairo::Context> cr = create_block(window_cr, help_block,
+        x - 11, y - (display_texts.size()*text_height) - 11,
+        text_width + 22, (display_texts.size()*text_height) + 22);
+    cr->rectangle(x - 10, y - (display_texts.size()*text_height) - 10,
+            text_width + 20, (display_texts.size()*text_height) + 20);
+
+    // Print help lines
+    y -= 3;
+    for (std::list<std::string>::const_reverse_iterator rev_it = display_texts.rbegin();
+         rev_it != display_texts.rend(); rev_it++) {
+        cr->get_text_extents(*rev_it, extent);
+        cr->move_to(x + (text_width-extent.width)/2, y);
+        cr->show_text(*rev_it);
+        y -= text_height;
+    }
+    cr->stroke();
+}
+
+const CalibrationArea::TextBlock& CalibrationArea::get_message_block(
+    Cairo::RefPtr<Cairo::Context> window_cr, const char* msg)
+{
+    std::map<const char*, TextBlock>::iterator it = message_blocks.find(msg);
+    if (it != message_blocks.end())
+        return it->second;
+
+    window_cr->save();
+    window_cr->set_font_size(font_size);
+    Cairo::TextExtents extent;
+    window_cr->get_text_extents(msg, extent);
+    window_cr->restore();
+    double text_width = extent.width;
+    double text_height = extent.height;
+
+    // Frame the message
+    double x = (session.get_display_width() - text_width) / 2;
+    double y = (session.get_display_height() - text_height + clock_radius) / 2 + 60;
+    TextBlock& block = message_blocks[msg];
+    Cairo::RefPtr<Cairo::Context> cr = create_block(window_cr, block,
+        x - 11, y - text_height - 11, text_width + 22, text_height + 27);
+    cr->rectangle(x - 10, y - text_height - 10,
+            text_width + 20, text_height + 25);
+
+    // Print the message
+    cr->move_to(x, y);
+    cr->show_text(msg);
+    cr->stroke();
+    return block;
+}
+
+void CalibrationArea::paint_block(Cairo::RefPtr<Cairo::Context> cr, const TextBlock& block)
+{
+    cr->save();
+    cr->set_source(block.surface, block.area.get_x(), block.area.get_y());
+    cr->paint();
+    cr->restore();
+}
+
+/// the unclicked and the clicked target, centered in surfaces of target_rect()
+void CalibrationArea::render_targets(Cairo::RefPtr<Cairo::Context> window_cr)
+{
+    const int size = 2 * cross_lines + 3;
+    for (int clicked = 0; clicked != 2; clicked++) {
+        target_surfaces[clicked] = Cairo::Surface::create(window_cr->get_target(),
+                                       Cairo::CONTENT_COLOR_ALPHA, size, size);
+        Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(target_surfaces[clicked]);
+        draw_point(cr, cross_lines + 1, cross_lines + 1, clicked);
+    }
+}
+
+/// the pixels a target can touch: the lines, antialiased, and the circle
+Gdk::Rectangle CalibrationArea::target_rect(const GuiTarget& target) const
+{
+    return Gdk::Rectangle((int) target.x - cross_lines - 1, (int) target.y - cross_lines - 1,
+                          2 * cross_lines + 3, 2 * cross_lines + 3);
+}
+
+Gdk::Rectangle CalibrationArea::clock_rect() const
+{
+    return Gdk::Rectangle(session.get_display_width()/2 - clock_radius - clock_line_width,
+                          session.get_display_height()/2 - clock_radius - clock_line_width,
+                          2 * clock_radius + 1 + 2 * clock_line_width,
+                          2 * clock_radius + 1 + 2 * clock_line_width);
+}
+
+bool CalibrationArea::is_damaged(GdkEventExpose* event, const Gdk::Rectangle& rect)
+{
+    return gdk_region_rect_in(event->region, rect.gobj()) != GDK_OVERLAP_RECTANGLE_OUT;
+}
+
+void CalibrationArea::draw_point(Cairo::RefPtr<Cairo::Context> cr, double x, double y, bool clicked)
+{
+    // set color: already clicked or not
+    if (clicked)
+        cr->set_source_rgb(1.0, 1.0, 1.0);
+    else
+        cr->set_source_rgb(0.8, 0.0, 0.0);
+
+    cr->set_line_width(1);
+    cr->move_to(x - cross_lines, y);
+    cr->rel_line_to(cross_lines*2, 0);
+    cr->move_to(x, y - cross_lines);
+    cr->rel_line_to(0, cross_lines*2);
+    cr->stroke();
+
+    cr->arc(x, y, cross_circle, 0.0, 2.0 * M_PI);
+    cr->stroke();
+}
+
+/// invalidate the targets and the message that changed since the last
+/// redraw, and the clock
 void CalibrationArea::redraw()
 {
     Glib::RefPtr<Gdk::Window> win = get_window();
-    if (win) {
-        const Gdk::Rectangle rect(0, 0, display_width, display_height);
-        win->invalidate_rect(rect, false);
+    if (!win)
+        return;
+
+    std::vector<GuiTarget> targets;
+    session.get_targets(targets);
+    const size_t n = std::max(targets.size(), drawn_targets.size());
+    for (size_t i = 0; i < n; i++) {
+        if (i < targets.size() && i < drawn_targets.size() && targets[i] == drawn_targets[i])
+            continue;
+        if (i < drawn_targets.size())
+            win->invalidate_rect(target_rect(drawn_targets[i]), false);
+        if (i < targets.size())
+            win->invalidate_rect(target_rect(targets[i]), false);
     }
+    drawn_targets = targets;
+
+    const char* message = session.get_message();
+    if (message != drawn_message) {
+        Cairo::RefPtr<Cairo::Context> cr = win->create_cairo_context();
+        if (drawn_message != NULL)
+            win->invalidate_rect(get_message_block(cr, drawn_message).area, false);
+        if (message != NULL)
+            win->invalidate_rect(get_message_block(cr, message).area, false);
+        drawn_message = message;
+    }
+
+    // the clock restarts on every click
+    if (calibrator->get_use_timeout())
+        win->invalidate_rect(clock_rect(), false);
 }
 
 bool CalibrationArea::on_timer_signal()
 {
-    if (calibrator->get_use_timeout()) {
-        time_elapsed += time_step;
-        if (time_elapsed > max_time) {
-            exit(0);
-        }
-    
+    if (session.tick()) {
+        calibrator->trace_latency("timer");
+
         // Update clock
         Glib::RefPtr<Gdk::Window> win = get_window();
-        if (win) {
-            const Gdk::Rectangle rect(display_width/2 - clock_radius - clock_line_width,
-                                     display_height/2 - clock_radius - clock_line_width,
-                                     2 * clock_radius + 1 + 2 * clock_line_width,
-                                     2 * clock_radius + 1 + 2 * clock_line_width);
-            win->invalidate_rect(rect, false);
-        }
+        if (win)
+            win->invalidate_rect(clock_rect(), false);
     }
     
     return true;
@@ -211,29 +352,10 @@ bool CalibrationArea::on_timer_signal()
 
 bool CalibrationArea::on_button_press_event(GdkEventButton *event)
 {
-    // Handle click
-    time_elapsed = 0;
-    bool success = calibrator->add_click((int)event->x_root, (int)event->y_root);
-
-    if (!success && calibrator->get_numclicks() == 0) {
-        draw_message("Mis-click detected, restarting...");
-    } else {
-        draw_message(NULL);
-    }
+    calibrator->trace_latency("receipt");
 
-    // Are we done yet?
-    if (calibrator->get_numclicks() >= 4) {
-        // Recalibrate
-        success = calibrator->finish(display_width, display_height);
-
-        if (success) {
-            exit(0);
-        } else {
-            // TODO, in GUI ?
-            fprintf(stderr, "Error: unable to apply or save configuration values");
-            exit(1);
-        }
-    }
+    // Handle click
+    session.click((int)event->x_root, (int)event->y_root);
 
     // Force a redraw
     redraw();
@@ -241,13 +363,36 @@ bool CalibrationArea::on_button_press_event(GdkEventButton *event)
     return true;
 }
 
-void CalibrationArea::draw_message(const char* msg)
+bool CalibrationArea::on_key_press_event(GdkEventKey *event)
 {
-    this->message = msg;
+    (void) event;
+    session.key_press();
+    return true;
 }
 
-bool CalibrationArea::on_key_press_event(GdkEventKey *event)
+extern "C" int xinput_calibrator_gui_run(Calibrator* calibrator, int argc, char** argv)
 {
-    (void) event;
-    exit(0);
+    // GTK-mm setup
+    Gtk::Main kit(argc, argv);
+
+    Glib::RefPtr< Gdk::Screen > screen = Gdk::Screen::get_default();
+    //int num_monitors = screen->get_n_monitors(); TODO, multiple monitors?
+    Gdk::Rectangle rect;
+    screen->get_monitor_geometry(0, rect);
+
+    Gtk::Window win;
+    // when no window manager: explicitely take size of full screen
+    win.move(rect.get_x(), rect.get_y());
+    win.resize(rect.get_width(), rect.get_height());
+    // in case of window manager: set as full screen to hide window decorations
+    win.fullscreen();
+
+    CalibrationArea area(calibrator);
+    win.add(area);
+    area.show();
+
+    Gtk::Main::run(win);
+
+    Gtk::Main::quit();
+    return 0;
 }
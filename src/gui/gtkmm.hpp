@@ -25,8 +25,12 @@
 #define GUI_GTKMM_HPP
 
 #include <gtkmm/drawingarea.h>
+#include <cairomm/context.h>
 #include "calibrator.hh"
+#include "gui/gui_common.hpp"
 #include <list>
+#include <map>
+#include <vector>
 
 /*******************************************
  * GTK-mm class for the the calibration GUI
@@ -39,23 +43,48 @@ public:
 private:
     // Data
     Calibrator* calibrator;
-    double X[4], Y[4];
-    int display_width, display_height;
-    int time_elapsed;
-    std::list<std::string> display_texts;
+    GuiSession session;
 
-    const char* message;
+    // a framed block of text, rendered once per geometry into a surface
+    // similar to the window, painted on 'area' by the exposes that damage it
+    struct TextBlock {
+        Cairo::RefPtr<Cairo::Surface> surface;
+        Gdk::Rectangle area;
+    };
+    TextBlock help_block;
+    // by message, they are all string literals
+    std::map<const char*, TextBlock> message_blocks;
+
+    // the targets, unclicked and clicked, rendered once
+    Cairo::RefPtr<Cairo::Surface> target_surfaces[2];
+
+    // what redraw() last invalidated for, to invalidate only what changed
+    std::vector<GuiTarget> drawn_targets;
+    const char* drawn_message;
+
+    // a "redraw" timestamp is pending in the latency trace
+    bool trace_pending;
 
     // Signal handlers
     bool on_timer_signal();
     bool on_expose_event(GdkEventExpose *event);
     bool on_button_press_event(GdkEventButton *event);
     bool on_key_press_event(GdkEventKey *event);
+    bool on_redraw_done();
 
     // Helper functions
     void set_display_size(int width, int height);
     void redraw();
-    void draw_message(const char* msg);
+    void draw_point(Cairo::RefPtr<Cairo::Context> cr, double x, double y, bool clicked);
+    void render_targets(Cairo::RefPtr<Cairo::Context> window_cr);
+    Gdk::Rectangle target_rect(const GuiTarget& target) const;
+    Gdk::Rectangle clock_rect() const;
+    static bool is_damaged(GdkEventExpose* event, const Gdk::Rectangle& rect);
+    Cairo::RefPtr<Cairo::Context> create_block(Cairo::RefPtr<Cairo::Context> window_cr,
+        TextBlock& block, double x, double y, double width, double height);
+    void render_help_block(Cairo::RefPtr<Cairo::Context> window_cr);
+    const TextBlock& get_message_block(Cairo::RefPtr<Cairo::Context> window_cr, const char* msg);
+    void paint_block(Cairo::RefPtr<Cairo::Context> cr, const TextBlock& block);
 };
 
 #endif
@@ -49,3 +49,102 @@ void get_display_texts(std::list<std::string> *texts, Calibrator *calibrator)
         str += ")";
 	texts->push_back(str);
 }
+
+GuiSession::GuiSession(Calibrator* calibrator0)
+  : calibrator(calibrator0), display_width(0), display_height(0),
+    time_elapsed(0), verifying(false), message(NULL)
+{
+    ::get_display_texts(&display_texts, calibrator0);
+}
+
+void GuiSession::set_display_size(int width, int height) {
+    display_width = width;
+    display_height = height;
+
+    // Compute absolute circle centers
+    for (int i = 0; i != NUM_POINTS; i++) {
+        int x, y;
+        get_calibration_target(i, display_width, display_height, x, y);
+        X[i] = x; Y[i] = y;
+    }
+
+    // reset calibration if already started
+    calibrator->reset();
+}
+
+void GuiSession::get_targets(std::vector<GuiTarget>& targets) const
+{
+    targets.clear();
+    if (verifying) {
+        const int n = calibrator->get_numverifyclicks();
+        for (int i = 0; i <= n && i < calibrator->get_num_verify_points(); i++) {
+            int vx, vy;
+            calibrator->get_verify_target(i, display_width, display_height, vx, vy);
+            targets.push_back(GuiTarget(vx, vy, i < n));
+        }
+    } else {
+        const int n = calibrator->get_numclicks();
+        for (int i = 0; i <= n && i < NUM_POINTS; i++)
+            targets.push_back(GuiTarget(X[i], Y[i], i < n));
+    }
+}
+
+void GuiSession::click(int x, int y)
+{
+    time_elapsed = 0;
+
+    // Verification pass: the new calibration is in place
+    if (verifying) {
+        calibrator->add_verify_click(x, y);
+
+        if (calibrator->get_numverifyclicks() >= calibrator->get_num_verify_points()) {
+            if (calibrator->verify(display_width, display_height))
+                exit(0);
+            else
+                exit(EXIT_VERIFY_FAILED);
+        }
+        return;
+    }
+
+    bool success = calibrator->add_click(x, y);
+
+    if (!success && calibrator->get_numclicks() == 0) {
+        message = "Mis-click detected, restarting...";
+    } else {
+        message = NULL;
+    }
+
+    // Are we done yet?
+    if (calibrator->get_numclicks() >= 4) {
+        // Recalibrate
+        success = calibrator->finish(display_width, display_height);
+
+        if (success && calibrator->get_verify()) {
+            verifying = true;
+            message = "Tap the new points to verify the calibration";
+        } else if (success) {
+            exit(0);
+        } else {
+            // TODO, in GUI ?
+            fprintf(stderr, "Error: unable to apply or save configuration values");
+            exit(1);
+        }
+    }
+}
+
+bool GuiSession::tick()
+{
+    if (!calibrator->get_use_timeout())
+        return false;
+
+    time_elapsed += time_step;
+    if (time_elapsed > max_time) {
+        exit(verifying ? EXIT_VERIFY_FAILED : 0);
+    }
+    return true;
+}
+
+void GuiSession::key_press()
+{
+    exit(verifying ? EXIT_VERIFY_FAILED : 0);
+}
@@ -26,6 +26,7 @@
 #include "calibrator.hh"
 #include <list>
 #include <string>
+#include <vector>
 
 // Timeout parameters
 const int time_step = 100;  // in milliseconds
@@ -42,4 +43,76 @@ const int font_size = 16;
 
 void get_display_texts(std::list<std::string> *texts, Calibrator *calibrator);
 
+/// a target as the GUIs draw it
+struct GuiTarget
+{
+    double x, y;
+    bool clicked;
+
+    GuiTarget(double x0, double y0, bool clicked0)
+      : x(x0), y(y0), clicked(clicked0) {}
+    bool operator==(const GuiTarget& t) const
+    { return x == t.x && y == t.y && clicked == t.clicked; }
+};
+
+/*
+ * The calibration session as every GUI runs it: the target layout, the
+ * timeout and the tap-to-finish flow. The backends draw its state and
+ * feed it the clicks, timer ticks and key presses; it exits the program
+ * when the session is over.
+ */
+class GuiSession
+{
+public:
+    GuiSession(Calibrator* calibrator);
+
+    Calibrator* get_calibrator() const
+    { return calibrator; }
+
+    /// lay the targets out on a width x height screen, restarts the calibration
+    void set_display_size(int width, int height);
+    int get_display_width() const
+    { return display_width; }
+    int get_display_height() const
+    { return display_height; }
+
+    /// the targets to draw: the clicked ones and the next one
+    void get_targets(std::vector<GuiTarget>& targets) const;
+    /// the message to show under the clock, or NULL
+    const char* get_message() const
+    { return message; }
+    const std::list<std::string>& get_display_texts() const
+    { return display_texts; }
+    int get_time_elapsed() const
+    { return time_elapsed; }
+    bool is_verifying() const
+    { return verifying; }
+
+    /// a click at x, y
+    void click(int x, int y);
+    /// a timer tick of time_step, returns false if there is no clock to update
+    bool tick();
+    /// a key press, aborts the session
+    void key_press();
+
+private:
+    Calibrator* calibrator;
+    double X[NUM_POINTS], Y[NUM_POINTS];
+    int display_width, display_height;
+    int time_elapsed;
+    bool verifying;
+    const char* message;
+    std::list<std::string> display_texts;
+};
+
+/// name of the entry point of the GUI modules, see GuiRunFunc
+#define GUI_RUN_SYMBOL "xinput_calibrator_gui_run"
+
+/// entry point of a GUI backend: run the session of 'calibrator' until it
+/// exits. Each backend defines it as xinput_calibrator_gui_run; with
+/// --enable-gui-modules it is found in the module with dlsym()
+typedef int (*GuiRunFunc)(Calibrator* calibrator, int argc, char** argv);
+
+extern "C" int xinput_calibrator_gui_run(Calibrator* calibrator, int argc, char** argv);
+
 #endif
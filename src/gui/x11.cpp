@@ -33,38 +33,23 @@
 #include <X11/extensions/Xrandr.h>
 #endif
 
-#ifdef HAVE_TIMERFD
-#include <sys/timerfd.h>
-#endif
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
 #include <string.h>
 #include <stdint.h>
+#include <unistd.h>
 
 
 const char* GuiCalibratorX11::colors[GuiCalibratorX11::NUM_COLORS] = {"BLACK", "WHITE", "GRAY", "DIMGRAY", "RED"};
 
-#ifndef HAVE_TIMERFD
-void sigalarm_handler(int num);
-#endif
-
-/// Create singleton instance associated to calibrator w
-void GuiCalibratorX11::make_instance(Calibrator* w)
-{
-    instance = new GuiCalibratorX11(w);
-}
-
-// Singleton instance
-GuiCalibratorX11* GuiCalibratorX11::instance = NULL;
 
 GuiCalibratorX11::GuiCalibratorX11(Calibrator* calibrator0)
-  : calibrator(calibrator0), time_elapsed(0)
+  : calibrator(calibrator0), session(calibrator0)
 {
-    // setup strings
-    get_display_texts(&display_texts, calibrator0);
-
     display = XOpenDisplay(NULL);
     if (display == NULL) {
         throw std::runtime_error("Unable to connect to X server");
@@ -83,10 +68,9 @@ GuiCalibratorX11::GuiCalibratorX11(Calibrator* calibrator0)
 
     int width, height;
     detect_display_size(width, height);
-    set_display_size(width, height);
+    session.set_display_size(width, height);
 
-    fprintf(stderr, "INFO: width=%d, height=%d\n", 
-        display_width, display_height);
+    fprintf(stderr, "INFO: width=%d, height=%d\n", width, height);
 
     // parse geometry string
     const char* geo = calibrator->get_geometry();
@@ -96,7 +80,7 @@ GuiCalibratorX11::GuiCalibratorX11(Calibrator* calibrator0)
         if (res != 2) {
             fprintf(stderr,"Warning: error parsing geometry string - using defaults.\n");
         } else {
-            set_display_size( gw, gh );
+            session.set_display_size( gw, gh );
         }
     }
 
@@ -106,7 +90,7 @@ GuiCalibratorX11::GuiCalibratorX11(Calibrator* calibrator0)
     attributes.event_mask = ExposureMask | KeyPressMask | ButtonPressMask;
 
     win = XCreateWindow(display, RootWindow(display, screen_num),
-                0, 0, display_width, display_height, 0,
+                0, 0, session.get_display_width(), session.get_display_height(), 0,
                 CopyFromParent, InputOutput, CopyFromParent,
                 CWOverrideRedirect | CWEventMask,
                 &attributes);
@@ -130,27 +114,11 @@ GuiCalibratorX11::GuiCalibratorX11(Calibrator* calibrator0)
 
     gc = XCreateGC(display, win, 0, NULL);
     XSetFont(display, gc, font_info->fid);
+    // no NoExpose events for the copies of the text pixmaps
+    XSetGraphicsExposures(display, gc, False);
+
+    render_help_block();
 
-    // Setup timer for animation
-#ifdef HAVE_TIMERFD
-    struct itimerspec timer;
-    unsigned int period = time_step * 1000; // microseconds
-    unsigned int sec = period/1000000;
-    unsigned int ns = (period - (sec * 1000000)) * 1000;
-
-    timer.it_value.tv_sec = sec;
-    timer.it_value.tv_nsec = ns;
-    timer.it_interval = timer.it_value;
-    timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
-    timerfd_settime(timer_fd, 0, &timer, NULL);
-#else
-    signal(SIGALRM, sigalarm_handler);
-    struct itimerval timer;
-    timer.it_value.tv_sec = time_step/1000;
-    timer.it_value.tv_usec = (time_step % 1000) * 1000;
-    timer.it_interval = timer.it_value;
-    setitimer(ITIMER_REAL, &timer, NULL);
-#endif
 }
 
 void  GuiCalibratorX11::detect_display_size( int &width, int &height) {
@@ -193,79 +161,40 @@ GuiCalibratorX11::~GuiCalibratorX11()
 {
     XUngrabPointer(display, CurrentTime);
     XUngrabKeyboard(display, CurrentTime);
+    XFreePixmap(display, help_block.pixmap);
+    for (std::map<const char*, TextBlock>::iterator it = message_blocks.begin();
+         it != message_blocks.end(); it++)
+        XFreePixmap(display, it->second.pixmap);
     XFreeGC(display, gc);
     XCloseDisplay(display);
 }
 
-void GuiCalibratorX11::set_display_size(int width, int height) {
-    display_width = width;
-    display_height = height;
-
-    // Compute absolute circle centers
-    const int delta_x = display_width/num_blocks;
-    const int delta_y = display_height/num_blocks;
-    X[UL] = delta_x;                     Y[UL] = delta_y;
-    X[UR] = display_width - delta_x - 1; Y[UR] = delta_y;
-    X[LL] = delta_x;                     Y[LL] = display_height - delta_y - 1;
-    X[LR] = display_width - delta_x - 1; Y[LR] = display_height - delta_y - 1;
-
-    // reset calibration if already started
-    calibrator->reset();
-}
-
 void GuiCalibratorX11::redraw()
 {
     if (calibrator->get_geometry() == NULL) {
         int width;
         int height;
         detect_display_size(width, height);
-        if (display_width != width || display_height != height) {
-            set_display_size(width, height);
+        if (session.get_display_width() != width || session.get_display_height() != height) {
+            session.set_display_size(width, height);
         }
     }
 
+    const int display_width = session.get_display_width();
+    const int display_height = session.get_display_height();
+
     // Print the text
     int text_height = font_info->ascent + font_info->descent;
-    int text_width = -1;
-    for (std::list<std::string>::iterator it = display_texts.begin();
-        it != display_texts.end(); it++) {
-        text_width = std::max(text_width, XTextWidth(font_info,
-            (*it).c_str(), (*it).length()));
-    }
-
-    int x = (display_width - text_width) / 2;
+    int x = (display_width - help_block.text_width) / 2;
     int y = (display_height - text_height) / 2 - 60;
-    XSetForeground(display, gc, pixel[BLACK]);
-    XSetLineAttributes(display, gc, 2, LineSolid, CapRound, JoinRound);
-    XDrawRectangle(display, win, gc, x - 10, y - (display_texts.size()*text_height) - 10,
-                text_width + 20, (display_texts.size()*text_height) + 20);
-
-    // Print help lines
-    y -= 3;
-    for (std::list<std::string>::reverse_iterator rev_it = display_texts.rbegin();
-	     rev_it != display_texts.rend(); rev_it++) {
-        int w = XTextWidth(font_info, (*rev_it).c_str(), (*rev_it).length());
-        XDrawString(display, win, gc, x + (text_width-w)/2, y,
-                (*rev_it).c_str(), (*rev_it).length());
-        y -= text_height;
-    }
+    XCopyArea(display, help_block.pixmap, win, gc, 0, 0, help_block.width, help_block.height,
+              x - 11, y - (session.get_display_texts().size()*text_height) - 11);
 
     // Draw the points
-    for (int i = 0; i <= calibrator->get_numclicks(); i++) {
-        // set color: already clicked or not
-        if (i < calibrator->get_numclicks())
-            XSetForeground(display, gc, pixel[WHITE]);
-        else
-            XSetForeground(display, gc, pixel[RED]);
-        XSetLineAttributes(display, gc, 1, LineSolid, CapRound, JoinRound);
-
-        XDrawLine(display, win, gc, X[i] - cross_lines, Y[i],
-                X[i] + cross_lines, Y[i]);
-        XDrawLine(display, win, gc, X[i], Y[i] - cross_lines,
-                X[i], Y[i] + cross_lines);
-        XDrawArc(display, win, gc, X[i] - cross_circle, Y[i] - cross_circle,
-                (2 * cross_circle), (2 * cross_circle), 0, 360 * 64);
-    }
+    std::vector<GuiTarget> targets;
+    session.get_targets(targets);
+    for (size_t i = 0; i < targets.size(); i++)
+        draw_point(targets[i].x, targets[i].y, targets[i].clicked);
 
     // Draw the clock background
     if(calibrator->get_use_timeout()){
@@ -274,129 +203,210 @@ void GuiCalibratorX11::redraw()
         XFillArc(display, win, gc, (display_width-clock_radius)/2, (display_height - clock_radius)/2,
                     clock_radius, clock_radius, 0, 360 * 64);
     }
+
+    // Draw the message (if any)
+    if (session.get_message() != NULL)
+        draw_message(session.get_message());
+}
+
+void GuiCalibratorX11::draw_point(double x, double y, bool clicked)
+{
+    // set color: already clicked or not
+    if (clicked)
+        XSetForeground(display, gc, pixel[WHITE]);
+    else
+        XSetForeground(display, gc, pixel[RED]);
+    XSetLineAttributes(display, gc, 1, LineSolid, CapRound, JoinRound);
+
+    XDrawLine(display, win, gc, x - cross_lines, y,
+            x + cross_lines, y);
+    XDrawLine(display, win, gc, x, y - cross_lines,
+            x, y + cross_lines);
+    XDrawArc(display, win, gc, x - cross_circle, y - cross_circle,
+            (2 * cross_circle), (2 * cross_circle), 0, 360 * 64);
 }
 
 void GuiCalibratorX11::on_expose_event()
 {
+    calibrator->trace_latency("expose");
     redraw();
+    trace_redraw();
 }
 
 void GuiCalibratorX11::on_timer_signal()
 {
     // Update clock
-    if(calibrator->get_use_timeout()) {
-
-        time_elapsed += time_step;
-        if (time_elapsed > max_time) {
-            exit(0);
-        }
+    if (session.tick()) {
+        calibrator->trace_latency("timer");
 
         XSetForeground(display, gc, pixel[BLACK]);
         XSetLineAttributes(display, gc, clock_line_width,
                     LineSolid, CapButt, JoinMiter);
-        XDrawArc(display, win, gc, (display_width-clock_radius+clock_line_width)/2,
-                    (display_height-clock_radius+clock_line_width)/2,
+        XDrawArc(display, win, gc, (session.get_display_width()-clock_radius+clock_line_width)/2,
+                    (session.get_display_height()-clock_radius+clock_line_width)/2,
                     clock_radius-clock_line_width, clock_radius-clock_line_width,
-                    90*64, ((double)time_elapsed/(double)max_time) * -360 * 64);
+                    90*64, ((double)session.get_time_elapsed()/(double)max_time) * -360 * 64);
+        trace_redraw();
     }
 }
 
 void GuiCalibratorX11::on_button_press_event(XEvent event)
 {
+    calibrator->trace_latency("receipt");
+
     // Clear window, maybe a bit overdone, but easiest for me atm.
     // (goal is to clear possible message and other clicks)
     XClearWindow(display, win);
 
     // Handle click
-    time_elapsed = 0;
-    bool success = calibrator->add_click(event.xbutton.x, event.xbutton.y);
-
-    if (!success && calibrator->get_numclicks() == 0) {
-        draw_message("Mis-click detected, restarting...");
-    }
-
-    // Are we done yet?
-    if (calibrator->get_numclicks() >= 4) {
-        // Recalibrate
-        success = calibrator->finish(display_width, display_height);
-
-        if (success) {
-            exit(0);
-        } else {
-            // TODO, in GUI ?
-            fprintf(stderr, "Error: unable to apply or save configuration values");
-            exit(1);
-        }
-    }
+    session.click(event.xbutton.x, event.xbutton.y);
 
     // Force a redraw
     redraw();
+    trace_redraw();
 }
 
 void GuiCalibratorX11::draw_message(const char* msg)
 {
+    const TextBlock& block = get_message_block(msg);
     int text_height = font_info->ascent + font_info->descent;
-    int text_width = XTextWidth(font_info, msg, strlen(msg));
 
-    int x = (display_width - text_width) / 2;
-    int y = (display_height - text_height) / 2 + clock_radius + 60;
+    int x = (session.get_display_width() - block.text_width) / 2;
+    int y = (session.get_display_height() - text_height) / 2 + clock_radius + 60;
+    XCopyArea(display, block.pixmap, win, gc, 0, 0, block.width, block.height,
+              x - 11, y - text_height - 11);
+}
+
+/// a pixmap with the background and the frame of a text box,
+/// the frame is 11 pixels away from the text
+Pixmap GuiCalibratorX11::create_text_box(int width, int height)
+{
+    Pixmap pixmap = XCreatePixmap(display, win, width, height,
+                                  DefaultDepth(display, screen_num));
+    XSetForeground(display, gc, pixel[GRAY]);
+    XFillRectangle(display, pixmap, gc, 0, 0, width, height);
+
     XSetForeground(display, gc, pixel[BLACK]);
     XSetLineAttributes(display, gc, 2, LineSolid, CapRound, JoinRound);
-    XDrawRectangle(display, win, gc, x - 10, y - text_height - 10,
-                text_width + 20, text_height + 25);
+    XDrawRectangle(display, pixmap, gc, 1, 1, width - 2, height - 2);
+    return pixmap;
+}
+
+void GuiCalibratorX11::render_help_block()
+{
+    const std::list<std::string>& display_texts = session.get_display_texts();
+    int text_height = font_info->ascent + font_info->descent;
+    int text_width = -1;
+    for (std::list<std::string>::const_iterator it = display_texts.begin();
+        it != display_texts.end(); it++) {
+        text_width = std::max(text_width, XTextWidth(font_info,
+            (*it).c_str(), (*it).length()));
+    }
+
+    help_block.text_width = text_width;
+    help_block.width = text_width + 22;
+    help_block.height = display_texts.size()*text_height + 22;
+    help_block.pixmap = create_text_box(help_block.width, help_block.height);
+
+    // Print help lines, bottom up
+    int y = display_texts.size()*text_height + 8;
+    for (std::list<std::string>::const_reverse_iterator rev_it = display_texts.rbegin();
+	     rev_it != display_texts.rend(); rev_it++) {
+        int w = XTextWidth(font_info, (*rev_it).c_str(), (*rev_it).length());
+        XDrawString(display, help_block.pixmap, gc, 11 + (text_width-w)/2, y,
+                (*rev_it).c_str(), (*rev_it).length());
+        y -= text_height;
+    }
+}
+
+const GuiCalibratorX11::TextBlock& GuiCalibratorX11::get_message_block(const char* msg)
+{
+    std::map<const char*, TextBlock>::iterator it = message_blocks.find(msg);
+    if (it != message_blocks.end())
+        return it->second;
 
-    XDrawString(display, win, gc, x, y, msg, strlen(msg));
+    int text_height = font_info->ascent + font_info->descent;
+    TextBlock& block = message_blocks[msg];
+    block.text_width = XTextWidth(font_info, msg, strlen(msg));
+    block.width = block.text_width + 22;
+    block.height = text_height + 27;
+    block.pixmap = create_text_box(block.width, block.height);
+    XDrawString(display, block.pixmap, gc, 11, text_height + 11, msg, strlen(msg));
+    return block;
 }
 
-void GuiCalibratorX11::give_timer_signal()
+/// with a latency trace, timestamp once the server has drawn
+void GuiCalibratorX11::trace_redraw()
 {
-    if (instance != NULL) {
-        // timer signal
-
-#ifdef HAVE_TIMERFD
-        uint64_t missed;
-        ssize_t ret;
-
-        /* Wait for the next timer event. If we have missed any the
-         * number is written to "missed" */
-        ret = read(instance->timer_fd, &missed, sizeof (missed));
-        if (ret == -1) {
-        	fprintf(stderr, "failed reading timer");
-        }
-#endif
+    if (calibrator->get_latency_trace()) {
+        XSync(display, False);
+        calibrator->trace_latency("redraw");
+    }
+}
 
-        //check timeout
-        instance->on_timer_signal();
+static long now_ms()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000L + t.tv_nsec/1000000;
+}
 
+int GuiCalibratorX11::run()
+{
+    const int fd = ConnectionNumber(display);
+    long next_tick = now_ms() + time_step;
+    while (1) {
         // process events
-        XEvent event;
-        while (XCheckWindowEvent(instance->display, instance->win, -1, &event) == True) {
+        while (XPending(display) > 0) {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.xany.window != win)
+                continue;
             switch (event.type) {
                 case Expose:
                     // only draw the last contiguous expose
                     if (event.xexpose.count != 0)
                         break;
-                    instance->on_expose_event();
+                    on_expose_event();
                     break;
 
                 case ButtonPress:
-                    instance->on_button_press_event(event);
+                    on_button_press_event(event);
                     break;
 
                 case KeyPress:
-                    exit(0);
+                    session.key_press();
                     break;
             }
         }
+
+        // sleep until the next event or animation step
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        const int ret = poll(&pfd, 1, std::max(0L, next_tick - now_ms()));
+        if (ret < 0 && errno != EINTR) {
+            fprintf(stderr, "Error: waiting for the X server: %s\n", strerror(errno));
+            return 1;
+        }
+        if (ret > 0 && (pfd.revents & (POLLERR | POLLHUP))) {
+            fprintf(stderr, "Error: lost the X server connection\n");
+            return 1;
+        }
+
+        //check timeout
+        if (now_ms() >= next_tick) {
+            next_tick += time_step;
+            on_timer_signal();
+        }
     }
+    return 0;
 }
 
-#ifndef HAVE_TIMERFD
-// handle SIGALRM signal, pass to singleton
-void sigalarm_handler(int num)
+extern "C" int xinput_calibrator_gui_run(Calibrator* calibrator, int argc, char** argv)
 {
-    if (num == SIGALRM) {
-        GuiCalibratorX11::give_timer_signal();
-    }
+    (void) argc;
+    (void) argv;
+    GuiCalibratorX11 gui(calibrator);
+    return gui.run();
 }
-#endif
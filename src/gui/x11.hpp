@@ -24,7 +24,10 @@
 #define GUI_CALIBRATOR_X11
 
 #include "calibrator.hh"
+#include "gui/gui_common.hpp"
+#include <X11/Xlib.h>
 #include <list>
+#include <map>
 
 /*******************************************
  * X11 class for the the calibration GUI
@@ -32,19 +35,17 @@
 class GuiCalibratorX11
 {
 public:
-    static void make_instance(Calibrator* w);
-    static void give_timer_signal();
-
-private:
     GuiCalibratorX11(Calibrator* w);
     ~GuiCalibratorX11();
 
+    /// Run the event loop on the calling thread until the session ends
+    int run();
+
+private:
+
     // Data
     Calibrator* calibrator;
-    double X[NUM_POINTS], Y[NUM_POINTS];
-    int display_width, display_height;
-    int time_elapsed;
-    std::list<std::string> display_texts;
+    GuiSession session;
 
     // X11 vars
     Display* display;
@@ -53,9 +54,15 @@ private:
     GC gc;
     XFontStruct* font_info;
 
-#ifdef HAVE_TIMERFD
-    int timer_fd;
-#endif
+    // a framed block of text, rendered once into a pixmap, copied on redraw
+    struct TextBlock {
+        Pixmap pixmap;
+        int text_width;
+        int width, height;
+    };
+    TextBlock help_block;
+    // by message, they are all string literals
+    std::map<const char*, TextBlock> message_blocks;
 
     // color management
     enum { BLACK=0, WHITE=1, GRAY=2, DIMGRAY=3, RED=4, NUM_COLORS };
@@ -69,11 +76,13 @@ private:
 
     // Helper functions
     void detect_display_size(int &width, int &height);
-    void set_display_size(int width, int height);
     void redraw();
+    void draw_point(double x, double y, bool clicked);
     void draw_message(const char* msg);
-
-    static GuiCalibratorX11* instance;
+    Pixmap create_text_box(int width, int height);
+    void render_help_block();
+    const TextBlock& get_message_block(const char* msg);
+    void trace_redraw();
 };
 
 #endif
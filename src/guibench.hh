@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _guibench_hh
+#define _guibench_hh
+
+#include "calibrator.hh"
+#include "tracereader.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+
+/*
+ * Helpers of the GUI benchmarks (xinput_calibrator_latency and
+ * xinput_calibrator_renderbench): they run a calibrator build on a
+ * private X server with --latency-trace on a pipe, and drive it with XTest.
+ */
+
+/// start 'calibrator --fake' with its latency trace on a pipe,
+/// returns its pid or -1
+inline pid_t start_gui(const char* calibrator, bool use_timeout, int& trace_fd)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        dup2(fds[1], 3);
+        close(fds[0]);
+        close(fds[1]);
+        if (use_timeout)
+            execlp(calibrator, calibrator, "--fake",
+                   "--latency-trace", "/dev/fd/3", (char*) NULL);
+        else
+            execlp(calibrator, calibrator, "--fake", "--no-timeout",
+                   "--latency-trace", "/dev/fd/3", (char*) NULL);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    trace_fd = fds[0];
+    return pid;
+}
+
+/// the size of the screen and the targets, as the GUIs place them on it
+inline void screen_targets(Display* display, int& width, int& height,
+                           int X[NUM_POINTS], int Y[NUM_POINTS])
+{
+    width = DisplayWidth(display, DefaultScreen(display));
+    height = DisplayHeight(display, DefaultScreen(display));
+    for (int i = 0; i != NUM_POINTS; i++)
+        get_calibration_target(i, width, height, X[i], Y[i]);
+}
+
+/// inject a tap at (x, y), returns when the press was sent
+inline long tap(Display* display, int x, int y)
+{
+    XTestFakeMotionEvent(display, -1, x, y, CurrentTime);
+    XTestFakeButtonEvent(display, 1, True, CurrentTime);
+    XTestFakeButtonEvent(display, 1, False, CurrentTime);
+    const long sent = now_us();
+    XFlush(display);
+    return sent;
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "inventory.hh"
+
+#include <X11/extensions/XInput.h>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <stdlib.h>
+
+// device name -> event node, of all event nodes
+static std::map<std::string, std::string> read_event_nodes(const char* sysfs_input,
+                                                           const char* sysfs_devname)
+{
+    std::map<std::string, std::string> nodes;
+    DIR* dp = opendir(sysfs_input);
+    if (dp == NULL)
+        return nodes;
+
+    while (dirent* ep = readdir(dp)) {
+        if (strncmp(ep->d_name, "event", strlen("event")) != 0)
+            continue;
+
+        std::string filename = std::string(sysfs_input) + "/" + ep->d_name + "/" + sysfs_devname;
+        std::ifstream ifile(filename.c_str());
+        std::string devname;
+        if (ifile.is_open() && std::getline(ifile, devname))
+            nodes.insert(std::make_pair(devname, std::string(ep->d_name)));
+    }
+    (void) closedir(dp);
+    return nodes;
+}
+
+// the evdev properties, as the CalibratorEvdev constructor reads them;
+// false if the device has no "Evdev Axis Calibration"
+static bool read_evdev_properties(XServer* server, XID id, XYinfo& calibration)
+{
+    int format;
+    std::vector<long> values;
+    if (!server->get_int_property(id, "Evdev Axis Calibration", format, values) ||
+        format != 32)
+        return false;
+    if (values.size() >= 4)
+        calibration = XYinfo(values[0], values[1], values[2], values[3]);
+
+    if (server->get_int_property(id, "Evdev Axes Swap", format, values) &&
+        format == 8 && values.size() == 1)
+        calibration.swap_xy = values[0];
+    if (server->get_int_property(id, "Evdev Axis Inversion", format, values) &&
+        format == 8 && values.size() == 2) {
+        calibration.x.invert = values[0];
+        calibration.y.invert = values[1];
+    }
+    return true;
+}
+
+std::vector<DeviceInventory> take_inventory(XServer* server, const char* pre_device,
+                                            const char* sysfs_input, const char* sysfs_devname)
+{
+    const std::map<std::string, std::string> nodes = read_event_nodes(sysfs_input, sysfs_devname);
+    std::vector<DeviceInventory> devices;
+
+    const bool pre_device_is_id = pre_device != NULL && *pre_device != '\0' &&
+                                  strspn(pre_device, "0123456789") == strlen(pre_device);
+    std::vector<XInputDevice> list;
+    if (pre_device_is_id) {
+        // only this device, no need to list them all
+        XInputDevice dev;
+        if (server->query_device((XID) atoi(pre_device), dev))
+            list.push_back(dev);
+    } else {
+        list = server->list_devices();
+    }
+    for (size_t i = 0; i < list.size(); i++) {
+        const XInputDevice& dev = list[i];
+        if (dev.use == IsXKeyboard || dev.use == IsXPointer) // virtual master device
+            continue;
+        if (!dev.is_calibratable())
+            continue;
+
+        DeviceInventory inv;
+        inv.id = dev.id;
+        inv.name = dev.name;
+        std::map<std::string, std::string>::const_iterator node = nodes.find(dev.name);
+        if (node != nodes.end())
+            inv.event_node = node->second;
+
+        if (pre_device != NULL && !pre_device_is_id &&
+            dev.name != pre_device && inv.event_node != pre_device)
+            continue;
+
+        // in the order make_calibrator() tries them
+        inv.range = dev.axys;
+        inv.calibration = dev.axys;
+        if (dev.name == "Usbtouchscreen")
+            inv.backend = "usbtouchscreen";
+        else if (server->open_device(dev.id) &&
+                 read_evdev_properties(server, dev.id, inv.calibration))
+            inv.backend = "evdev";
+        else
+            inv.backend = "xorg";
+
+        devices.push_back(inv);
+    }
+    return devices;
+}
+
+// s as a JSON string
+static std::string json_string(const std::string& s)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++) {
+        const unsigned char c = s[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c < 0x20) {
+            char esc[8];
+            sprintf(esc, "\\u%04x", c);
+            out += esc;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void print_device(FILE* out, const DeviceInventory& dev)
+{
+    const XYinfo& r = dev.range;
+    const XYinfo& c = dev.calibration;
+    fprintf(out, "{\"id\": %lu, \"name\": %s, \"event\": %s, \"backend\": \"%s\", "
+            "\"range\": [%d, %d, %d, %d], \"calibration\": [%d, %d, %d, %d], "
+            "\"swap_xy\": %s, \"invert_x\": %s, \"invert_y\": %s}",
+            (unsigned long) dev.id, json_string(dev.name).c_str(),
+            dev.event_node.empty() ? "null" : json_string(dev.event_node).c_str(),
+            dev.backend, r.x.min, r.x.max, r.y.min, r.y.max,
+            c.x.min, c.x.max, c.y.min, c.y.max,
+            c.swap_xy ? "true" : "false", c.x.invert ? "true" : "false",
+            c.y.invert ? "true" : "false");
+}
+
+void print_inventory(FILE* out, const std::vector<DeviceInventory>& devices, ListFormat format)
+{
+    if (format == LIST_LINES) {
+        for (size_t i = 0; i < devices.size(); i++) {
+            print_device(out, devices[i]);
+            fprintf(out, "\n");
+        }
+        return;
+    }
+
+    fprintf(out, "{\"devices\": [");
+    for (size_t i = 0; i < devices.size(); i++) {
+        fprintf(out, i == 0 ? "\n  " : ",\n  ");
+        print_device(out, devices[i]);
+    }
+    fprintf(out, devices.empty() ? "]}\n" : "\n]}\n");
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _inventory_hh
+#define _inventory_hh
+
+#include "calibrator.hh"
+#include "xserver/XServer.hpp"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/*
+ * Structured --list output, for auditing many hosts at once.
+ *
+ * LIST_JSON prints one document:
+ *   {"devices": [{"id": 9, "name": "...", "event": "event5",
+ *     "backend": "evdev", "range": [xmin, xmax, ymin, ymax],
+ *     "calibration": [xmin, xmax, ymin, ymax],
+ *     "swap_xy": false, "invert_x": false, "invert_y": false}, ...]}
+ * LIST_LINES prints the same objects, one per line.
+ * "event" is null when no sysfs event node has the device's name.
+ */
+enum ListFormat {
+    LIST_TEXT,
+    LIST_JSON,
+    LIST_LINES
+};
+
+/// What --list reports of a calibratable device
+struct DeviceInventory {
+    XID id;
+    std::string name;
+    /// sysfs event node (eg. event5), empty if not found
+    std::string event_node;
+    /// the calibrator make_calibrator() would pick: usbtouchscreen, evdev or xorg
+    const char* backend;
+    /// the valuator ranges
+    XYinfo range;
+    /// the current calibration, with swap_xy and the inversion;
+    /// the valuator ranges if the driver does not export it
+    XYinfo calibration;
+};
+
+/// The calibratable devices and their properties, in one pass over the server
+/// and one over sysfs_input; only pre_device (id, name or event node) if given
+std::vector<DeviceInventory> take_inventory(XServer* server, const char* pre_device,
+                                            const char* sysfs_input, const char* sysfs_devname);
+
+/// Print the inventory as JSON or JSON lines
+void print_inventory(FILE* out, const std::vector<DeviceInventory>& devices, ListFormat format);
+
+#endif
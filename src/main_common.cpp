@@ -27,6 +27,8 @@
 #include "calibrator/Usbtouchscreen.hpp"
 #include "calibrator/Evdev.hpp"
 #include "calibrator/XorgPrint.hpp"
+#include "inventory.hh"
+#include "xserver/XlibServer.hpp"
 
 #include <cstring>
 #include <fstream>
@@ -37,17 +39,6 @@
 #include <X11/Xlib.h>
 #include <X11/extensions/XInput.h>
 
-// strdup: non-ansi
-static char* my_strdup(const char* s) {
-    size_t len = strlen(s) + 1;
-    void* p = malloc(len);
-
-    if (p == NULL)
-        return NULL;
-
-    return (char*) memcpy(p, s, len);
-}
-
 /**
  * find a calibratable touchscreen device (using XInput)
  *
@@ -55,34 +46,35 @@ static char* my_strdup(const char* s) {
  * retuns number of devices found,
  * the data of the device is returned in the last 3 function parameters
  */
-int Calibrator::find_device(const char* pre_device, bool list_devices,
-        XID& device_id, const char*& device_name, XYinfo& device_axys)
+int Calibrator::find_device(const CalibratorContext& context,
+        const char* pre_device, bool list_devices,
+        XID& device_id, std::string& device_name, XYinfo& device_axys,
+        XServer* server)
 {
     bool pre_device_is_id = true;
     bool pre_device_is_sysfs = false;
     int found = 0;
 
-    Display* display = XOpenDisplay(NULL);
-    if (display == NULL) {
+    XlibServer* own = NULL;
+    if (server == NULL)
+        server = own = new XlibServer();
+
+    if (!server->is_connected()) {
         fprintf(stderr, "Unable to connect to X server\n");
-        exit(1);
+        delete own;
+        return -1;
     }
 
-    int xi_opcode, event, error;
-    if (!XQueryExtension(display, "XInputExtension", &xi_opcode, &event, &error)) {
+    int major, minor;
+    if (!server->query_xinput(major, minor)) {
         fprintf(stderr, "X Input extension not available.\n");
-        exit(1);
+        delete own;
+        return -1;
     }
 
     // verbose, get Xi version
-    if (verbose) {
-        XExtensionVersion *version = XGetExtensionVersion(display, INAME);
-
-        if (version && (version != (XExtensionVersion*) NoSuchExtension)) {
-            printf("DEBUG: %s version is %i.%i\n",
-                INAME, version->major_version, version->minor_version);
-            XFree(version);
-        }
+    if (context.verbose && major != -1) {
+        printf("DEBUG: %s version is %i.%i\n", INAME, major, minor);
     }
 
     if (pre_device != NULL) {
@@ -102,10 +94,10 @@ int Calibrator::find_device(const char* pre_device, bool list_devices,
         if ( strlen(pre_device) < strlen("event") + 4 &&
              strncmp(pre_device, "event", strlen("event")) == 0 ) {
             // check whether the pre_device is an sysfs-path name
-            char filename[40]; // actually 35, but hey...
-            (void) sprintf(filename, "%s/%s/%s", SYSFS_INPUT, pre_device, SYSFS_DEVNAME);
+            const std::string filename = context.sysfs_input + "/" + pre_device +
+                                         "/" + context.sysfs_devname;
 
-            std::ifstream ifile(filename);
+            std::ifstream ifile(filename.c_str());
             if (ifile.is_open()) {
                 if (!ifile.eof()) {
                     pre_device_is_sysfs = true;
@@ -116,20 +108,27 @@ int Calibrator::find_device(const char* pre_device, bool list_devices,
         }
     }
 
-    if (verbose)
+    if (context.verbose)
         printf("DEBUG: Skipping virtual master devices and devices without axis valuators.\n");
-    int ndevices;
-    XDeviceInfoPtr list, slist;
-    slist=list=(XDeviceInfoPtr) XListInputDevices (display, &ndevices);
-    for (int i=0; i<ndevices; i++, list++)
+    std::vector<XInputDevice> list;
+    if (pre_device != NULL && pre_device_is_id) {
+        // only this device, no need to list them all
+        XInputDevice dev;
+        if (server->query_device((XID) atoi(pre_device), dev))
+            list.push_back(dev);
+    } else {
+        list = server->list_devices();
+    }
+    for (size_t i=0; i<list.size(); i++)
     {
-        if (list->use == IsXKeyboard || list->use == IsXPointer) // virtual master device
+        const XInputDevice& dev = list[i];
+        if (dev.use == IsXKeyboard || dev.use == IsXPointer) // virtual master device
             continue;
 
         // if we are looking for a specific device
         if (pre_device != NULL) {
-            if ((pre_device_is_id && list->id == (XID) atoi(pre_device)) ||
-                (!pre_device_is_id && strcmp(list->name, pre_device_is_sysfs ? pre_device_sysfs.c_str() : pre_device ) == 0)) {
+            if ((pre_device_is_id && dev.id == (XID) atoi(pre_device)) ||
+                (!pre_device_is_id && dev.name == (pre_device_is_sysfs ? pre_device_sysfs.c_str() : pre_device))) {
                 // OK, fall through
             } else {
                 // skip, not this device
@@ -137,62 +136,44 @@ int Calibrator::find_device(const char* pre_device, bool list_devices,
             }
         }
 
-        XAnyClassPtr any = (XAnyClassPtr) (list->inputclassinfo);
-        for (int j=0; j<list->num_classes; j++)
-        {
-
-            if (any->c_class == ValuatorClass)
-            {
-                XValuatorInfoPtr V = (XValuatorInfoPtr) any;
-                XAxisInfoPtr ax = (XAxisInfoPtr) V->axes;
-
-                if (V->mode != Absolute) {
-                    if (verbose)
-                        printf("DEBUG: Skipping device '%s' id=%i, does not report Absolute events.\n",
-                            list->name, (int)list->id);
-                } else if (V->num_axes < 2 ||
-                    (ax[0].min_value == -1 && ax[0].max_value == -1) ||
-                    (ax[1].min_value == -1 && ax[1].max_value == -1)) {
-                    if (verbose)
-                        printf("DEBUG: Skipping device '%s' id=%i, does not have two calibratable axes.\n",
-                            list->name, (int)list->id);
-                } else {
-                    /* a calibratable device (has 2 axis valuators) */
-                    found++;
-                    device_id = list->id;
-                    device_name = my_strdup(list->name);
-                    device_axys.x.min = ax[0].min_value;
-                    device_axys.x.max = ax[0].max_value;
-                    device_axys.y.min = ax[1].min_value;
-                    device_axys.y.max = ax[1].max_value;
-
-                    if (list_devices)
-                        printf("Device \"%s\" id=%i\n", device_name, (int)device_id);
-                }
-
-            }
+        // devices without valuators
+        if (dev.num_axes == 0)
+            continue;
 
-            /*
-             * Increment 'any' to point to the next item in the linked
-             * list.  The length is in bytes, so 'any' must be cast to
-             * a character pointer before being incremented.
-             */
-            any = (XAnyClassPtr) ((char *) any + any->length);
+        if (!dev.absolute) {
+            if (context.verbose)
+                printf("DEBUG: Skipping device '%s' id=%i, does not report Absolute events.\n",
+                    dev.name.c_str(), (int)dev.id);
+        } else if (!dev.is_calibratable()) {
+            if (context.verbose)
+                printf("DEBUG: Skipping device '%s' id=%i, does not have two calibratable axes.\n",
+                    dev.name.c_str(), (int)dev.id);
+        } else {
+            /* a calibratable device (has 2 axis valuators) */
+            found++;
+            device_id = dev.id;
+            device_name = dev.name;
+            device_axys.x.min = dev.axys.x.min;
+            device_axys.x.max = dev.axys.x.max;
+            device_axys.y.min = dev.axys.y.min;
+            device_axys.y.max = dev.axys.y.max;
+
+            if (list_devices)
+                printf("Device \"%s\" id=%i\n", device_name.c_str(), (int)device_id);
         }
-
     }
-    XFreeDeviceList(slist);
-    XCloseDisplay(display);
+    delete own;
 
     return found;
 }
 
 static void usage(char* cmd, unsigned thr_misclick)
 {
-    fprintf(stderr, "Usage: %s [-h|--help] [-v|--verbose] [--list] [--device <device name or XID or sysfs path>] [--precalib <minx> <maxx> <miny> <maxy>] [--misclick <nr of pixels>] [--output-type <auto|xorg.conf.d|hal|xinput>] [--fake] [--geometry <w>x<h>] [--no-timeout]\n", cmd);
+    fprintf(stderr, "Usage: %s [-h|--help] [-v|--verbose] [--list] [--list-format <json|lines>] [--device <device name or XID or sysfs path>] [--precalib <minx> <maxx> <miny> <maxy>] [--misclick <nr of pixels>] [--output-type <auto|xorg.conf.d|hal|xinput>] [--fake] [--geometry <w>x<h>] [--no-timeout] [--verify <nr of pixels>] [--verify-grid <n>] [--correction-output <file>] [--publish-shm] [--record <file>] [--latency-trace <file>] [--follow-rotation]\n", cmd);
     fprintf(stderr, "\t-h, --help: print this help message\n");
     fprintf(stderr, "\t-v, --verbose: print debug messages during the process\n");
     fprintf(stderr, "\t--list: list calibratable input devices and quit\n");
+    fprintf(stderr, "\t--list-format <json|lines>: list them with their ranges, backend, current calibration and event node, as one JSON document or one JSON object per line (implies --list)\n");
     fprintf(stderr, "\t--device <device name or XID or sysfs event name (e.g event5)>: select a specific device to calibrate\n");
     fprintf(stderr, "\t--precalib: manually provide the current calibration setting (eg. the values in xorg.conf)\n");
     fprintf(stderr, "\t--misclick: set the misclick threshold (0=off, default: %i pixels)\n",
@@ -202,11 +183,20 @@ static void usage(char* cmd, unsigned thr_misclick)
     fprintf(stderr, "\t--geometry: manually provide the geometry (width and height) for the calibration window\n");
     fprintf(stderr, "\t--no-timeout: turns off the timeout\n");
     fprintf(stderr, "\t--output-filename: write calibration data to file (USB: override default /etc/modprobe.conf.local\n");
+    fprintf(stderr, "\t--verify: after calibrating, tap %i more points and fail (exit code %i) if their RMS error exceeds the given nr of pixels\n",
+        NUM_VERIFY_POINTS, EXIT_VERIFY_FAILED);
+    fprintf(stderr, "\t--verify-grid: tap a grid of n x n points in the verification pass instead\n");
+    fprintf(stderr, "\t--correction-output: fit a non-linear correction grid from the verification pass (needs --verify-grid) and write it to file\n");
+    fprintf(stderr, "\t--publish-shm: publish the new calibration in shared memory, for applications doing their own coordinate mapping (see xinput_calibrator_shm.h)\n");
+    fprintf(stderr, "\t--record: record the clicks and the calibration to file, to replay the session offline with xinput_calibrator_replay\n");
+    fprintf(stderr, "\t--latency-trace: write a timestamp of every click, expose, clock tick, redraw and applied calibration to file (see xinput_calibrator_latency)\n");
+    fprintf(stderr, "\t--follow-rotation: don't calibrate, keep the current calibration matching the screen when it is rotated or reflected (RandR)\n");
 }
 
 Calibrator* Calibrator::make_calibrator(int argc, char** argv)
 {
     bool list_devices = false;
+    ListFormat list_format = LIST_TEXT;
     bool fake = false;
     bool precalib = false;
     bool use_timeout = true;
@@ -216,7 +206,15 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
     const char* output_filename = NULL;
     unsigned thr_misclick = 15;
     unsigned thr_doubleclick = 7;
+    float thr_verify = 0;
+    int verify_grid = 0;
+    const char* correction_output = NULL;
+    bool publish_shm = false;
+    const char* record_output = NULL;
+    const char* latency_trace = NULL;
+    bool follow_rotation = false;
     OutputType output_type = OUTYPE_AUTO;
+    CalibratorContext context;
 
     // parse input
     if (argc > 1) {
@@ -232,7 +230,7 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
             // Verbose output ?
             if (strcmp("-v", argv[i]) == 0 ||
                 strcmp("--verbose", argv[i]) == 0) {
-                verbose = true;
+                context.verbose = true;
             } else
 
             // Just list devices ?
@@ -240,6 +238,21 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
                 list_devices = true;
             } else
 
+            // Structured list ?
+            if (strcmp("--list-format", argv[i]) == 0) {
+                list_devices = true;
+                if (argc > i+1 && strcmp("json", argv[i+1]) == 0)
+                    list_format = LIST_JSON;
+                else if (argc > i+1 && strcmp("lines", argv[i+1]) == 0)
+                    list_format = LIST_LINES;
+                else {
+                    fprintf(stderr, "Error: --list-format needs one of json|lines.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+                i++;
+            } else
+
             // Select specific device ?
             if (strcmp("--device", argv[i]) == 0) {
                 if (argc > i+1)
@@ -317,7 +330,72 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
 			// Output file
 			if (strcmp("--output-filename", argv[i]) == 0) {
 				output_filename = argv[++i];
-			}
+			} else
+
+            // Verification pass ?
+            if (strcmp("--verify", argv[i]) == 0) {
+                if (argc > i+1)
+                    thr_verify = atof(argv[++i]);
+                if (thr_verify <= 0) {
+                    fprintf(stderr, "Error: --verify needs a positive number (the RMS pixel threshold) as argument.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+            } else
+
+            // Grid of verification points ?
+            if (strcmp("--verify-grid", argv[i]) == 0) {
+                if (argc > i+1)
+                    verify_grid = atoi(argv[++i]);
+                if (verify_grid < 2) {
+                    fprintf(stderr, "Error: --verify-grid needs the number of rows/columns (at least 2) as argument.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+            } else
+
+            // Non-linear correction output file ?
+            if (strcmp("--correction-output", argv[i]) == 0) {
+                if (argc > i+1)
+                    correction_output = argv[++i];
+                else {
+                    fprintf(stderr, "Error: --correction-output needs a filename as argument.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+            } else
+
+            // Publish in shared memory ?
+            if (strcmp("--publish-shm", argv[i]) == 0) {
+                publish_shm = true;
+            } else
+
+            // Record the session ?
+            if (strcmp("--record", argv[i]) == 0) {
+                if (argc > i+1)
+                    record_output = argv[++i];
+                else {
+                    fprintf(stderr, "Error: --record needs a filename as argument.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+            } else
+
+            // Trace the latency of the GUI ?
+            if (strcmp("--latency-trace", argv[i]) == 0) {
+                if (argc > i+1)
+                    latency_trace = argv[++i];
+                else {
+                    fprintf(stderr, "Error: --latency-trace needs a filename as argument.\n\n");
+                    usage(argv[0], thr_misclick);
+                    exit(1);
+                }
+            } else
+
+            // Follow the screen rotation ?
+            if (strcmp("--follow-rotation", argv[i]) == 0) {
+                follow_rotation = true;
+            }
 
             // unknown option
             else {
@@ -329,21 +407,50 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
     }
 
 
+    if (correction_output != NULL && verify_grid == 0) {
+        fprintf(stderr, "Error: --correction-output needs --verify-grid.\n\n");
+        usage(argv[0], thr_misclick);
+        exit(1);
+    }
+    if (verify_grid != 0 && thr_verify == 0 && correction_output == NULL) {
+        fprintf(stderr, "Error: --verify-grid needs --verify or --correction-output.\n\n");
+        usage(argv[0], thr_misclick);
+        exit(1);
+    }
+
     /// Choose the device to calibrate
     XID         device_id   = (XID) -1;
-    const char* device_name = NULL;
+    std::string device_name;
     XYinfo      device_axys;
     if (fake) {
         // Fake a calibratable device
         device_name = "Fake_device";
         device_axys = XYinfo(0,1000,0,1000);
 
-        if (verbose) {
-            printf("DEBUG: Faking device: %s\n", device_name);
+        if (context.verbose) {
+            printf("DEBUG: Faking device: %s\n", device_name.c_str());
         }
+    } else if (list_devices && list_format != LIST_TEXT) {
+        XlibServer server;
+        int major, minor;
+        if (!server.is_connected()) {
+            fprintf(stderr, "Unable to connect to X server\n");
+            exit(1);
+        }
+        if (!server.query_xinput(major, minor)) {
+            fprintf(stderr, "X Input extension not available.\n");
+            exit(1);
+        }
+
+        print_inventory(stdout, take_inventory(&server, pre_device, context.sysfs_input.c_str(),
+                                       context.sysfs_devname.c_str()),
+                        list_format);
+        exit(2);
     } else {
         // Find the right device
-        int nr_found = find_device(pre_device, list_devices, device_id, device_name, device_axys);
+        int nr_found = find_device(context, pre_device, list_devices, device_id, device_name, device_axys);
+        if (nr_found < 0)
+            exit(1);
 
         if (list_devices) {
             // printed the list in find_device
@@ -360,11 +467,11 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
             exit(1);
 
         } else if (nr_found > 1) {
-            printf ("Warning: multiple calibratable devices found, calibrating last one (%s)\n\tuse --device to select another one.\n", device_name);
+            printf ("Warning: multiple calibratable devices found, calibrating last one (%s)\n\tuse --device to select another one.\n", device_name.c_str());
         }
 
-        if (verbose) {
-            printf("DEBUG: Selected device: %s\n", device_name);
+        if (context.verbose) {
+            printf("DEBUG: Selected device: %s\n", device_name.c_str());
         }
     }
 
@@ -379,7 +486,7 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
         if (pre_axys.y.max != -1)
             device_axys.y.max = pre_axys.y.max;
 
-        if (verbose) {
+        if (context.verbose) {
             printf("DEBUG: Setting precalibration: %i, %i, %i, %i\n",
                 device_axys.x.min, device_axys.x.max,
                 device_axys.y.min, device_axys.y.max);
@@ -388,30 +495,57 @@ Calibrator* Calibrator::make_calibrator(int argc, char** argv)
 
 
     // Different device/driver, different ways to apply the calibration values
+    Calibrator* calibrator = NULL;
     try {
         // try Usbtouchscreen driver
-        return new CalibratorUsbtouchscreen(device_name, device_axys,
+        calibrator = new CalibratorUsbtouchscreen(device_name.c_str(), device_axys,
             thr_misclick, thr_doubleclick, output_type, geometry,
-            use_timeout, output_filename);
+            use_timeout, output_filename, context);
 
     } catch(WrongCalibratorException& x) {
-        if (verbose)
+        if (context.verbose)
             printf("DEBUG: Not usbtouchscreen calibrator: %s\n", x.what());
     }
 
-    try {
-        // next, try Evdev driver (with XID)
-        return new CalibratorEvdev(device_name, device_axys, device_id,
-            thr_misclick, thr_doubleclick, output_type, geometry,
-            use_timeout, output_filename);
+    if (calibrator == NULL) {
+        try {
+            // next, try Evdev driver (with XID)
+            calibrator = new CalibratorEvdev(device_name.c_str(), device_axys, device_id,
+                thr_misclick, thr_doubleclick, output_type, geometry,
+                use_timeout, output_filename, NULL, context);
 
-    } catch(WrongCalibratorException& x) {
-        if (verbose)
-            printf("DEBUG: Not evdev calibrator: %s\n", x.what());
+        } catch(WrongCalibratorException& x) {
+            if (context.verbose)
+                printf("DEBUG: Not evdev calibrator: %s\n", x.what());
+        }
     }
 
-    // lastly, presume a standard Xorg driver (evtouch, mutouch, ...)
-    return new CalibratorXorgPrint(device_name, device_axys,
-            thr_misclick, thr_doubleclick, output_type, geometry,
-            use_timeout, output_filename);
+    if (calibrator == NULL) {
+        // lastly, presume a standard Xorg driver (evtouch, mutouch, ...);
+        // it does not talk to the server, ask it which config it reads
+        OutputType xorg_output_type = output_type;
+        if (xorg_output_type == OUTYPE_AUTO) {
+            XlibServer server;
+            xorg_output_type = server.has_xorgconfd_support() ? OUTYPE_XORGCONFD : OUTYPE_HAL;
+        }
+        calibrator = new CalibratorXorgPrint(device_name.c_str(), device_axys,
+                thr_misclick, thr_doubleclick, xorg_output_type, geometry,
+                use_timeout, output_filename, context);
+    }
+
+    calibrator->set_threshold_verify(thr_verify);
+    calibrator->set_verify_grid(verify_grid);
+    calibrator->set_correction_output(correction_output);
+    calibrator->set_publish_shm(publish_shm);
+    if (record_output != NULL && !calibrator->set_record_output(record_output))
+        exit(1);
+    if (latency_trace != NULL && !calibrator->set_latency_trace(latency_trace))
+        exit(1);
+
+    if (follow_rotation) {
+        const bool success = calibrator->follow_screen_changes();
+        delete calibrator;
+        exit(success ? 0 : 1);
+    }
+    return calibrator;
 }
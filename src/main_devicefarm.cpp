@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+
+#include "calibrator.hh"
+#include "calibrator/XorgPrint.hpp"
+#include "xserver/XlibServer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <linux/uinput.h>
+
+/*
+ * Discovery scaling benchmark.
+ *
+ * Creates absolute uinput devices, N = 1, 2, 4, ... up to --max, waits
+ * until the X server hotplugged all of them, and times every step of the
+ * device discovery at each N. Needs write access to /dev/uinput and an
+ * X server that adds evdev devices, see xinput_calibrator_devicefarm.sh.
+ *
+ * Prints one line per N: N and the median time of each step in us,
+ *   N find_device(name) find_device(id) is_sysfs_name make_calibrator --list
+ * as a gnuplot data file.
+ */
+
+static const char* farm_name = "xinput_calibrator farm";
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [--max <n>] [--repeat <n>] [--calibrator <path>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t--max: largest number of devices (default: 512)\n");
+    fprintf(stderr, "\t--repeat: runs of each step per N, the median is reported (default: 21)\n");
+    fprintf(stderr, "\t--calibrator: the xinput_calibrator to time --list of (default: xinput_calibrator)\n");
+}
+
+/// the protected discovery steps of Calibrator
+class FarmProbe : public CalibratorXorgPrint
+{
+public:
+    FarmProbe(const char* name, const XYinfo& axys)
+      : CalibratorXorgPrint(name, axys) {}
+
+    using Calibrator::find_device;
+    using Calibrator::is_sysfs_name;
+};
+
+/// create uinput touchscreen i, returns its fd or -1
+static int create_device(int i)
+{
+    const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (fd < 0)
+        return -1;
+
+    ioctl(fd, UI_SET_EVBIT, EV_SYN);
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_KEYBIT, BTN_TOUCH);
+    ioctl(fd, UI_SET_EVBIT, EV_ABS);
+    ioctl(fd, UI_SET_ABSBIT, ABS_X);
+    ioctl(fd, UI_SET_ABSBIT, ABS_Y);
+    ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT);
+
+    struct uinput_user_dev dev;
+    memset(&dev, 0, sizeof(dev));
+    snprintf(dev.name, sizeof(dev.name), "%s %d", farm_name, i);
+    dev.id.bustype = BUS_VIRTUAL;
+    dev.absmax[ABS_X] = 4095;
+    dev.absmax[ABS_Y] = 4095;
+
+    if (write(fd, &dev, sizeof(dev)) != sizeof(dev) ||
+        ioctl(fd, UI_DEV_CREATE) < 0) {
+        const int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/// wait until the server has n farm devices, returns the id of the last one
+static XID wait_for_devices(XServer& server, int n)
+{
+    char last[UINPUT_MAX_NAME_SIZE];
+    snprintf(last, sizeof(last), "%s %d", farm_name, n - 1);
+    for (int tries = 0; tries != 600; tries++) {
+        std::vector<XInputDevice> list = server.list_devices();
+        int found = 0;
+        XID id = (XID) -1;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (list[i].name.compare(0, strlen(farm_name), farm_name) == 0)
+                found++;
+            if (list[i].name == last)
+                id = list[i].id;
+        }
+        if (found == n && id != (XID) -1)
+            return id;
+        usleep(50000);
+    }
+    return (XID) -1;
+}
+
+static long elapsed_us(const timespec& t0)
+{
+    timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return (t1.tv_sec - t0.tv_sec)*1000000L + (t1.tv_nsec - t0.tv_nsec)/1000;
+}
+
+static long median(std::vector<long> v)
+{
+    std::sort(v.begin(), v.end());
+    return v[v.size()/2];
+}
+
+/// run 'calibrator --list' to the end, false if it did not exit with 2
+static bool run_list(const char* calibrator)
+{
+    const pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, 1);
+        dup2(null, 2);
+        execlp(calibrator, calibrator, "--list", (char*) NULL);
+        _exit(127);
+    }
+
+    int status;
+    return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 2;
+}
+
+int main(int argc, char** argv)
+{
+    int max = 512;
+    int repeat = 21;
+    const char* calibrator = "xinput_calibrator";
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("--max", argv[i]) == 0 && argc > i+1) {
+            max = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--repeat", argv[i]) == 0 && argc > i+1) {
+            repeat = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--calibrator", argv[i]) == 0 && argc > i+1) {
+            calibrator = argv[++i];
+        }
+
+        else {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (max < 1 || repeat < 1) {
+        fprintf(stderr, "Error: --max and --repeat need a positive number\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    XlibServer server;
+    if (!server.is_connected()) {
+        fprintf(stderr, "Unable to connect to X server\n");
+        return 1;
+    }
+
+    // the calibrators print their progress on stdout, the results go to the real one
+    FILE* out = fdopen(dup(1), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        fprintf(stderr, "Error: can't redirect stdout\n");
+        return 1;
+    }
+    FarmProbe probe("xinput_calibrator farm probe", XYinfo(0, 4095, 0, 4095));
+
+    fprintf(out, "# N find_device(name) find_device(id) is_sysfs_name make_calibrator --list (us)\n");
+    std::vector<int> fds;
+    for (int n = 1; n <= max; n *= 2) {
+        while ((int) fds.size() < n) {
+            const int fd = create_device(fds.size());
+            if (fd < 0) {
+                fprintf(stderr, "Error: can't create uinput device %d: %s\n",
+                        (int) fds.size(), strerror(errno));
+                return 1;
+            }
+            fds.push_back(fd);
+        }
+        const XID id = wait_for_devices(server, n);
+        if (id == (XID) -1) {
+            fprintf(stderr, "Error: the X server did not add the %d devices\n", n);
+            return 1;
+        }
+
+        // the last device, by name and by id
+        char name[UINPUT_MAX_NAME_SIZE], id_str[16];
+        snprintf(name, sizeof(name), "%s %d", farm_name, n - 1);
+        snprintf(id_str, sizeof(id_str), "%lu", (unsigned long) id);
+        char* probe_argv[] = {argv[0], (char*) "--device", name, NULL};
+
+        std::vector<long> by_name, by_id, sysfs, make, list;
+        for (int r = 0; r != repeat; r++) {
+            XID device_id;
+            std::string device_name;
+            XYinfo device_axys;
+            timespec t0;
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            FarmProbe::find_device(probe.get_context(), name, false, device_id, device_name,
+                                   device_axys, &server);
+            by_name.push_back(elapsed_us(t0));
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            FarmProbe::find_device(probe.get_context(), id_str, false, device_id, device_name,
+                                   device_axys, &server);
+            by_id.push_back(elapsed_us(t0));
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            probe.is_sysfs_name(name);
+            sysfs.push_back(elapsed_us(t0));
+
+            // find_device and the backends tried in turn, on their own connections
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            delete Calibrator::make_calibrator(3, probe_argv);
+            make.push_back(elapsed_us(t0));
+
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            if (!run_list(calibrator)) {
+                fprintf(stderr, "Error: '%s --list' failed\n", calibrator);
+                return 1;
+            }
+            list.push_back(elapsed_us(t0));
+        }
+        fprintf(out, "%d %ld %ld %ld %ld %ld\n", n, median(by_name), median(by_id),
+                median(sysfs), median(make), median(list));
+        fflush(out);
+    }
+
+    for (size_t i = 0; i < fds.size(); i++) {
+        ioctl(fds[i], UI_DEV_DESTROY);
+        close(fds[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "calibrator.hh"
+#include "calibrator/XorgPrint.hpp"
+#include "gui/fb.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * The calibrator without an X server: draws on a framebuffer (fbdev, or
+ * an image file for testing) and reads the taps straight from the evdev
+ * node of the touchscreen. The calibration is output as xorg.conf.d
+ * snippet or HAL policy, and can be published in shared memory.
+ */
+
+static void usage(char* cmd, unsigned thr_misclick)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] --device-node <path> [--fb <path>] [--fb-geometry <w>x<h>] [--precalib <minx> <maxx> <miny> <maxy>] [--misclick <nr of pixels>] [--output-type <xorg.conf.d|hal>] [--output-filename <file>] [--no-timeout] [--verify <nr of pixels>] [--publish-shm] [--record <file>] [--latency-trace <file>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t--device-node: the event node of the touchscreen (eg. /dev/input/event5)\n");
+    fprintf(stderr, "\t--fb: the framebuffer device (default: /dev/fb0)\n");
+    fprintf(stderr, "\t--fb-geometry: draw on the file given with --fb instead, as a <w>x<h> XRGB8888 image\n");
+    fprintf(stderr, "\t--precalib: manually provide the current calibration setting (default: the range of the device)\n");
+    fprintf(stderr, "\t--misclick: set the misclick threshold (0=off, default: %i pixels)\n",
+        thr_misclick);
+    fprintf(stderr, "\t--output-type <xorg.conf.d|hal>: type of config to ouput (default: xorg.conf.d)\n");
+    fprintf(stderr, "\t--output-filename: write calibration data to file\n");
+    fprintf(stderr, "\t--no-timeout: turns off the timeout\n");
+    fprintf(stderr, "\t--verify: after calibrating, tap %i more points and fail (exit code %i) if their RMS error exceeds the given nr of pixels\n",
+        NUM_VERIFY_POINTS, EXIT_VERIFY_FAILED);
+    fprintf(stderr, "\t--publish-shm: publish the new calibration in shared memory (see xinput_calibrator_shm.h)\n");
+    fprintf(stderr, "\t--record: record the clicks and the calibration to file\n");
+    fprintf(stderr, "\t--latency-trace: write a timestamp of the first frame, every tap, clock tick, redraw and the applied calibration to file\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* node = NULL;
+    const char* fb_path = "/dev/fb0";
+    int fb_width = 0, fb_height = 0;
+    bool precalib = false;
+    XYinfo pre_axys;
+    unsigned thr_misclick = 15;
+    unsigned thr_doubleclick = 7;
+    OutputType output_type = OUTYPE_XORGCONFD;
+    const char* output_filename = NULL;
+    bool use_timeout = true;
+    float thr_verify = 0;
+    bool publish_shm = false;
+    const char* record_output = NULL;
+    const char* latency_trace = NULL;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0], thr_misclick);
+            return 0;
+        } else
+
+        if (strcmp("--device-node", argv[i]) == 0 && argc > i+1) {
+            node = argv[++i];
+        } else
+
+        if (strcmp("--fb", argv[i]) == 0 && argc > i+1) {
+            fb_path = argv[++i];
+        } else
+
+        if (strcmp("--fb-geometry", argv[i]) == 0 && argc > i+1) {
+            if (sscanf(argv[++i], "%dx%d", &fb_width, &fb_height) != 2 ||
+                fb_width <= 0 || fb_height <= 0) {
+                fprintf(stderr, "Error: --fb-geometry needs <w>x<h> as argument.\n\n");
+                usage(argv[0], thr_misclick);
+                return 1;
+            }
+        } else
+
+        if (strcmp("--precalib", argv[i]) == 0 && argc > i+4) {
+            precalib = true;
+            pre_axys.x.min = atoi(argv[++i]);
+            pre_axys.x.max = atoi(argv[++i]);
+            pre_axys.y.min = atoi(argv[++i]);
+            pre_axys.y.max = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--misclick", argv[i]) == 0 && argc > i+1) {
+            thr_misclick = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--output-type", argv[i]) == 0 && argc > i+1) {
+            i++;
+            if (strcmp("xorg.conf.d", argv[i]) == 0)
+                output_type = OUTYPE_XORGCONFD;
+            else if (strcmp("hal", argv[i]) == 0)
+                output_type = OUTYPE_HAL;
+            else {
+                fprintf(stderr, "Error: --output-type needs one of xorg.conf.d|hal.\n\n");
+                usage(argv[0], thr_misclick);
+                return 1;
+            }
+        } else
+
+        if (strcmp("--output-filename", argv[i]) == 0 && argc > i+1) {
+            output_filename = argv[++i];
+        } else
+
+        if (strcmp("--no-timeout", argv[i]) == 0) {
+            use_timeout = false;
+        } else
+
+        if (strcmp("--verify", argv[i]) == 0 && argc > i+1) {
+            thr_verify = atof(argv[++i]);
+            if (thr_verify <= 0) {
+                fprintf(stderr, "Error: --verify needs a positive number (the RMS pixel threshold) as argument.\n\n");
+                usage(argv[0], thr_misclick);
+                return 1;
+            }
+        } else
+
+        if (strcmp("--publish-shm", argv[i]) == 0) {
+            publish_shm = true;
+        } else
+
+        if (strcmp("--record", argv[i]) == 0 && argc > i+1) {
+            record_output = argv[++i];
+        } else
+
+        if (strcmp("--latency-trace", argv[i]) == 0 && argc > i+1) {
+            latency_trace = argv[++i];
+        } else {
+            fprintf(stderr, "Error: unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0], thr_misclick);
+            return 1;
+        }
+    }
+
+    if (node == NULL) {
+        fprintf(stderr, "Error: need the --device-node of the touchscreen\n\n");
+        usage(argv[0], thr_misclick);
+        return 1;
+    }
+
+    try {
+        TouchInput touch(node);
+        Framebuffer fb(fb_path, fb_width, fb_height);
+
+        XYinfo axys = touch.get_range();
+        if (precalib)
+            axys = pre_axys;
+
+        Calibrator* calibrator = new CalibratorXorgPrint(touch.get_name(), axys,
+            thr_misclick, thr_doubleclick, output_type, NULL, use_timeout,
+            output_filename);
+        calibrator->set_threshold_verify(thr_verify);
+        calibrator->set_publish_shm(publish_shm);
+        if (record_output != NULL && !calibrator->set_record_output(record_output))
+            return 1;
+        if (latency_trace != NULL && !calibrator->set_latency_trace(latency_trace))
+            return 1;
+
+        // exits when the session is over
+        GuiCalibratorFB gui(calibrator, fb, touch, axys);
+        const int ret = gui.run();
+        delete calibrator;
+        return ret;
+    } catch (std::runtime_error& ex) {
+        fprintf(stderr, "Error: %s\n", ex.what());
+        return 1;
+    }
+}
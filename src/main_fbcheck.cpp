@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "calibrator.hh"
+#include "tracereader.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <linux/uinput.h>
+
+/*
+ * End-to-end check of the framebuffer calibrator (xinput_calibrator_fb).
+ *
+ * Creates a uinput touchscreen that reports 0..4095 on both axes, but
+ * whose panel only spans --panel <minx> <maxx> <miny> <maxy> of it.
+ * Runs the calibrator on it with an image file as framebuffer and its
+ * latency trace on a pipe, taps the four targets as that panel would
+ * report them, and checks that the calibration written to file is the
+ * panel range. Also times, on CLOCK_MONOTONIC:
+ *   first frame  from the fork to the first frame in the framebuffer
+ *   tap          from the written tap to its frame in the framebuffer
+ *   finish       from the last tap to the applied calibration
+ * Needs write access to /dev/uinput, no X server.
+ */
+
+static const char* device_name = "xinput_calibrator fb check";
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [--runs <n>] [--calibrator <path>] [--geometry <w>x<h>] [--panel <minx> <maxx> <miny> <maxy>] [--timeout <ms>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t--runs: calibration sessions to run (default: 10)\n");
+    fprintf(stderr, "\t--calibrator: the framebuffer calibrator to check (default: xinput_calibrator_fb)\n");
+    fprintf(stderr, "\t--geometry: size of the image file framebuffer (default: 800x480)\n");
+    fprintf(stderr, "\t--panel: the range of the device the panel spans (default: 200 3900 300 3800)\n");
+    fprintf(stderr, "\t--timeout: give up when the calibrator is silent for that long (default: 5000)\n");
+}
+
+/// create the uinput touchscreen, returns its fd or -1
+static int create_device()
+{
+    const int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (fd < 0)
+        return -1;
+
+    ioctl(fd, UI_SET_EVBIT, EV_SYN);
+    ioctl(fd, UI_SET_EVBIT, EV_KEY);
+    ioctl(fd, UI_SET_KEYBIT, BTN_TOUCH);
+    ioctl(fd, UI_SET_EVBIT, EV_ABS);
+    ioctl(fd, UI_SET_ABSBIT, ABS_X);
+    ioctl(fd, UI_SET_ABSBIT, ABS_Y);
+    ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT);
+
+    struct uinput_user_dev dev;
+    memset(&dev, 0, sizeof(dev));
+    snprintf(dev.name, sizeof(dev.name), "%s", device_name);
+    dev.id.bustype = BUS_VIRTUAL;
+    dev.absmax[ABS_X] = 4095;
+    dev.absmax[ABS_Y] = 4095;
+
+    if (write(fd, &dev, sizeof(dev)) != sizeof(dev) ||
+        ioctl(fd, UI_DEV_CREATE) < 0) {
+        const int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/// the event node of the uinput device, or "" if there is none (yet)
+static std::string event_node(int fd)
+{
+#ifdef UI_GET_SYSNAME
+    char sysname[64];
+    if (ioctl(fd, UI_GET_SYSNAME(sizeof(sysname)), sysname) < 0)
+        return "";
+
+    const std::string dir = std::string("/sys/devices/virtual/input/") + sysname;
+    DIR* dp = opendir(dir.c_str());
+    if (dp == NULL)
+        return "";
+    std::string node;
+    while (dirent* ep = readdir(dp)) {
+        if (strncmp(ep->d_name, "event", strlen("event")) == 0)
+            node = std::string("/dev/input/") + ep->d_name;
+    }
+    closedir(dp);
+    if (!node.empty() && access(node.c_str(), R_OK) != 0)
+        return "";
+    return node;
+#else
+    (void) fd;
+    return "";
+#endif
+}
+
+static void send_event(int fd, int type, int code, int value)
+{
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    if (write(fd, &ev, sizeof(ev)) != sizeof(ev))
+        perror("uinput write");
+}
+
+/// tap at raw x, y, returns when the touch down was written
+static long tap(int fd, int x, int y)
+{
+    send_event(fd, EV_ABS, ABS_X, x);
+    send_event(fd, EV_ABS, ABS_Y, y);
+    send_event(fd, EV_KEY, BTN_TOUCH, 1);
+    send_event(fd, EV_SYN, SYN_REPORT, 0);
+    const long sent = now_us();
+    send_event(fd, EV_KEY, BTN_TOUCH, 0);
+    send_event(fd, EV_SYN, SYN_REPORT, 0);
+    return sent;
+}
+
+/// start the calibrator on 'node' with its latency trace on a pipe,
+/// returns its pid or -1
+static pid_t start_calibrator(const char* calibrator, const std::string& node,
+                              const char* fb, const char* geometry,
+                              const char* output, int& trace_fd)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return -1;
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        const int null = open("/dev/null", O_RDWR);
+        dup2(null, 0);
+        dup2(null, 1);
+        dup2(null, 2);
+        dup2(fds[1], 3);
+        close(fds[0]);
+        close(fds[1]);
+        execlp(calibrator, calibrator, "--device-node", node.c_str(),
+               "--fb", fb, "--fb-geometry", geometry, "--no-timeout",
+               "--output-filename", output, "--latency-trace", "/dev/fd/3",
+               (char*) NULL);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    trace_fd = fds[0];
+    return pid;
+}
+
+/// the value of 'option' in an xorg.conf.d snippet, or -1
+static int read_option(const char* filename, const char* option)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+        return -1;
+
+    const std::string key = std::string("\"") + option + "\"";
+    char line[MAX_LINE_LEN];
+    int value = -1;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        const char* p = strstr(line, key.c_str());
+        if (p != NULL)
+            sscanf(p + key.size(), " \"%d\"", &value);
+    }
+    fclose(f);
+    return value;
+}
+
+/// median and maximum of samples in us, as ms
+static void print_stage(const char* name, std::vector<long> v)
+{
+    if (v.empty()) {
+        printf("%-12s %5d\n", name, 0);
+        return;
+    }
+    std::sort(v.begin(), v.end());
+    printf("%-12s %5d %8.3f %8.3f\n", name, (int) v.size(),
+           v[v.size()/2] / 1000.0, v[v.size()-1] / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 10;
+    const char* calibrator = "xinput_calibrator_fb";
+    const char* geometry = "800x480";
+    int panel[4] = {200, 3900, 300, 3800};
+    int timeout = 5000;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("--runs", argv[i]) == 0 && argc > i+1) {
+            runs = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--calibrator", argv[i]) == 0 && argc > i+1) {
+            calibrator = argv[++i];
+        } else
+
+        if (strcmp("--geometry", argv[i]) == 0 && argc > i+1) {
+            geometry = argv[++i];
+        } else
+
+        if (strcmp("--panel", argv[i]) == 0 && argc > i+4) {
+            for (int j = 0; j != 4; j++)
+                panel[j] = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--timeout", argv[i]) == 0 && argc > i+1) {
+            timeout = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Error: unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    int width, height;
+    if (runs < 1 || sscanf(geometry, "%dx%d", &width, &height) != 2 ||
+        width <= 0 || height <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const int fd = create_device();
+    if (fd < 0) {
+        fprintf(stderr, "Error: can't create uinput device: %s\n", strerror(errno));
+        return 1;
+    }
+    std::string node;
+    for (int tries = 0; tries != 100 && node.empty(); tries++) {
+        usleep(20000);
+        node = event_node(fd);
+    }
+    if (node.empty()) {
+        fprintf(stderr, "Error: no readable event node for the uinput device\n");
+        ioctl(fd, UI_DEV_DESTROY);
+        close(fd);
+        return 1;
+    }
+
+    // the targets, as GuiSession places them, and where the panel reports them
+    int X[NUM_POINTS], Y[NUM_POINTS];
+    for (int i = 0; i != NUM_POINTS; i++)
+        get_calibration_target(i, width, height, X[i], Y[i]);
+
+    // 2 pixels of the panel, in device units
+    const int tolerance_x = 2 * (panel[1] - panel[0]) / width + 1;
+    const int tolerance_y = 2 * (panel[3] - panel[2]) / height + 1;
+
+    char fb_file[] = "/tmp/xinput_calibrator_fb_XXXXXX";
+    char output_file[] = "/tmp/xinput_calibrator_fb_conf_XXXXXX";
+    const int fb_fd = mkstemp(fb_file);
+    const int output_fd = mkstemp(output_file);
+    if (fb_fd < 0 || output_fd < 0) {
+        fprintf(stderr, "Error: can't create temporary files\n");
+        ioctl(fd, UI_DEV_DESTROY);
+        close(fd);
+        return 1;
+    }
+    close(fb_fd);
+    close(output_fd);
+
+    std::vector<long> first_frame, taps, finish;
+    int failed = 0;
+    for (int run = 0; run != runs; run++) {
+        truncate(output_file, 0);
+
+        int trace_fd;
+        const long started = now_us();
+        const pid_t pid = start_calibrator(calibrator, node, fb_file, geometry,
+                                           output_file, trace_fd);
+        if (pid < 0) {
+            fprintf(stderr, "Error: can't start %s\n", calibrator);
+            failed++;
+            break;
+        }
+        TraceReader trace(trace_fd, timeout);
+
+        bool ok = true;
+        long usec;
+        if (trace.wait_for("redraw", usec)) {
+            first_frame.push_back(usec - started);
+        } else {
+            ok = false;
+        }
+
+        long sent = 0;
+        for (int i = 0; ok && i != NUM_POINTS; i++) {
+            const int x = panel[0] + (long) X[i] * (panel[1] - panel[0]) / (width - 1);
+            const int y = panel[2] + (long) Y[i] * (panel[3] - panel[2]) / (height - 1);
+            sent = tap(fd, x, y);
+            // the last tap applies the calibration and exits
+            if (i == NUM_POINTS - 1)
+                ok = trace.wait_for("finish", usec);
+            else if ((ok = trace.wait_for("receipt", usec) && trace.wait_for("redraw", usec)))
+                taps.push_back(usec - sent);
+        }
+        if (ok)
+            finish.push_back(usec - sent);
+        close(trace_fd);
+
+        int status;
+        if (!ok)
+            kill(pid, SIGTERM);
+        waitpid(pid, &status, 0);
+
+        const int got[4] = {read_option(output_file, "MinX"), read_option(output_file, "MaxX"),
+                            read_option(output_file, "MinY"), read_option(output_file, "MaxY")};
+        for (int j = 0; ok && j != 4; j++) {
+            const int tolerance = j < 2 ? tolerance_x : tolerance_y;
+            if (got[j] < panel[j] - tolerance || got[j] > panel[j] + tolerance)
+                ok = false;
+        }
+        if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Error: run %d: calibrated to %d %d %d %d instead of %d %d %d %d\n",
+                    run, got[0], got[1], got[2], got[3], panel[0], panel[1], panel[2], panel[3]);
+            failed++;
+        }
+    }
+
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+    unlink(fb_file);
+    unlink(output_file);
+
+    printf("# %d runs on %s, %s, %d failed; median and max in ms\n",
+           runs, node.c_str(), geometry, failed);
+    print_stage("first_frame", first_frame);
+    print_stage("tap", taps);
+    print_stage("finish", finish);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2009 Tias Guns
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "calibrator.hh"
+#include "gui/gui_common.hpp"
+
+#ifdef GUI_MODULE_DIR
+#include <dlfcn.h>
+#include <string>
+
+// the GUI modules tried in turn, unless XINPUT_CALIBRATOR_GUI names one
+static const char* gui_modules[] = {"gtkmm", "x11", NULL};
+
+/// dlopen the GUI module 'name' from GUI_MODULE_DIR, or the module at
+/// path 'name'; NULL and the reason in 'errors' if it can't be loaded
+static GuiRunFunc load_gui(const char* name, std::string& errors)
+{
+    std::string path = name;
+    if (path.find('/') == std::string::npos)
+        path = std::string(GUI_MODULE_DIR) + "/gui_" + name + ".so";
+
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        errors += std::string("\t") + dlerror() + "\n";
+        return NULL;
+    }
+
+    // a function pointer can't be cast from void* in ISO C++
+    union {
+        void* symbol;
+        GuiRunFunc run;
+    } entry;
+    entry.symbol = dlsym(handle, GUI_RUN_SYMBOL);
+    if (entry.symbol == NULL) {
+        errors += "\t" + path + ": not a GUI module\n";
+        dlclose(handle);
+        return NULL;
+    }
+    return entry.run;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    Calibrator* calibrator = Calibrator::make_calibrator(argc, argv);
+
+#ifdef GUI_MODULE_DIR
+    GuiRunFunc run = NULL;
+    std::string errors;
+    const char* gui = getenv("XINPUT_CALIBRATOR_GUI");
+    if (gui != NULL) {
+        run = load_gui(gui, errors);
+    } else {
+        for (int i = 0; run == NULL && gui_modules[i] != NULL; i++)
+            run = load_gui(gui_modules[i], errors);
+    }
+    if (run == NULL) {
+        fprintf(stderr, "Error: unable to load a GUI module:\n%s", errors.c_str());
+        delete calibrator;
+        return 1;
+    }
+#else
+    // the GUI is linked in
+    GuiRunFunc run = xinput_calibrator_gui_run;
+#endif
+
+    const int ret = run(calibrator, argc, argv);
+    delete calibrator;
+    return ret;
+}
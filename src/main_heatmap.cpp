@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "calibrator.hh"
+#include "calibrator/Tester.hpp"
+#include "calibrator/DriverEmulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/*
+ * Error of the driver emulations over the whole screen.
+ *
+ * For every pixel, the device reports the raw value that an exact (real
+ * valued) driver would map onto that pixel with the new axis; the error is
+ * where emulate_driver() puts it instead, so it shows the rounding and
+ * clamping of xf86ScaleAxis.
+ *
+ * The emulations handle X and Y independently (a swap only changes which raw
+ * value feeds which screen axis), so the error field is separable: every
+ * column and every row goes through emulate_driver() once, and the threads
+ * only combine both axes into the image and the statistics.
+ */
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [-j <threads>] [--screen <w>x<h>] [--device <minx> <maxx> <miny> <maxy>] --new <minx> <maxx> <miny> <maxy> [--swap] [--invert-x] [--invert-y] [--output <prefix>] [--pgm]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t-j: number of threads (default: number of processors)\n");
+    fprintf(stderr, "\t--screen: screen resolution (default: 800x600)\n");
+    fprintf(stderr, "\t--device: device range (default: 0 1000 0 1000)\n");
+    fprintf(stderr, "\t--new: the new calibration, with --swap, --invert-x and --invert-y\n");
+    fprintf(stderr, "\t--output: write <prefix>-generic.ppm and <prefix>-evdev.ppm (default: heatmap)\n");
+    fprintf(stderr, "\t--pgm: write the error magnitude as grayscale .pgm instead\n");
+    fprintf(stderr, "In the .ppm, red is the X error, green the Y error (full scale: the maximal error)\n");
+    fprintf(stderr, "and blue marks pixels whose raw value falls outside the device range.\n");
+}
+
+/// per screen column (axis 0) or row (axis 1): the error, and whether it was clamped
+struct AxisError {
+    std::vector<float> error;
+    std::vector<unsigned char> clamped;
+};
+
+/// raw value that an exact driver maps onto screen coordinate p of axis i,
+/// and the slot (raw axis) the device reports it on
+static int ideal_raw(float p, int i, const XYinfo& axys, const XYinfo& screen,
+                     const XYinfo& device, bool evdev, int& slot, bool& clamped)
+{
+    const AxisInfo& s = i == 0 ? screen.x : screen.y;
+    const AxisInfo& d = i == 0 ? device.x : device.y;
+    const AxisInfo& c = i == 0 ? axys.x : axys.y;
+
+    float v = scaleAxis(p, d.max, d.min, s.max, s.min);
+    if (evdev && c.invert)
+        v = d.max - v + d.min;
+    v = scaleAxis(v, c.max, c.min, d.max, d.min);
+
+    slot = axys.swap_xy ? 1 - i : i;
+    if (evdev && axys.swap_xy) {
+        // evdev rescales a swapped value from the range of its raw axis
+        const AxisInfo& r = slot == 0 ? device.x : device.y;
+        v = scaleAxis(v, r.max, r.min, d.max, d.min);
+    }
+
+    const AxisInfo& r = slot == 0 ? device.x : device.y;
+    const int lo = std::min(r.min, r.max), hi = std::max(r.min, r.max);
+    int raw = (int) floor(v + 0.5);
+    clamped = (raw < lo || raw > hi);
+    return std::max(lo, std::min(hi, raw));
+}
+
+static void sweep_axes(CalibratorTesterInterface& calib, const XYinfo& axys,
+                       const XYinfo& screen, const XYinfo& device, bool evdev,
+                       int width, int height, AxisError err[2])
+{
+    const int size[2] = {width, height};
+    err[0].error.resize(width);  err[0].clamped.resize(width);
+    err[1].error.resize(height); err[1].clamped.resize(height);
+
+    // both axes in one emulate_driver() call, two pixels per call (min and max)
+    const int n = std::max(width, height);
+    for (int k = 0; k < n; k += 2) {
+        int vals[2][2] = {{0, 0}, {0, 0}};  // [raw slot][min/max]
+        bool clamped[2][2] = {{false, false}, {false, false}};
+        for (int i = 0; i != 2; i++) {
+            for (int m = 0; m != 2; m++) {
+                const int p = std::min(k + m, size[i] - 1);
+                int slot;
+                const int raw = ideal_raw(p, i, axys, screen, device, evdev, slot, clamped[i][m]);
+                vals[slot][m] = raw;
+            }
+        }
+
+        const XYinfo raw(vals[0][0], vals[0][1], vals[1][0], vals[1][1]);
+        const XYinfo result = calib.emulate_driver(raw, true, screen, device);
+        const int res[2][2] = {{result.x.min, result.x.max}, {result.y.min, result.y.max}};
+
+        for (int i = 0; i != 2; i++) {
+            for (int m = 0; m != 2; m++) {
+                const int p = k + m;
+                if (p >= size[i])
+                    continue;
+                err[i].error[p] = res[i][m] - p;
+                err[i].clamped[p] = clamped[i][m];
+            }
+        }
+    }
+}
+
+/// the combined image, and its statistics
+struct Heatmap {
+    const AxisError* err;
+    int width, height;
+    bool pgm;
+    float scale;
+    std::vector<unsigned char> pixels;
+
+    /// next row, shared by the workers
+    int next;
+    pthread_mutex_t lock;
+    double sum, sum2, max;
+    unsigned long over_half, over_one, clamped;
+};
+
+static const int rows_per_job = 16;
+
+static void* compose(void* arg)
+{
+    Heatmap& h = *(Heatmap*)arg;
+    const float* ex = &h.err[0].error[0];
+    const unsigned char* cx = &h.err[0].clamped[0];
+    const int channels = h.pgm ? 1 : 3;
+    const float to_byte = h.scale > 0 ? 255 / h.scale : 0;
+    std::vector<float> mag(h.width);
+
+    double sum = 0, sum2 = 0, max = 0;
+    unsigned long over_half = 0, over_one = 0, clamped = 0;
+    for (;;) {
+        const int first = __sync_fetch_and_add(&h.next, rows_per_job);
+        if (first >= h.height)
+            break;
+        const int last = std::min(first + rows_per_job, h.height);
+
+        for (int y = first; y != last; y++) {
+            const float ey = h.err[1].error[y];
+            const bool cy = h.err[1].clamped[y];
+
+            // straight array arithmetic, for the vectorizer
+            for (int x = 0; x < h.width; x++)
+                mag[x] = sqrtf(ex[x]*ex[x] + ey*ey);
+
+            unsigned char* out = &h.pixels[(size_t)y * h.width * channels];
+            for (int x = 0; x < h.width; x++) {
+                const float m = mag[x];
+                sum += m;
+                sum2 += m*m;
+                if (m > max)
+                    max = m;
+                over_half += (m > 0.5f);
+                over_one += (m >= 1.0f);
+                clamped += (cx[x] || cy);
+
+                if (h.pgm) {
+                    out[x] = (unsigned char) std::min(255.0f, m * to_byte);
+                } else {
+                    out[3*x]     = (unsigned char) std::min(255.0f, fabsf(ex[x]) * to_byte);
+                    out[3*x + 1] = (unsigned char) std::min(255.0f, fabsf(ey) * to_byte);
+                    out[3*x + 2] = (cx[x] || cy) ? 255 : 0;
+                }
+            }
+        }
+    }
+
+    pthread_mutex_lock(&h.lock);
+    h.sum += sum;
+    h.sum2 += sum2;
+    h.max = std::max(h.max, max);
+    h.over_half += over_half;
+    h.over_one += over_one;
+    h.clamped += clamped;
+    pthread_mutex_unlock(&h.lock);
+    return NULL;
+}
+
+static bool write_image(const std::string& filename, const Heatmap& h)
+{
+    FILE* fid = fopen(filename.c_str(), "wb");
+    if (fid == NULL) {
+        fprintf(stderr, "Error: Can't open '%s' for writing.\n", filename.c_str());
+        return false;
+    }
+    fprintf(fid, "%s\n%i %i\n255\n", h.pgm ? "P5" : "P6", h.width, h.height);
+    bool ok = (fwrite(&h.pixels[0], h.pixels.size(), 1, fid) == 1);
+    ok &= (fclose(fid) == 0);
+    if (!ok)
+        fprintf(stderr, "Error: failed writing '%s'\n", filename.c_str());
+    return ok;
+}
+
+static bool heatmap(const char* name, CalibratorTesterInterface& calib, bool evdev,
+                    const XYinfo& axys, const XYinfo& screen, const XYinfo& device,
+                    int width, int height, long threads, bool pgm, const std::string& prefix)
+{
+    AxisError err[2];
+    sweep_axes(calib, axys, screen, device, evdev, width, height, err);
+
+    // full scale of the image: the largest error
+    float ex_max = 0, ey_max = 0;
+    for (int x = 0; x != width; x++)
+        ex_max = std::max(ex_max, fabsf(err[0].error[x]));
+    for (int y = 0; y != height; y++)
+        ey_max = std::max(ey_max, fabsf(err[1].error[y]));
+
+    Heatmap h;
+    h.err = err;
+    h.width = width;
+    h.height = height;
+    h.pgm = pgm;
+    h.scale = pgm ? sqrtf(ex_max*ex_max + ey_max*ey_max) : std::max(ex_max, ey_max);
+    h.pixels.resize((size_t)width * height * (pgm ? 1 : 3));
+    h.next = 0;
+    pthread_mutex_init(&h.lock, NULL);
+    h.sum = h.sum2 = h.max = 0;
+    h.over_half = h.over_one = h.clamped = 0;
+
+    std::vector<pthread_t> pool(threads);
+    for (long t = 0; t != threads; t++)
+        pthread_create(&pool[t], NULL, compose, &h);
+    for (long t = 0; t != threads; t++)
+        pthread_join(pool[t], NULL);
+    pthread_mutex_destroy(&h.lock);
+
+    const double n = (double)width * height;
+    printf("%-8s mean=%.3f rms=%.3f max=%.3f (x: %.0f, y: %.0f) >0.5px=%.2f%% >=1px=%.2f%% clamped=%.2f%%\n",
+           name, h.sum / n, sqrt(h.sum2 / n), h.max, ex_max, ey_max,
+           100 * h.over_half / n, 100 * h.over_one / n, 100 * h.clamped / n);
+
+    return write_image(prefix + "-" + name + (pgm ? ".pgm" : ".ppm"), h);
+}
+
+static bool parse_axys(char** argv, int& i, int argc, XYinfo& axys)
+{
+    if (argc <= i+4)
+        return false;
+    axys.x.min = atoi(argv[++i]);
+    axys.x.max = atoi(argv[++i]);
+    axys.y.min = atoi(argv[++i]);
+    axys.y.max = atoi(argv[++i]);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int width = 800, height = 600;
+    XYinfo device(0, 1000, 0, 1000);
+    bool has_new = false;
+    XYinfo new_axys;
+    std::string prefix = "heatmap";
+    bool pgm = false;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("-j", argv[i]) == 0 && argc > i+1) {
+            threads = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--screen", argv[i]) == 0 && argc > i+1 &&
+            sscanf(argv[i+1], "%dx%d", &width, &height) == 2) {
+            i++;
+        } else
+
+        if (strcmp("--device", argv[i]) == 0 && parse_axys(argv, i, argc, device)) {
+        } else
+
+        if (strcmp("--new", argv[i]) == 0 && parse_axys(argv, i, argc, new_axys)) {
+            has_new = true;
+        } else
+
+        if (strcmp("--swap", argv[i]) == 0) {
+            new_axys.swap_xy = true;
+        } else
+
+        if (strcmp("--invert-x", argv[i]) == 0) {
+            new_axys.x.invert = true;
+        } else
+
+        if (strcmp("--invert-y", argv[i]) == 0) {
+            new_axys.y.invert = true;
+        } else
+
+        if (strcmp("--output", argv[i]) == 0 && argc > i+1) {
+            prefix = argv[++i];
+        } else
+
+        if (strcmp("--pgm", argv[i]) == 0) {
+            pgm = true;
+        } else {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!has_new || width <= 1 || height <= 1 ||
+        device.x.min == device.x.max || device.y.min == device.y.max ||
+        new_axys.x.min == new_axys.x.max || new_axys.y.min == new_axys.y.max) {
+        fprintf(stderr, "Error: need --new, and non-empty screen, device and calibration ranges\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1)
+        threads = 1;
+
+    const XYinfo screen(0, width, 0, height);
+    printf("Screen %ix%i, device: ", width, height); device.print();
+    printf("New axis: "); new_axys.print();
+
+    // only the new calibration is applied, the old one does not matter
+    CalibratorTester generic("heatmap", device);
+    generic.finish_data(new_axys);
+    CalibratorDriverTester<Evdev270Driver> evdev("heatmap", device);
+    evdev.finish_data(new_axys);
+
+    bool ok = heatmap("generic", generic, false, new_axys, screen, device,
+                      width, height, threads, pgm, prefix);
+    ok &= heatmap("evdev", evdev, true, new_axys, screen, device,
+                  width, height, threads, pgm, prefix);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "guibench.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*
+ * Tap-to-feedback latency benchmark.
+ *
+ * Starts the calibrator GUI (x11 or gtkmm, whichever it was built with)
+ * with --fake --no-timeout --latency-trace, taps the four targets with
+ * XTest and matches the injection times with the trace of the GUI:
+ *   tap     when the button press was sent to the server
+ *   receipt when the GUI handles the button press
+ *   redraw  when the server has drawn the clicked target (XSync)
+ *   finish  when finish_data() returned, after the fourth tap
+ * All on CLOCK_MONOTONIC. Run it in an Xvfb with nothing else on it,
+ * see xinput_calibrator_latency.sh.
+ */
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [--runs <n>] [--calibrator <path>] [--timeout <ms>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t--runs: calibration sessions to run (default: 25)\n");
+    fprintf(stderr, "\t--calibrator: the xinput_calibrator to benchmark (default: xinput_calibrator)\n");
+    fprintf(stderr, "\t--timeout: give up when the GUI is silent for that long (default: 5000)\n");
+}
+
+/// latencies of one stage over all runs, in us
+struct Stage
+{
+    const char* name;
+    std::vector<long> samples;
+
+    explicit Stage(const char* name0)
+      : name(name0) {}
+
+    void print(FILE* out) const
+    {
+        if (samples.empty()) {
+            fprintf(out, "%-18s %5d\n", name, 0);
+            return;
+        }
+        std::vector<long> v(samples);
+        std::sort(v.begin(), v.end());
+        const size_t n = v.size();
+        fprintf(out, "%-18s %5d %8ld %8ld %8ld %8ld %8ld\n", name, (int) n,
+                v[0], v[n/2], v[(n*9)/10], v[(n*99)/100], v[n-1]);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    int runs = 25;
+    int timeout = 5000;
+    const char* calibrator = "xinput_calibrator";
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("--runs", argv[i]) == 0 && argc > i+1) {
+            runs = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--calibrator", argv[i]) == 0 && argc > i+1) {
+            calibrator = argv[++i];
+        } else
+
+        if (strcmp("--timeout", argv[i]) == 0 && argc > i+1) {
+            timeout = atoi(argv[++i]);
+        }
+
+        else {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (runs < 1 || timeout < 1) {
+        fprintf(stderr, "Error: --runs and --timeout need a positive number\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    Display* display = XOpenDisplay(NULL);
+    if (display == NULL) {
+        fprintf(stderr, "Unable to connect to X server\n");
+        return 1;
+    }
+    int event_base, error_base, major, minor;
+    if (!XTestQueryExtension(display, &event_base, &error_base, &major, &minor)) {
+        fprintf(stderr, "Error: the X server has no XTest extension\n");
+        return 1;
+    }
+
+    int width, height;
+    int X[NUM_POINTS], Y[NUM_POINTS];
+    screen_targets(display, width, height, X, Y);
+
+    Stage tap_receipt("tap->receipt");
+    Stage receipt_redraw("receipt->redraw");
+    Stage tap_redraw("tap->redraw");
+    Stage receipt_finish("receipt->finish");
+    Stage tap_finish("tap->finish");
+
+    for (int r = 0; r != runs; r++) {
+        int trace_fd;
+        const pid_t pid = start_gui(calibrator, false, trace_fd);
+        if (pid < 0) {
+            fprintf(stderr, "Error: can't start '%s': %s\n", calibrator, strerror(errno));
+            return 1;
+        }
+        TraceReader trace(trace_fd, timeout);
+
+        // the first redraw: the window is mapped and grabbed the pointer
+        long t_redraw, t_receipt, t_finish;
+        bool ok = trace.wait_for("redraw", t_redraw);
+        for (int i = 0; ok && i != NUM_POINTS; i++) {
+            const long t_tap = tap(display, X[i], Y[i]);
+            ok = trace.wait_for("receipt", t_receipt);
+            if (!ok)
+                break;
+            tap_receipt.samples.push_back(t_receipt - t_tap);
+
+            if (i != NUM_POINTS - 1) {
+                ok = trace.wait_for("redraw", t_redraw);
+                if (ok) {
+                    receipt_redraw.samples.push_back(t_redraw - t_receipt);
+                    tap_redraw.samples.push_back(t_redraw - t_tap);
+                }
+            } else {
+                ok = trace.wait_for("finish", t_finish);
+                if (ok) {
+                    receipt_finish.samples.push_back(t_finish - t_receipt);
+                    tap_finish.samples.push_back(t_finish - t_tap);
+                }
+            }
+        }
+        close(trace_fd);
+
+        if (!ok)
+            kill(pid, SIGTERM);
+        int status;
+        waitpid(pid, &status, 0);
+        if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Error: run %d of '%s' failed\n", r, calibrator);
+            return 1;
+        }
+    }
+
+    printf("# %s, %d runs, %dx%d (us)\n", calibrator, runs, width, height);
+    printf("# %-16s %5s %8s %8s %8s %8s %8s\n", "stage", "n", "min", "p50", "p90", "p99", "max");
+    tap_receipt.print(stdout);
+    receipt_redraw.print(stdout);
+    tap_redraw.print(stdout);
+    receipt_finish.print(stdout);
+    tap_finish.print(stdout);
+
+    XCloseDisplay(display);
+    return 0;
+}
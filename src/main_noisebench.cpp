@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "solver.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Monte Carlo accuracy of the calibration routines under noisy clicks.
+ *
+ * Every trial draws a random calibration and clicks its targets with the
+ * configured noise, solves it and measures where touches at the center and
+ * at the edges of the screen end up. Trial i always uses the same seed,
+ * whatever the number of threads.
+ */
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [-j <threads>] [--trials <n>] [--seed <n>] [--jitter <px>] [--bias <x> <y>] [--quantization <px>] [--outliers <rate> <px>] [--solver <name>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t-j: number of threads (default: number of processors)\n");
+    fprintf(stderr, "\t--trials: number of trials per solver (default: 1000000)\n");
+    fprintf(stderr, "\t--seed: base seed (default: 1)\n");
+    fprintf(stderr, "\t--jitter: standard deviation of the Gaussian click jitter (default: 2 pixels)\n");
+    fprintf(stderr, "\t--bias: constant click offset (default: 0 0)\n");
+    fprintf(stderr, "\t--quantization: device resolution, in pixels (default: 0, off)\n");
+    fprintf(stderr, "\t--outliers: probability of a gross outlier click, and its maximal size (default: 0 0)\n");
+    fprintf(stderr, "\t--solver: only run the given solver (may be repeated, default: generic and evdev)\n");
+}
+
+/// 0.01 px bins up to 1000 px, everything above in the last one
+class ErrorHistogram
+{
+public:
+    ErrorHistogram() : counts(num_bins, 0), total(0), max(0) {}
+
+    void add(double error)
+    {
+        counts[std::min((int)(error * bins_per_px), num_bins - 1)]++;
+        total++;
+        max = std::max(max, error);
+    }
+
+    void merge(const ErrorHistogram& other)
+    {
+        for (int i = 0; i != num_bins; i++)
+            counts[i] += other.counts[i];
+        total += other.total;
+        max = std::max(max, other.max);
+    }
+
+    /// upper bound of the bin holding the given fraction of the samples
+    double percentile(double fraction) const
+    {
+        const unsigned long wanted = (unsigned long)(fraction * total);
+        unsigned long seen = 0;
+        for (int i = 0; i != num_bins - 1; i++) {
+            seen += counts[i];
+            if (seen > wanted)
+                return std::min((i + 1) / (double)bins_per_px, max);
+        }
+        return max;
+    }
+
+    unsigned long get_total() const
+    { return total; }
+    double get_max() const
+    { return max; }
+
+private:
+    static const int bins_per_px = 100;
+    static const int num_bins = 1000 * bins_per_px + 1;
+
+    std::vector<unsigned long> counts;
+    unsigned long total;
+    double max;
+};
+
+/// per solver: the error at the center, and the worst along the edges
+struct SolverStats {
+    ErrorHistogram center, edge;
+    unsigned long failed;
+
+    SolverStats() : failed(0) {}
+
+    void merge(const SolverStats& other)
+    {
+        center.merge(other.center);
+        edge.merge(other.edge);
+        failed += other.failed;
+    }
+};
+
+struct Bench {
+    std::vector<const CalibrationSolver*> solvers;
+    NoiseModel noise;
+    uint64_t seed;
+    unsigned long trials;
+    /// next chunk of trials, shared by the workers
+    unsigned long next;
+    pthread_mutex_t lock;
+    std::vector<SolverStats> stats;
+};
+
+static const unsigned long chunk = 1024;
+
+static void* worker(void* arg)
+{
+    Bench& b = *(Bench*)arg;
+    std::vector<SolverStats> stats(b.solvers.size());
+
+    for (;;) {
+        const unsigned long first = __sync_fetch_and_add(&b.next, chunk);
+        if (first >= b.trials)
+            break;
+        const unsigned long last = std::min(first + chunk, b.trials);
+
+        for (unsigned long trial = first; trial != last; trial++) {
+            // a seed per trial: independent of the scheduling
+            SplitMix64 seeder(b.seed ^ (trial * 0x9E3779B9UL));
+            SplitMix64 rng(seeder.next());
+            ClickSet set;
+            make_synthetic_set(rng, b.noise, set);
+
+            const float w = set.width - 1, h = set.height - 1;
+            const float edge_x[] = {0, w/2, w, w, w, w/2, 0, 0};
+            const float edge_y[] = {0, 0, 0, h/2, h, h, h, h/2};
+
+            for (unsigned v = 0; v != b.solvers.size(); v++) {
+                XYinfo solved;
+                double center;
+                if (!b.solvers[v]->supports(set))
+                    continue;
+                if (!b.solvers[v]->solve(set, solved) ||
+                    !point_error(set, solved, w/2, h/2, center)) {
+                    stats[v].failed++;
+                    continue;
+                }
+                double worst = 0;
+                for (int e = 0; e != 8; e++) {
+                    double error;
+                    point_error(set, solved, edge_x[e], edge_y[e], error);
+                    worst = std::max(worst, error);
+                }
+                stats[v].center.add(center);
+                stats[v].edge.add(worst);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&b.lock);
+    for (unsigned v = 0; v != stats.size(); v++)
+        b.stats[v].merge(stats[v]);
+    pthread_mutex_unlock(&b.lock);
+    return NULL;
+}
+
+static void print_row(const char* solver, const char* where, const ErrorHistogram& h)
+{
+    printf("%-10s %-7s %10.2f %10.2f %10.2f %10.2f %10.2f\n", solver, where,
+           h.percentile(0.5), h.percentile(0.9), h.percentile(0.99),
+           h.percentile(0.999), h.get_max());
+}
+
+int main(int argc, char** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    Bench b;
+    b.noise = NoiseModel(2);
+    b.seed = 1;
+    b.trials = 1000000;
+    b.next = 0;
+    std::vector<std::string> only;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("-j", argv[i]) == 0 && argc > i+1) {
+            threads = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--trials", argv[i]) == 0 && argc > i+1) {
+            b.trials = strtoul(argv[++i], NULL, 0);
+        } else
+
+        if (strcmp("--seed", argv[i]) == 0 && argc > i+1) {
+            b.seed = strtoul(argv[++i], NULL, 0);
+        } else
+
+        if (strcmp("--jitter", argv[i]) == 0 && argc > i+1) {
+            b.noise.jitter = atof(argv[++i]);
+        } else
+
+        if (strcmp("--bias", argv[i]) == 0 && argc > i+2) {
+            b.noise.bias_x = atof(argv[++i]);
+            b.noise.bias_y = atof(argv[++i]);
+        } else
+
+        if (strcmp("--quantization", argv[i]) == 0 && argc > i+1) {
+            b.noise.quantization = atof(argv[++i]);
+        } else
+
+        if (strcmp("--outliers", argv[i]) == 0 && argc > i+2) {
+            b.noise.outlier_rate = atof(argv[++i]);
+            b.noise.outlier_size = atof(argv[++i]);
+        } else
+
+        if (strcmp("--solver", argv[i]) == 0 && argc > i+1) {
+            only.push_back(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+    if (only.empty()) {
+        only.push_back("generic");
+        only.push_back("evdev");
+    }
+
+    const std::vector<const CalibrationSolver*>& solvers = get_solvers();
+    for (unsigned i = 0; i != solvers.size(); i++) {
+        if (std::find(only.begin(), only.end(), solvers[i]->name()) != only.end())
+            b.solvers.push_back(solvers[i]);
+    }
+    if (b.solvers.empty()) {
+        fprintf(stderr, "Error: unknown solver.\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+    b.stats.resize(b.solvers.size());
+    pthread_mutex_init(&b.lock, NULL);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    std::vector<pthread_t> pool(threads);
+    for (long t = 0; t != threads; t++)
+        pthread_create(&pool[t], NULL, worker, &b);
+    for (long t = 0; t != threads; t++)
+        pthread_join(pool[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%lu trials, %li threads, %.3f s; jitter=%.2f bias=%.2f,%.2f quantization=%.2f outliers=%.4f/%.1f\n",
+           b.trials, threads, secs, b.noise.jitter, b.noise.bias_x, b.noise.bias_y,
+           b.noise.quantization, b.noise.outlier_rate, b.noise.outlier_size);
+    printf("%-10s %-7s %10s %10s %10s %10s %10s\n",
+           "solver", "where", "p50_px", "p90_px", "p99_px", "p99.9_px", "max_px");
+    for (unsigned v = 0; v != b.solvers.size(); v++) {
+        print_row(b.solvers[v]->name(), "center", b.stats[v].center);
+        print_row(b.solvers[v]->name(), "edge", b.stats[v].edge);
+        if (b.stats[v].failed)
+            printf("%-10s %lu failed\n", b.solvers[v]->name(), b.stats[v].failed);
+    }
+
+    return 0;
+}
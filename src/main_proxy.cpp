@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "proxy.hh"
+
+#include <cstring>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [-v|--verbose] --device-node <path> [--calibration <minx> <maxx> <miny> <maxy>] [--swap] [--invert-x] [--invert-y] [--matrix <a> <b> <c> <d> <e> <f>] [--correction <file>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t-v, --verbose: print debug messages\n");
+    fprintf(stderr, "\t--device-node: the event node of the touchscreen (eg. /dev/input/event5)\n");
+    fprintf(stderr, "\t--calibration: the calibrated MinX/MaxX/MinY/MaxY, as output by xinput_calibrator\n");
+    fprintf(stderr, "\t--swap, --invert-x, --invert-y: swap or invert the axes, as SwapAxes/InvertX/InvertY\n");
+    fprintf(stderr, "\t--matrix: apply the first two rows of a coordinate transformation matrix instead\n");
+    fprintf(stderr, "\t--correction: then correct the remaining error with the grid written by xinput_calibrator --correction-output\n");
+    fprintf(stderr, "Send SIGUSR1 to print the latency histogram, it is printed on exit too.\n");
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    const char* node = NULL;
+    bool calibration = false;
+    XYinfo axys;
+    bool matrix = false;
+    float m[6];
+    const char* correction = NULL;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("-v", argv[i]) == 0 ||
+            strcmp("--verbose", argv[i]) == 0) {
+            verbose = true;
+        } else
+
+        if (strcmp("--device-node", argv[i]) == 0 && argc > i+1) {
+            node = argv[++i];
+        } else
+
+        if (strcmp("--calibration", argv[i]) == 0 && argc > i+4) {
+            calibration = true;
+            axys.x.min = atoi(argv[++i]);
+            axys.x.max = atoi(argv[++i]);
+            axys.y.min = atoi(argv[++i]);
+            axys.y.max = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--swap", argv[i]) == 0) {
+            axys.swap_xy = true;
+        } else
+
+        if (strcmp("--invert-x", argv[i]) == 0) {
+            axys.x.invert = true;
+        } else
+
+        if (strcmp("--invert-y", argv[i]) == 0) {
+            axys.y.invert = true;
+        } else
+
+        if (strcmp("--matrix", argv[i]) == 0 && argc > i+6) {
+            matrix = true;
+            for (int j = 0; j != 6; j++)
+                m[j] = atof(argv[++i]);
+        } else
+
+        if (strcmp("--correction", argv[i]) == 0 && argc > i+1) {
+            correction = argv[++i];
+        } else {
+            fprintf(stderr, "Error: unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (node == NULL || (calibration && matrix)) {
+        fprintf(stderr, "Error: need a --device-node, and at most one of --calibration and --matrix\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        UinputProxy proxy(node, verbose);
+
+        if (matrix)
+            proxy.set_matrix(m);
+        else if (calibration || axys.swap_xy || axys.x.invert || axys.y.invert) {
+            if (!calibration) {
+                // only swap/invert, keep the device range
+                axys.x.min = axys.y.min = 0;
+                axys.x.max = axys.y.max = 0;
+            }
+            proxy.set_calibration(axys);
+        }
+        if (correction != NULL && !proxy.set_correction(correction))
+            return 1;
+
+        const bool ok = proxy.run();
+        proxy.get_histogram().print(stdout);
+        return ok ? 0 : 1;
+    } catch (std::runtime_error& ex) {
+        fprintf(stderr, "Error: %s\n", ex.what());
+        return 1;
+    }
+}
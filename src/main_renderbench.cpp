@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "guibench.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*
+ * Render throughput benchmark.
+ *
+ * Starts the calibrator GUI (x11 or gtkmm) with --fake --latency-trace
+ * and drives it through back to back cycles of one kind:
+ *   expose  a full screen window is mapped over it and unmapped again
+ *   tap     the first target is tapped with XTest (the first tap is
+ *           accepted, the others are ignored as double-clicks)
+ *   timer   the clock ticks, every 100 ms, with the timeout enabled
+ * and prints one line per kind for the current screen size:
+ *   WxH kind cycles cycles/s render_p50 render_p90 server_cpu client_cpu bytes
+ * Render times run from the handling of the event to the end of the
+ * redraw (XSync), in us. The CPU time of the X server (--server-pid,
+ * -1 without) and of the GUI in us, and the bytes the GUI wrote to the
+ * server, are per cycle. See xinput_calibrator_renderbench.sh.
+ */
+
+enum CycleKind { CYCLE_EXPOSE, CYCLE_TAP, CYCLE_TIMER, NUM_CYCLE_KINDS };
+static const char* cycle_names[NUM_CYCLE_KINDS] = {"expose", "tap", "timer"};
+
+// the GUI exits on its timeout after 150 clock ticks
+static const int max_timer_cycles = 100;
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [--cycles <n>] [--calibrator <path>] [--server-pid <pid>] [--timeout <ms>]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t--cycles: cycles of each kind (default: 200, at most %d timer cycles)\n", max_timer_cycles);
+    fprintf(stderr, "\t--calibrator: the xinput_calibrator to benchmark (default: xinput_calibrator)\n");
+    fprintf(stderr, "\t--server-pid: the process of the X server, to report its CPU time\n");
+    fprintf(stderr, "\t--timeout: give up when the GUI is silent for that long (default: 5000)\n");
+}
+
+/// CPU time (user and system) and bytes written of a process
+struct ProcStats
+{
+    long cpu_us;
+    unsigned long wchar;
+};
+
+static bool read_proc_stats(pid_t pid, ProcStats& stats)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+        return false;
+    char line[1024];
+    const bool has_line = fgets(line, sizeof(line), f) != NULL;
+    fclose(f);
+
+    // utime and stime are the 12th and 13th field after the command name
+    const char* p = has_line ? strrchr(line, ')') : NULL;
+    if (p == NULL)
+        return false;
+    unsigned long utime, stime;
+    if (sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+               &utime, &stime) != 2)
+        return false;
+    stats.cpu_us = (long) ((utime + stime) * (1000000.0 / sysconf(_SC_CLK_TCK)));
+
+    // not readable for the X server of another user, only needed for the GUI
+    stats.wchar = 0;
+    snprintf(path, sizeof(path), "/proc/%d/io", (int) pid);
+    f = fopen(path, "r");
+    if (f != NULL) {
+        while (fgets(line, sizeof(line), f) != NULL) {
+            if (sscanf(line, "wchar: %lu", &stats.wchar) == 1)
+                break;
+        }
+        fclose(f);
+    }
+    return true;
+}
+
+/// read one cycle from the trace: its first stage and the redraw ending it
+static bool next_cycle(TraceReader& trace, long& start, long& end)
+{
+    std::string stage;
+    long usec;
+    start = -1;
+    while (trace.next(stage, usec)) {
+        if (stage != "redraw") {
+            if (start < 0)
+                start = usec;
+        } else if (start >= 0) {
+            end = usec;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// run 'cycles' cycles of the given kind, print their line; false on failure
+static bool run_cycles(Display* display, CycleKind kind, const char* calibrator,
+                       int cycles, int timeout, pid_t server_pid)
+{
+    int width, height;
+    int X[NUM_POINTS], Y[NUM_POINTS];
+    screen_targets(display, width, height, X, Y);
+    if (kind == CYCLE_TIMER)
+        cycles = std::min(cycles, max_timer_cycles);
+
+    // mapped over the GUI and unmapped, to expose all of it
+    Window cover = None;
+    if (kind == CYCLE_EXPOSE) {
+        XSetWindowAttributes attributes;
+        attributes.override_redirect = True;
+        attributes.background_pixmap = None;
+        cover = XCreateWindow(display, DefaultRootWindow(display), 0, 0, width, height, 0,
+                              CopyFromParent, InputOutput, CopyFromParent,
+                              CWOverrideRedirect | CWBackPixmap, &attributes);
+    }
+
+    int trace_fd;
+    const pid_t pid = start_gui(calibrator, kind == CYCLE_TIMER, trace_fd);
+    if (pid < 0) {
+        fprintf(stderr, "Error: can't start '%s': %s\n", calibrator, strerror(errno));
+        return false;
+    }
+    TraceReader trace(trace_fd, timeout);
+
+    // the first redraw: the window is mapped
+    long t_redraw;
+    bool ok = trace.wait_for("redraw", t_redraw);
+
+    ProcStats gui0, gui1, server0, server1;
+    ok = ok && read_proc_stats(pid, gui0);
+    const bool has_server = server_pid > 0 && read_proc_stats(server_pid, server0);
+    const unsigned long trace0 = trace.get_bytes();
+    const long t_begin = now_us();
+
+    std::vector<long> render;
+    for (int c = 0; ok && c != cycles; c++) {
+        if (kind == CYCLE_EXPOSE) {
+            XMapRaised(display, cover);
+            XSync(display, False);
+            XUnmapWindow(display, cover);
+            XFlush(display);
+        } else if (kind == CYCLE_TAP) {
+            tap(display, X[UL], Y[UL]);
+        }
+
+        long start, end;
+        ok = next_cycle(trace, start, end);
+        if (ok)
+            render.push_back(end - start);
+    }
+
+    const long t_end = now_us();
+    ok = ok && read_proc_stats(pid, gui1);
+    const bool has_server1 = has_server && read_proc_stats(server_pid, server1);
+    const unsigned long trace_bytes = trace.get_bytes() - trace0;
+
+    kill(pid, SIGTERM);
+    close(trace_fd);
+    int status;
+    waitpid(pid, &status, 0);
+    if (cover != None)
+        XDestroyWindow(display, cover);
+    if (!ok) {
+        fprintf(stderr, "Error: %s cycles of '%s' failed\n", cycle_names[kind], calibrator);
+        return false;
+    }
+
+    std::sort(render.begin(), render.end());
+    const size_t n = render.size();
+    // the trace goes through the same write() calls as the X requests
+    const unsigned long bytes = gui1.wchar - gui0.wchar - trace_bytes;
+    printf("%dx%d %s %d %.1f %ld %ld %ld %ld %lu\n", width, height, cycle_names[kind],
+           (int) n, n * 1000000.0 / (t_end - t_begin), render[n/2], render[(n*9)/10],
+           has_server1 ? (server1.cpu_us - server0.cpu_us) / (long) n : -1L,
+           (gui1.cpu_us - gui0.cpu_us) / (long) n, bytes / n);
+    fflush(stdout);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int cycles = 200;
+    int timeout = 5000;
+    pid_t server_pid = 0;
+    const char* calibrator = "xinput_calibrator";
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("--cycles", argv[i]) == 0 && argc > i+1) {
+            cycles = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--calibrator", argv[i]) == 0 && argc > i+1) {
+            calibrator = argv[++i];
+        } else
+
+        if (strcmp("--server-pid", argv[i]) == 0 && argc > i+1) {
+            server_pid = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--timeout", argv[i]) == 0 && argc > i+1) {
+            timeout = atoi(argv[++i]);
+        }
+
+        else {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (cycles < 1 || timeout < 1) {
+        fprintf(stderr, "Error: --cycles and --timeout need a positive number\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    Display* display = XOpenDisplay(NULL);
+    if (display == NULL) {
+        fprintf(stderr, "Unable to connect to X server\n");
+        return 1;
+    }
+    int event_base, error_base, major, minor;
+    if (!XTestQueryExtension(display, &event_base, &error_base, &major, &minor)) {
+        fprintf(stderr, "Error: the X server has no XTest extension\n");
+        return 1;
+    }
+
+    printf("# %s: WxH kind cycles cycles/s render_p50 render_p90 server_cpu client_cpu bytes\n",
+           calibrator);
+    for (int kind = 0; kind != NUM_CYCLE_KINDS; kind++) {
+        if (!run_cycles(display, (CycleKind) kind, calibrator, cycles, timeout, server_pid))
+            return 1;
+    }
+
+    XCloseDisplay(display);
+    return 0;
+}
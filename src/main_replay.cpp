@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "calibrator.hh"
+#include "recording.hh"
+#include "calibrator/Tester.hpp"
+#include "calibrator/EvdevTester.hpp"
+
+#include <cstring>
+#include <stdio.h>
+#include <sys/time.h>
+
+/*
+ * Replay recorded sessions (xinput_calibrator --record) through the
+ * calibration code, headless and without waiting between the clicks,
+ * and report where the decisions or the new calibration differ.
+ * Every session is replayed with the calibration routine of the backend
+ * it was recorded with; usbtouchscreen has none of its own. A verification
+ * pass is replayed with its recorded threshold and grid.
+ */
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [-v|--verbose] <recording>...\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t-v, --verbose: print every session, not only the differing ones\n");
+}
+
+struct ReplayStats {
+    int sessions, clicks, verify_clicks, verifications, differing;
+};
+
+static bool same_axys(const XYinfo& a, const XYinfo& b)
+{
+    return a.x.min == b.x.min && a.x.max == b.x.max &&
+           a.y.min == b.y.min && a.y.max == b.y.max &&
+           a.swap_xy == b.swap_xy &&
+           a.x.invert == b.x.invert && a.y.invert == b.y.invert;
+}
+
+static void end_session(const char* file, int session, CalibratorBackend backend,
+                        bool differs, bool verbose, ReplayStats& stats)
+{
+    if (session == 0)
+        return;
+    stats.sessions++;
+    if (differs)
+        stats.differing++;
+    if (differs || verbose)
+        printf("%s: session %i (%s): %s\n", file, session, backend_names[backend],
+               differs ? "DIFFERS" : "OK");
+}
+
+static bool replay_file(const char* file, bool verbose, ReplayStats& stats)
+{
+    SessionReader reader;
+    if (!reader.open(file))
+        return false;
+
+    SessionRecord rec;
+    CalibratorBackend backend = BACKEND_GENERIC;
+    CalibratorTesterInterface* tester = NULL;
+    Calibrator* calib = NULL;
+    int session = 0;
+    bool differs = false;
+    bool finished = false;
+    int width = 0, height = 0;
+
+    while (reader.next(rec)) {
+        if (rec.type != REC_SESSION && tester == NULL) {
+            fprintf(stderr, "Error: '%s' does not start with a session.\n", file);
+            return false;
+        }
+
+        switch (rec.type) {
+            case REC_SESSION:
+                end_session(file, session, backend, differs, verbose, stats);
+                delete tester;
+                backend = rec.backend;
+                if (backend == BACKEND_EVDEV) {
+                    CalibratorEvdevTester* t = new CalibratorEvdevTester(rec.device.c_str(),
+                        rec.old_axys, rec.thr_misclick, rec.thr_doubleclick);
+                    tester = t;
+                    calib = t;
+                } else {
+                    CalibratorTester* t = new CalibratorTester(rec.device.c_str(),
+                        rec.old_axys, rec.thr_misclick, rec.thr_doubleclick);
+                    tester = t;
+                    calib = t;
+                }
+                session++;
+                differs = false;
+                break;
+
+            case REC_CLICK: {
+                stats.clicks++;
+                const bool added = tester->add_click(rec.x, rec.y);
+                const ClickDecision decision = added ? CLICK_ACCEPTED :
+                    (calib->get_numclicks() == 0 ? CLICK_MISCLICK : CLICK_DOUBLECLICK);
+                if (decision != rec.decision) {
+                    printf("%s: session %i: click (%i, %i) at %lu ms: decision %i, recorded %i\n",
+                           file, session, rec.x, rec.y, rec.time_ms, decision, rec.decision);
+                    differs = true;
+                }
+                break;
+            }
+
+            case REC_RESET:
+                calib->reset();
+                break;
+
+            case REC_FINISH:
+                width = rec.width;
+                height = rec.height;
+                finished = tester->finish(width, height);
+                break;
+
+            case REC_RESULT:
+                if (finished != rec.success ||
+                    (finished && !same_axys(calib->get_calibrated_axys(), rec.new_axys))) {
+                    printf("%s: session %i: result differs\n", file, session);
+                    printf("\trecorded: ");
+                    if (rec.success)
+                        rec.new_axys.print();
+                    else
+                        printf("failure\n");
+                    printf("\treplayed: ");
+                    if (finished)
+                        calib->get_calibrated_axys().print();
+                    else
+                        printf("failure\n");
+                    differs = true;
+                }
+                break;
+
+            case REC_VERIFY:
+                stats.verify_clicks++;
+                calib->add_verify_click(rec.x, rec.y);
+                break;
+
+            case REC_VERIFIED: {
+                stats.verifications++;
+                calib->set_threshold_verify(rec.threshold_verify);
+                calib->set_verify_grid(rec.verify_grid);
+                const bool passed = calib->verify(width, height);
+                if (passed != rec.success) {
+                    printf("%s: session %i: verification %s, recorded %s\n", file, session,
+                           passed ? "PASS" : "FAIL", rec.success ? "PASS" : "FAIL");
+                    differs = true;
+                }
+                break;
+            }
+        }
+    }
+    end_session(file, session, backend, differs, verbose, stats);
+    delete tester;
+
+    if (reader.is_corrupt()) {
+        fprintf(stderr, "Error: corrupt record in '%s'.\n", file);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    int first_file = argc;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("-v", argv[i]) == 0 ||
+            strcmp("--verbose", argv[i]) == 0) {
+            verbose = true;
+        } else
+
+        if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+
+    if (first_file == argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    ReplayStats stats = {0, 0, 0, 0, 0};
+    bool ok = true;
+    for (int i = first_file; i != argc; i++)
+        ok &= replay_file(argv[i], verbose, stats);
+
+    gettimeofday(&end, NULL);
+    const double secs = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    printf("Replayed %i sessions (%i clicks, %i verification clicks, %i verifications) in %.3f s, %i differing\n",
+           stats.sessions, stats.clicks, stats.verify_clicks, stats.verifications, secs, stats.differing);
+
+    return (ok && stats.differing == 0) ? 0 : 1;
+}
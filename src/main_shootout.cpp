@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "solver.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Run every solver on a corpus of click sets (recordings and/or synthetic
+ * ones), spread over a pool of threads, and compare their error and runtime.
+ */
+
+static void usage(char* cmd)
+{
+    fprintf(stderr, "Usage: %s [-h|--help] [-j <threads>] [--synthetic <n>] [--noise <pixels>] [--seed <n>] [--repeat <n>] [--solver <name>] [--backend <name>] [<recording or directory>...]\n", cmd);
+    fprintf(stderr, "\t-h, --help: print this help message\n");
+    fprintf(stderr, "\t-j: number of threads (default: number of processors)\n");
+    fprintf(stderr, "\t--synthetic: add n random click sets with a known calibration\n");
+    fprintf(stderr, "\t--noise: standard deviation of the synthetic clicks (default: 2 pixels)\n");
+    fprintf(stderr, "\t--seed: seed of the synthetic click sets (default: 1)\n");
+    fprintf(stderr, "\t--repeat: run every solve n times, for the runtime (default: 100)\n");
+    fprintf(stderr, "\t--solver: only run the given solver (may be repeated)\n");
+    fprintf(stderr, "\t--backend: only use the recorded sessions of the given backend (generic, evdev or usbtouchscreen)\n");
+    fprintf(stderr, "Solvers:");
+    const std::vector<const CalibrationSolver*>& solvers = get_solvers();
+    for (unsigned i = 0; i != solvers.size(); i++)
+        fprintf(stderr, " %s", solvers[i]->name());
+    fprintf(stderr, "\n");
+}
+
+static bool load_path(const std::string& path, std::vector<ClickSet>& sets)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) < 0) {
+        fprintf(stderr, "Error: Can't find '%s'.\n", path.c_str());
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode))
+        return load_click_sets(path.c_str(), sets);
+
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL) {
+        fprintf(stderr, "Error: Can't open directory '%s'.\n", path.c_str());
+        return false;
+    }
+    // sorted, for a reproducible order
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.')
+            names.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    bool ok = true;
+    for (unsigned i = 0; i != names.size(); i++)
+        ok &= load_path(names[i], sets);
+    return ok;
+}
+
+/// result of one solver on one set
+struct Outcome {
+    bool skipped;
+    bool ok;
+    double rms, max;
+    double usec;
+};
+
+struct Shootout {
+    const std::vector<ClickSet>* sets;
+    std::vector<const CalibrationSolver*> solvers;
+    int repeat;
+    /// indexed [solver * sets + set]
+    std::vector<Outcome> outcomes;
+    /// next job, shared by the workers
+    unsigned next;
+};
+
+static double now_usec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void* worker(void* arg)
+{
+    Shootout& s = *(Shootout*)arg;
+    const unsigned num_sets = s.sets->size();
+    const unsigned jobs = s.solvers.size() * num_sets;
+
+    for (;;) {
+        const unsigned job = __sync_fetch_and_add(&s.next, 1);
+        if (job >= jobs)
+            break;
+
+        const CalibrationSolver& solver = *s.solvers[job / num_sets];
+        const ClickSet& set = (*s.sets)[job % num_sets];
+        Outcome& out = s.outcomes[job];
+
+        out.skipped = !solver.supports(set);
+        if (out.skipped)
+            continue;
+
+        XYinfo new_axys;
+        const double start = now_usec();
+        out.ok = true;
+        for (int r = 0; r != s.repeat; r++)
+            out.ok &= solver.solve(set, new_axys);
+        out.usec = (now_usec() - start) / s.repeat;
+
+        out.ok = out.ok && calibration_error(set, new_axys, out.rms, out.max);
+    }
+    return NULL;
+}
+
+static double percentile(std::vector<double>& v, double fraction)
+{
+    if (v.empty())
+        return 0;
+    const unsigned i = std::min((unsigned)(fraction * v.size()), (unsigned)v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+int main(int argc, char** argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int synthetic = 0;
+    double noise = 2;
+    unsigned long seed = 1;
+    int repeat = 100;
+    std::vector<std::string> only;
+    int backend = -1;
+    std::vector<std::string> paths;
+
+    for (int i=1; i!=argc; i++) {
+        if (strcmp("-h", argv[i]) == 0 ||
+            strcmp("--help", argv[i]) == 0) {
+            usage(argv[0]);
+            return 0;
+        } else
+
+        if (strcmp("-j", argv[i]) == 0 && argc > i+1) {
+            threads = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--synthetic", argv[i]) == 0 && argc > i+1) {
+            synthetic = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--noise", argv[i]) == 0 && argc > i+1) {
+            noise = atof(argv[++i]);
+        } else
+
+        if (strcmp("--seed", argv[i]) == 0 && argc > i+1) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else
+
+        if (strcmp("--repeat", argv[i]) == 0 && argc > i+1) {
+            repeat = atoi(argv[++i]);
+        } else
+
+        if (strcmp("--solver", argv[i]) == 0 && argc > i+1) {
+            only.push_back(argv[++i]);
+        } else
+
+        if (strcmp("--backend", argv[i]) == 0 && argc > i+1) {
+            i++;
+            for (backend = NUM_BACKENDS - 1; backend >= 0; backend--) {
+                if (strcmp(backend_names[backend], argv[i]) == 0)
+                    break;
+            }
+            if (backend < 0) {
+                fprintf(stderr, "Unknown backend: %s\n\n", argv[i]);
+                usage(argv[0]);
+                return 1;
+            }
+        } else
+
+        if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option or missing argument: %s\n\n", argv[i]);
+            usage(argv[0]);
+            return 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+    if (repeat < 1)
+        repeat = 1;
+
+    // the corpus
+    std::vector<ClickSet> sets;
+    for (unsigned i = 0; i != paths.size(); i++) {
+        if (!load_path(paths[i], sets))
+            return 1;
+    }
+    if (backend >= 0) {
+        unsigned kept = 0;
+        for (unsigned i = 0; i != sets.size(); i++) {
+            if (sets[i].backend == backend)
+                sets[kept++] = sets[i];
+        }
+        sets.resize(kept);
+    }
+    SplitMix64 rng(seed);
+    for (int i = 0; i != synthetic; i++) {
+        ClickSet set;
+        make_synthetic_set(rng, NoiseModel(noise), set);
+        sets.push_back(set);
+    }
+    if (sets.empty()) {
+        fprintf(stderr, "Error: no click sets, give recordings or --synthetic.\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    Shootout s;
+    s.sets = &sets;
+    s.repeat = repeat;
+    s.next = 0;
+    const std::vector<const CalibrationSolver*>& solvers = get_solvers();
+    for (unsigned i = 0; i != solvers.size(); i++) {
+        if (only.empty() || std::find(only.begin(), only.end(), solvers[i]->name()) != only.end())
+            s.solvers.push_back(solvers[i]);
+    }
+    if (s.solvers.empty()) {
+        fprintf(stderr, "Error: unknown solver.\n\n");
+        usage(argv[0]);
+        return 1;
+    }
+    s.outcomes.resize(s.solvers.size() * sets.size());
+
+    // the pool
+    const double start = now_usec();
+    std::vector<pthread_t> pool(threads);
+    for (long t = 0; t != threads; t++)
+        pthread_create(&pool[t], NULL, worker, &s);
+    for (long t = 0; t != threads; t++)
+        pthread_join(pool[t], NULL);
+    const double elapsed = now_usec() - start;
+
+    printf("%u click sets, %u solvers, %li threads, %.3f s\n",
+           (unsigned)sets.size(), (unsigned)s.solvers.size(), threads, elapsed / 1e6);
+    printf("%-12s %8s %8s %10s %10s %10s %10s %10s\n",
+           "solver", "sets", "failed", "mean_px", "p50_px", "p95_px", "max_px", "mean_us");
+    for (unsigned v = 0; v != s.solvers.size(); v++) {
+        std::vector<double> errors;
+        double sum = 0, max = 0, usec = 0;
+        int failed = 0;
+        unsigned supported = 0;
+        for (unsigned i = 0; i != sets.size(); i++) {
+            const Outcome& out = s.outcomes[v * sets.size() + i];
+            if (out.skipped)
+                continue;
+            supported++;
+            usec += out.usec;
+            if (!out.ok) {
+                failed++;
+                continue;
+            }
+            errors.push_back(out.rms);
+            sum += out.rms;
+            max = std::max(max, out.max);
+        }
+        const double mean = errors.empty() ? 0 : sum / errors.size();
+        const double p50 = percentile(errors, 0.5);
+        const double p95 = percentile(errors, 0.95);
+        printf("%-12s %8u %8i %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+               s.solvers[v]->name(), supported, failed,
+               mean, p50, p95, max, supported ? usec / supported : 0);
+    }
+
+    return 0;
+}
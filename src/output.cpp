@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "output.hh"
+
+#include <cstdio>
+
+std::string format_xorgconfd(const char* product, const XYinfo& axys, bool evdev)
+{
+    char line[MAX_LINE_LEN];
+    std::string outstr;
+
+    outstr += "Section \"InputClass\"\n";
+    outstr += "	Identifier	\"calibration\"\n";
+    snprintf(line, sizeof(line), "	MatchProduct	\"%s\"\n", product);
+    outstr += line;
+    if (evdev) {
+        sprintf(line, "	Option	\"Calibration\"	\"%d %d %d %d\"\n",
+                    axys.x.min, axys.x.max, axys.y.min, axys.y.max);
+        outstr += line;
+        sprintf(line, "	Option	\"SwapAxes\"	\"%d\"\n", axys.swap_xy);
+        outstr += line;
+    } else {
+        sprintf(line, "	Option	\"MinX\"	\"%d\"\n", axys.x.min);
+        outstr += line;
+        sprintf(line, "	Option	\"MaxX\"	\"%d\"\n", axys.x.max);
+        outstr += line;
+        sprintf(line, "	Option	\"MinY\"	\"%d\"\n", axys.y.min);
+        outstr += line;
+        sprintf(line, "	Option	\"MaxY\"	\"%d\"\n", axys.y.max);
+        outstr += line;
+        sprintf(line, "	Option	\"SwapXY\"	\"%d\" # unless it was already set to 1\n", axys.swap_xy);
+        outstr += line;
+        sprintf(line, "	Option	\"InvertX\"	\"%d\"  # unless it was already set\n", axys.x.invert);
+        outstr += line;
+        sprintf(line, "	Option	\"InvertY\"	\"%d\"  # unless it was already set\n", axys.y.invert);
+        outstr += line;
+    }
+    outstr += "EndSection\n";
+
+    return outstr;
+}
+
+std::string format_hal(const char* product, const XYinfo& axys, bool evdev)
+{
+    char line[MAX_LINE_LEN];
+    std::string outstr;
+
+    snprintf(line, sizeof(line), "<match key=\"info.product\" contains=\"%s\">\n", product);
+    outstr += line;
+    if (evdev) {
+        sprintf(line, "  <merge key=\"input.x11_options.calibration\" type=\"string\">%d %d %d %d</merge>\n",
+            axys.x.min, axys.x.max, axys.y.min, axys.y.max);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.swapaxes\" type=\"string\">%d</merge>\n",
+            axys.swap_xy);
+        outstr += line;
+    } else {
+        sprintf(line, "  <merge key=\"input.x11_options.minx\" type=\"string\">%d</merge>\n", axys.x.min);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.maxx\" type=\"string\">%d</merge>\n", axys.x.max);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.miny\" type=\"string\">%d</merge>\n", axys.y.min);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.maxy\" type=\"string\">%d</merge>\n", axys.y.max);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.swapxy\" type=\"string\">%d</merge>\n", axys.swap_xy);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.invertx\" type=\"string\">%d</merge>\n", axys.x.invert);
+        outstr += line;
+        sprintf(line, "  <merge key=\"input.x11_options.inverty\" type=\"string\">%d</merge>\n", axys.y.invert);
+        outstr += line;
+    }
+    outstr += "</match>\n";
+
+    return outstr;
+}
+
+std::string format_xinput(const char* device, const XYinfo& axys)
+{
+    char line[MAX_LINE_LEN];
+    std::string outstr;
+
+    snprintf(line, sizeof(line), "    xinput set-int-prop \"%s\" \"Evdev Axis Calibration\" 32 %d %d %d %d\n",
+             device, axys.x.min, axys.x.max, axys.y.min, axys.y.max);
+    outstr += line;
+    snprintf(line, sizeof(line), "    xinput set-int-prop \"%s\" \"Evdev Axes Swap\" 8 %d\n",
+             device, axys.swap_xy);
+    outstr += line;
+
+    return outstr;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2009 Tias Guns
+ * Copyright (c) 2026 The xinput_calibrator authors
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -20,25 +20,24 @@
  * THE SOFTWARE.
  */
 
-#include <unistd.h> // for pause()
+#ifndef _output_hh
+#define _output_hh
+
 #include "calibrator.hh"
-#include "gui/x11.hpp"
 
-int main(int argc, char** argv)
-{
-    Calibrator* calibrator = Calibrator::make_calibrator(argc, argv);
+#include <string>
 
-    GuiCalibratorX11::make_instance( calibrator );
+/*
+ * The ways to make a calibration permanent, as text: an xorg.conf.d
+ * snippet, a HAL policy or xinput commands for the session start.
+ *
+ * 'product' is the sysfs name of the device (what the X server matches
+ * on), 'device' its X input device name. The generic Xorg drivers take
+ * MinX/MaxX/.. options, evdev one "Calibration" option.
+ */
+std::string format_xorgconfd(const char* product, const XYinfo& axys, bool evdev);
+std::string format_hal(const char* product, const XYinfo& axys, bool evdev);
+/// evdev only, there is no such property for the other drivers
+std::string format_xinput(const char* device, const XYinfo& axys);
 
-#ifdef HAVE_TIMERFD
-    while (1)
-    	GuiCalibratorX11::give_timer_signal();
-#else
-    // wait for timer signal, processes events
-    while(1)
-        pause();
 #endif
-
-    delete calibrator;
-    return 0;
-}
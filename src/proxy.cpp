@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "proxy.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <linux/uinput.h>
+
+// older kernel headers do not have the time64 accessors
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+#define BITS_PER_LONG (sizeof(long) * 8)
+#define NLONGS(x) (((x) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define TEST_BIT(bit, array) ((array[(bit) / BITS_PER_LONG] >> ((bit) % BITS_PER_LONG)) & 1)
+
+
+LatencyHistogram::LatencyHistogram()
+  : total(0), max(0)
+{
+    memset(counts, 0, sizeof(counts));
+}
+
+long LatencyHistogram::bucket_limit(int i) const
+{
+    if (i < linear_buckets)
+        return i + 1;
+    return (long)linear_buckets << (i - linear_buckets + 1);
+}
+
+void LatencyHistogram::add(long usec)
+{
+    if (usec < 0)
+        usec = 0;
+
+    int i;
+    if (usec < linear_buckets) {
+        i = usec;
+    } else {
+        i = linear_buckets;
+        while (i < linear_buckets + log_buckets - 1 && usec >= bucket_limit(i))
+            i++;
+    }
+
+    counts[i]++;
+    total++;
+    if (usec > max)
+        max = usec;
+}
+
+long LatencyHistogram::percentile(double fraction) const
+{
+    const unsigned long wanted = (unsigned long) ceil(fraction * total);
+    unsigned long seen = 0;
+    for (int i = 0; i != linear_buckets + log_buckets; i++) {
+        seen += counts[i];
+        if (seen >= wanted && seen > 0)
+            return std::min(bucket_limit(i), max);
+    }
+    return max;
+}
+
+void LatencyHistogram::print(FILE* out) const
+{
+    unsigned long under_50 = 0;
+    for (int i = 0; i < 50; i++)
+        under_50 += counts[i];
+
+    fprintf(out, "Latency (us, kernel timestamp to uinput write): frames=%lu p50=%li p90=%li p99=%li max=%li under_50us=%.2f%%\n",
+            total, percentile(0.5), percentile(0.9), percentile(0.99), max,
+            total ? 100.0 * under_50 / total : 0.0);
+
+    long lower = 0;
+    for (int i = 0; i != linear_buckets + log_buckets; i++) {
+        if (counts[i] != 0)
+            fprintf(out, "\t[%li, %li) %lu\n", lower, bucket_limit(i), counts[i]);
+        lower = bucket_limit(i);
+    }
+}
+
+
+void AxisTransform::correct(int& x, int& y) const
+{
+    const int64_t range_x = max_x - min_x, range_y = max_y - min_y;
+    const int64_t w = correction->get_width() - 1, h = correction->get_height() - 1;
+    if (range_x <= 0 || range_y <= 0 || w <= 0 || h <= 0)
+        return;
+
+    // to the pixels of the grid and back, rounded to nearest
+    const int px = (int)(((x - min_x)*w + range_x/2) / range_x);
+    const int py = (int)(((y - min_y)*h + range_y/2) / range_y);
+    int cx = px, cy = py;
+    correction->correct(cx, cy);
+
+    const int64_t dx = (int64_t)(cx - px)*range_x, dy = (int64_t)(cy - py)*range_y;
+    x = clamp(x + (dx >= 0 ? dx + w/2 : dx - w/2) / w, min_x, max_x);
+    y = clamp(y + (dy >= 0 ? dy + h/2 : dy - h/2) / h, min_y, max_y);
+}
+
+
+UinputProxy::UinputProxy(const char* node, bool verbose0)
+  : verbose(verbose0), fd(-1), uinput_fd(-1), clock(CLOCK_REALTIME),
+    has_mt(false), cur_slot(0), dropped(false)
+{
+    st.correction = mt.correction = NULL;
+    memset(&st_point, 0, sizeof(st_point));
+    memset(mt_points, 0, sizeof(mt_points));
+
+    fd = open(node, O_RDONLY | O_NONBLOCK);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Unable to open ") + node + ": " + strerror(errno));
+
+    if (ioctl(fd, EVIOCGABS(ABS_X), &abs_x) < 0 ||
+        ioctl(fd, EVIOCGABS(ABS_Y), &abs_y) < 0) {
+        close(fd);
+        throw std::runtime_error(std::string(node) + " has no absolute X/Y axes");
+    }
+    has_mt = (ioctl(fd, EVIOCGABS(ABS_MT_POSITION_X), &abs_mt_x) == 0 &&
+              ioctl(fd, EVIOCGABS(ABS_MT_POSITION_Y), &abs_mt_y) == 0 &&
+              abs_mt_x.maximum != abs_mt_x.minimum);
+
+    // kernel timestamps on the same clock as clock_gettime() below
+    int clk = CLOCK_MONOTONIC;
+    if (ioctl(fd, EVIOCSCLOCKID, &clk) == 0)
+        clock = CLOCK_MONOTONIC;
+
+    char name[UINPUT_MAX_NAME_SIZE];
+    memset(name, 0, sizeof(name));
+    ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+
+    if (!create_clone(name)) {
+        const std::string err = strerror(errno);
+        close(fd);
+        throw std::runtime_error("Unable to create uinput device: " + err);
+    }
+
+    if (ioctl(fd, EVIOCGRAB, (void*)1) < 0) {
+        const std::string err = strerror(errno);
+        ioctl(uinput_fd, UI_DEV_DESTROY);
+        close(uinput_fd);
+        close(fd);
+        throw std::runtime_error(std::string("Unable to grab ") + node + ": " + err);
+    }
+
+    // identity until told otherwise
+    const float identity[6] = {1, 0, 0, 0, 1, 0};
+    set_matrix(identity);
+
+    if (verbose)
+        printf("DEBUG: Proxying '%s' (%s), x=%i..%i, y=%i..%i%s\n", name, node,
+               abs_x.minimum, abs_x.maximum, abs_y.minimum, abs_y.maximum,
+               has_mt ? ", multi-touch" : "");
+}
+
+UinputProxy::UinputProxy(const input_absinfo& abs_x0, const input_absinfo& abs_y0,
+                         const input_absinfo* abs_mt_x0, const input_absinfo* abs_mt_y0)
+  : verbose(false), fd(-1), uinput_fd(-1), clock(CLOCK_REALTIME),
+    abs_x(abs_x0), abs_y(abs_y0), has_mt(false), cur_slot(0), dropped(false)
+{
+    st.correction = mt.correction = NULL;
+    memset(&st_point, 0, sizeof(st_point));
+    memset(mt_points, 0, sizeof(mt_points));
+
+    if (abs_mt_x0 != NULL && abs_mt_y0 != NULL) {
+        abs_mt_x = *abs_mt_x0;
+        abs_mt_y = *abs_mt_y0;
+        has_mt = abs_mt_x.maximum != abs_mt_x.minimum;
+    }
+
+    const float identity[6] = {1, 0, 0, 0, 1, 0};
+    set_matrix(identity);
+}
+
+UinputProxy::~UinputProxy()
+{
+    if (fd < 0)
+        return;
+
+    ioctl(fd, EVIOCGRAB, (void*)0);
+    close(fd);
+    ioctl(uinput_fd, UI_DEV_DESTROY);
+    close(uinput_fd);
+}
+
+bool UinputProxy::create_clone(const char* name)
+{
+    uinput_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (uinput_fd < 0)
+        return false;
+
+    // copy the capabilities of the device
+    static const int types[] = {EV_KEY, EV_REL, EV_ABS, EV_MSC};
+    static const int ioctls[] = {UI_SET_KEYBIT, UI_SET_RELBIT, UI_SET_ABSBIT, UI_SET_MSCBIT};
+    static const int counts[] = {KEY_CNT, REL_CNT, ABS_CNT, MSC_CNT};
+    unsigned long bits[NLONGS(KEY_CNT)];
+
+    ioctl(uinput_fd, UI_SET_EVBIT, EV_SYN);
+    for (unsigned t = 0; t != sizeof(types)/sizeof(types[0]); t++) {
+        memset(bits, 0, sizeof(bits));
+        if (ioctl(fd, EVIOCGBIT(types[t], sizeof(bits)), bits) < 0)
+            continue;
+        bool any = false;
+        for (int code = 0; code < counts[t]; code++) {
+            if (TEST_BIT(code, bits)) {
+                ioctl(uinput_fd, ioctls[t], code);
+                any = true;
+            }
+        }
+        if (any)
+            ioctl(uinput_fd, UI_SET_EVBIT, types[t]);
+    }
+
+    memset(bits, 0, sizeof(bits));
+    if (ioctl(fd, EVIOCGPROP(sizeof(bits)), bits) >= 0) {
+        for (int prop = 0; prop < INPUT_PROP_CNT; prop++)
+            if (TEST_BIT(prop, bits))
+                ioctl(uinput_fd, UI_SET_PROPBIT, prop);
+    }
+
+    struct uinput_user_dev dev;
+    memset(&dev, 0, sizeof(dev));
+    snprintf(dev.name, sizeof(dev.name), "%s (calibrated)", name);
+    ioctl(fd, EVIOCGID, &dev.id);
+
+    unsigned long absbits[NLONGS(ABS_CNT)];
+    memset(absbits, 0, sizeof(absbits));
+    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits);
+    for (int code = 0; code < ABS_CNT; code++) {
+        input_absinfo info;
+        if (!TEST_BIT(code, absbits) || ioctl(fd, EVIOCGABS(code), &info) < 0)
+            continue;
+        dev.absmin[code] = info.minimum;
+        dev.absmax[code] = info.maximum;
+        dev.absfuzz[code] = info.fuzz;
+        dev.absflat[code] = info.flat;
+    }
+
+    if (write(uinput_fd, &dev, sizeof(dev)) != sizeof(dev) ||
+        ioctl(uinput_fd, UI_DEV_CREATE) < 0) {
+        const int err = errno;
+        close(uinput_fd);
+        errno = err;
+        return false;
+    }
+
+    return true;
+}
+
+void UinputProxy::compile(AxisTransform& t, const float m[6],
+                          const input_absinfo& ax, const input_absinfo& ay)
+{
+    // out_x = min_x + range_x * (m0*(x-min_x)/range_x + m1*(y-min_y)/range_y + m2)
+    const double rx = ax.maximum - ax.minimum;
+    const double ry = ay.maximum - ay.minimum;
+    const double fixed = 65536.0;
+
+    const double xx = m[0], xy = ry ? m[1] * rx / ry : 0;
+    const double yx = rx ? m[3] * ry / rx : 0, yy = m[4];
+
+    t.xx = (int64_t) floor(xx * fixed + 0.5);
+    t.xy = (int64_t) floor(xy * fixed + 0.5);
+    t.x0 = (int64_t) floor((ax.minimum + rx * m[2] - xx * ax.minimum - xy * ay.minimum) * fixed + 0.5);
+    t.yx = (int64_t) floor(yx * fixed + 0.5);
+    t.yy = (int64_t) floor(yy * fixed + 0.5);
+    t.y0 = (int64_t) floor((ay.minimum + ry * m[5] - yx * ax.minimum - yy * ay.minimum) * fixed + 0.5);
+
+    t.min_x = ax.minimum; t.max_x = ax.maximum;
+    t.min_y = ay.minimum; t.max_y = ay.maximum;
+}
+
+void UinputProxy::set_matrix(const float m[6])
+{
+    compile(st, m, abs_x, abs_y);
+    if (has_mt)
+        compile(mt, m, abs_mt_x, abs_mt_y);
+}
+
+bool UinputProxy::set_correction(const char* filename)
+{
+    if (!correction.load(filename))
+        return false;
+
+    st.correction = &correction;
+    if (has_mt)
+        mt.correction = &correction;
+    if (verbose)
+        printf("DEBUG: Correcting with the %ix%i grid of '%s'\n",
+               correction.get_width(), correction.get_height(), filename);
+    return true;
+}
+
+void UinputProxy::set_calibration(const XYinfo& axys)
+{
+    // evdev first swaps the axes, rescaling a swapped value from the range
+    // of its raw axis to the range of the other one (Evdev270Driver), then
+    // scales the calibrated range to the device range and finally inverts.
+    // On normalized coordinates the swap is a plain exchange, and the
+    // calibration is in units of each axis' own range.
+    // A calibrated range of 0 keeps the device range (only swap/invert)
+    const double cx = axys.x.max - axys.x.min;
+    const double cy = axys.y.max - axys.y.min;
+
+    float m[6] = {0, 0, 0, 0, 0, 0};
+    m[axys.swap_xy ? 1 : 0] = cx ? (abs_x.maximum - abs_x.minimum) / cx : 1;
+    m[2] = cx ? (abs_x.minimum - axys.x.min) / cx : 0;
+    m[axys.swap_xy ? 3 : 4] = cy ? (abs_y.maximum - abs_y.minimum) / cy : 1;
+    m[5] = cy ? (abs_y.minimum - axys.y.min) / cy : 0;
+
+    if (axys.x.invert) {
+        m[0] = -m[0]; m[1] = -m[1]; m[2] = 1 - m[2];
+    }
+    if (axys.y.invert) {
+        m[3] = -m[3]; m[4] = -m[4]; m[5] = 1 - m[5];
+    }
+
+    if (verbose)
+        printf("DEBUG: Matrix: %f %f %f %f %f %f\n", m[0], m[1], m[2], m[3], m[4], m[5]);
+
+    set_matrix(m);
+}
+
+long UinputProxy::frame_latency(const input_event& syn) const
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (now.tv_sec - syn.input_event_sec) * 1000000L +
+           (now.tv_nsec / 1000 - syn.input_event_usec);
+}
+
+/*
+ * Transform one frame, ending with its SYN_REPORT, in place; or the part of
+ * a frame that fills the read buffer, the rest of it follows.
+ *
+ * The events themselves are rewritten; when the transform mixes X and Y and
+ * only one of them changed in this frame, the other one is added to 'extra'.
+ * Adds the iovecs to write the frame, returns the number of extra events used.
+ */
+int UinputProxy::process_frame(input_event* ev, int n, struct iovec* iov, int& niov,
+                               input_event* extra)
+{
+    const int first_slot = cur_slot;
+    bool touched[max_slots];
+    memset(touched, 0, sizeof(touched));
+    st_point.has_x = st_point.has_y = false;
+
+    // first pass: the raw state at the end of this frame
+    for (int i = 0; i != n; i++) {
+        if (ev[i].type != EV_ABS)
+            continue;
+        switch (ev[i].code) {
+            case ABS_X: st_point.x = ev[i].value; st_point.has_x = true; break;
+            case ABS_Y: st_point.y = ev[i].value; st_point.has_y = true; break;
+            case ABS_MT_SLOT:
+                cur_slot = (ev[i].value >= 0 && ev[i].value < max_slots) ? ev[i].value : 0;
+                break;
+            case ABS_MT_POSITION_X:
+                if (!touched[cur_slot])
+                    mt_points[cur_slot].has_x = mt_points[cur_slot].has_y = false;
+                touched[cur_slot] = true;
+                mt_points[cur_slot].x = ev[i].value;
+                mt_points[cur_slot].has_x = true;
+                break;
+            case ABS_MT_POSITION_Y:
+                if (!touched[cur_slot])
+                    mt_points[cur_slot].has_x = mt_points[cur_slot].has_y = false;
+                touched[cur_slot] = true;
+                mt_points[cur_slot].y = ev[i].value;
+                mt_points[cur_slot].has_y = true;
+                break;
+        }
+    }
+
+    // second pass: rewrite the coordinates
+    int slot = first_slot;
+    for (int i = 0; i != n; i++) {
+        if (ev[i].type != EV_ABS)
+            continue;
+        const Point& mp = mt_points[slot];
+        switch (ev[i].code) {
+            case ABS_X: ev[i].value = st.apply_x(st_point.x, st_point.y); break;
+            case ABS_Y: ev[i].value = st.apply_y(st_point.x, st_point.y); break;
+            case ABS_MT_SLOT:
+                slot = (ev[i].value >= 0 && ev[i].value < max_slots) ? ev[i].value : 0;
+                break;
+            case ABS_MT_POSITION_X: ev[i].value = mt.apply_x(mp.x, mp.y); break;
+            case ABS_MT_POSITION_Y: ev[i].value = mt.apply_y(mp.x, mp.y); break;
+        }
+    }
+
+    // the events up to the SYN_REPORT, straight from the read buffer
+    const bool complete = ev[n - 1].type == EV_SYN && ev[n - 1].code == SYN_REPORT;
+    iov[niov].iov_base = ev;
+    iov[niov].iov_len = (complete ? n - 1 : n) * sizeof(input_event);
+    niov++;
+
+    // when X and Y are mixed, a change in one changes both
+    // (the extra events get the time of the last one)
+    int nextra = 0;
+    const input_event& syn = ev[n - 1];
+    if (st.mixes() && st_point.has_x != st_point.has_y) {
+        input_event& e = extra[nextra++];
+        e = syn;
+        e.type = EV_ABS;
+        e.code = st_point.has_x ? ABS_Y : ABS_X;
+        e.value = st_point.has_x ? st.apply_y(st_point.x, st_point.y)
+                                 : st.apply_x(st_point.x, st_point.y);
+    }
+    if (has_mt && mt.mixes()) {
+        bool moved_slot = false;
+        for (int s = 0; s != max_slots; s++) {
+            const Point& mp = mt_points[s];
+            if (!touched[s] || mp.has_x == mp.has_y)
+                continue;
+
+            input_event& sel = extra[nextra++];
+            sel = syn;
+            sel.type = EV_ABS;
+            sel.code = ABS_MT_SLOT;
+            sel.value = s;
+            moved_slot = true;
+
+            input_event& e = extra[nextra++];
+            e = sel;
+            e.code = mp.has_x ? ABS_MT_POSITION_Y : ABS_MT_POSITION_X;
+            e.value = mp.has_x ? mt.apply_y(mp.x, mp.y) : mt.apply_x(mp.x, mp.y);
+        }
+        if (moved_slot) {
+            // leave the slot where the device left it
+            input_event& sel = extra[nextra++];
+            sel = syn;
+            sel.type = EV_ABS;
+            sel.code = ABS_MT_SLOT;
+            sel.value = cur_slot;
+        }
+    }
+    if (nextra) {
+        iov[niov].iov_base = extra;
+        iov[niov].iov_len = nextra * sizeof(input_event);
+        niov++;
+    }
+
+    if (complete) {
+        iov[niov].iov_base = &ev[n - 1];
+        iov[niov].iov_len = sizeof(input_event);
+        niov++;
+    }
+
+    return nextra;
+}
+
+/*
+ * After a SYN_DROPPED: read the state back from the device and write it,
+ * transformed, as one frame ending with the given SYN_REPORT.
+ * Returns the number of extra events used.
+ */
+int UinputProxy::resync(const input_event& syn, struct iovec* iov, int& niov,
+                        input_event* extra)
+{
+    input_absinfo info;
+    if (ioctl(fd, EVIOCGABS(ABS_X), &info) == 0)
+        st_point.x = info.value;
+    if (ioctl(fd, EVIOCGABS(ABS_Y), &info) == 0)
+        st_point.y = info.value;
+
+    int nextra = 0;
+    input_event e = syn;
+    e.type = EV_ABS;
+    e.code = ABS_X;
+    e.value = st.apply_x(st_point.x, st_point.y);
+    extra[nextra++] = e;
+    e.code = ABS_Y;
+    e.value = st.apply_y(st_point.x, st_point.y);
+    extra[nextra++] = e;
+
+    struct {
+        __u32 code;
+        __s32 values[max_slots];
+    } ids, xs, ys;
+    ids.code = ABS_MT_TRACKING_ID;
+    xs.code = ABS_MT_POSITION_X;
+    ys.code = ABS_MT_POSITION_Y;
+    if (has_mt && ioctl(fd, EVIOCGMTSLOTS(sizeof(ids)), &ids) == 0 &&
+        ioctl(fd, EVIOCGMTSLOTS(sizeof(xs)), &xs) == 0 &&
+        ioctl(fd, EVIOCGMTSLOTS(sizeof(ys)), &ys) == 0) {
+        // the position of every active contact
+        for (int s = 0; s != max_slots; s++) {
+            mt_points[s].x = xs.values[s];
+            mt_points[s].y = ys.values[s];
+            if (ids.values[s] < 0)
+                continue;
+            e.code = ABS_MT_SLOT;
+            e.value = s;
+            extra[nextra++] = e;
+            e.code = ABS_MT_POSITION_X;
+            e.value = mt.apply_x(mt_points[s].x, mt_points[s].y);
+            extra[nextra++] = e;
+            e.code = ABS_MT_POSITION_Y;
+            e.value = mt.apply_y(mt_points[s].x, mt_points[s].y);
+            extra[nextra++] = e;
+        }
+        if (ioctl(fd, EVIOCGABS(ABS_MT_SLOT), &info) == 0)
+            cur_slot = (info.value >= 0 && info.value < max_slots) ? info.value : 0;
+        e.code = ABS_MT_SLOT;
+        e.value = cur_slot;
+        extra[nextra++] = e;
+    }
+    extra[nextra++] = syn;
+
+    if (verbose)
+        printf("DEBUG: Events dropped, resynced at x=%i, y=%i\n", st_point.x, st_point.y);
+
+    iov[niov].iov_base = extra;
+    iov[niov].iov_len = nextra * sizeof(input_event);
+    niov++;
+    return nextra;
+}
+
+int UinputProxy::process_frames(input_event* ev, int n, struct iovec* iov, int& niov,
+                                input_event* extra)
+{
+    int start = 0, used_extra = 0;
+    for (int i = 0; i != n; i++) {
+        if (ev[i].type != EV_SYN)
+            continue;
+
+        if (ev[i].code == SYN_DROPPED) {
+            // the frame is incomplete, up to the next SYN_REPORT
+            dropped = true;
+        } else if (ev[i].code == SYN_REPORT) {
+            if (dropped) {
+                dropped = false;
+                resync(ev[i], iov, niov, extra + used_extra);
+                return i + 1;
+            }
+            used_extra += process_frame(ev + start, i - start + 1, iov, niov,
+                                        extra + used_extra);
+            start = i + 1;
+        }
+    }
+
+    if (start == 0 && n == max_events) {
+        // a frame larger than the buffer: transform it piece by piece
+        // (dropped events are discarded all the same)
+        if (!dropped)
+            process_frame(ev, n, iov, niov, extra);
+        return n;
+    }
+    return start;
+}
+
+bool UinputProxy::run()
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    const int sig_fd = signalfd(-1, &mask, SFD_NONBLOCK);
+
+    const int ep = epoll_create(2);
+    struct epoll_event ee;
+    memset(&ee, 0, sizeof(ee));
+    ee.events = EPOLLIN;
+    ee.data.fd = fd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ee);
+    ee.data.fd = sig_fd;
+    epoll_ctl(ep, EPOLL_CTL_ADD, sig_fd, &ee);
+
+    // per frame: its events, the extra events and its SYN_REPORT;
+    // the transform adds at most 2 extra events per coordinate event
+    input_event buf[max_events];
+    input_event extra[max_extra];
+    struct iovec iov[max_iov];
+    int have = 0;
+
+    bool ok = true, done = false;
+    while (!done) {
+        struct epoll_event events[2];
+        const int nev = epoll_wait(ep, events, 2, -1);
+        if (nev < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            ok = false;
+            break;
+        }
+
+        for (int e = 0; e != nev; e++) {
+            if (events[e].data.fd == sig_fd) {
+                struct signalfd_siginfo si;
+                while (read(sig_fd, &si, sizeof(si)) == sizeof(si)) {
+                    if (si.ssi_signo == SIGUSR1)
+                        histogram.print(stdout);
+                    else
+                        done = true;
+                }
+                continue;
+            }
+
+            // drain the device
+            for (;;) {
+                const ssize_t len = read(fd, buf + have, (max_events - have) * sizeof(input_event));
+                if (len < 0) {
+                    if (errno != EAGAIN && errno != EINTR) {
+                        perror("Reading events");
+                        ok = false;
+                        done = true;
+                    }
+                    break;
+                }
+                if (len == 0) {
+                    fprintf(stderr, "Device removed\n");
+                    done = true;
+                    break;
+                }
+                have += len / sizeof(input_event);
+
+                // a writev() per batch, process_frames() stops after a resync
+                int used = 0, batch;
+                do {
+                    int niov = 0;
+                    batch = process_frames(buf + used, have - used, iov, niov, extra);
+                    if (niov > 0 && writev(uinput_fd, iov, niov) < 0)
+                        perror("Writing events");
+
+                    for (int i = used; i != used + batch; i++)
+                        if (buf[i].type == EV_SYN && buf[i].code == SYN_REPORT)
+                            histogram.add(frame_latency(buf[i]));
+                    used += batch;
+                } while (batch > 0 && used != have);
+
+                // keep the start of an incomplete frame
+                if (used != have)
+                    memmove(buf, buf + used, (have - used) * sizeof(input_event));
+                have -= used;
+            }
+        }
+    }
+
+    close(ep);
+    close(sig_fd);
+    return ok;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _proxy_hh
+#define _proxy_hh
+
+#include "calibrator.hh"
+#include "correction.hh"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <linux/input.h>
+
+/// Histogram of latencies, in microseconds
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void add(long usec);
+
+    /// upper bound of the bucket holding the given fraction (0..1) of samples
+    long percentile(double fraction) const;
+
+    void print(FILE* out) const;
+
+private:
+    // 1 us buckets up to 100 us, then doubling up to ~100 s
+    static const int linear_buckets = 100;
+    static const int log_buckets = 21;
+
+    long bucket_limit(int i) const;
+
+    unsigned long counts[linear_buckets + log_buckets];
+    unsigned long total;
+    long max;
+};
+
+/// Affine transform of an X/Y axis pair, in device units and 16.16 fixed point:
+/// out_x = (xx*x + xy*y + x0) >> 16, out_y = (yx*x + yy*y + y0) >> 16,
+/// optionally followed by a non-linear correction grid
+struct AxisTransform
+{
+    int64_t xx, xy, x0;
+    int64_t yx, yy, y0;
+    int min_x, max_x, min_y, max_y;
+
+    /// the correction of the remaining error, in pixels of a screen the
+    /// device range spans (see --correction-output), or NULL
+    const CorrectionGrid* correction;
+
+    /// whether x depends on y or the other way around
+    bool mixes() const
+    { return xy != 0 || yx != 0 || correction != NULL; }
+
+    void apply(int x, int y, int& out_x, int& out_y) const
+    {
+        out_x = clamp(((xx*x + xy*y + x0) + 0x8000) >> 16, min_x, max_x);
+        out_y = clamp(((yx*x + yy*y + y0) + 0x8000) >> 16, min_y, max_y);
+        if (correction != NULL)
+            correct(out_x, out_y);
+    }
+    int apply_x(int x, int y) const
+    { int out_x, out_y; apply(x, y, out_x, out_y); return out_x; }
+    int apply_y(int x, int y) const
+    { int out_x, out_y; apply(x, y, out_x, out_y); return out_y; }
+
+    /// apply the correction grid to calibrated device coordinates
+    void correct(int& x, int& y) const;
+
+    static int clamp(int64_t v, int lo, int hi)
+    { return v < lo ? lo : (v > hi ? hi : (int)v); }
+};
+
+/*
+ * Calibration proxy for drivers without calibration support.
+ *
+ * Grabs the raw event node, transforms the absolute X/Y (and multi-touch)
+ * coordinates of every SYN_REPORT frame in the read buffer itself,
+ * and writes the frames to a uinput clone of the device with one writev().
+ * After a SYN_DROPPED the rest of the frame is discarded, and the state
+ * read back from the device (EVIOCGABS) is written as one frame.
+ */
+class UinputProxy
+{
+public:
+    /// most events read (and transformed) at once
+    static const int max_events = 256;
+    static const int max_slots = 32;
+    /// room for the extra events and iovecs of process_frames():
+    /// 2 extra events per coordinate event, or one resync frame
+    static const int max_extra = 2*max_events + 3*max_slots + 4;
+    static const int max_iov = 3*max_events;
+
+    /// Grab the given event node and create the uinput clone,
+    /// throws std::runtime_error on failure
+    UinputProxy(const char* node, bool verbose = false);
+    /// A proxy of the given axes (the multi-touch ones NULL if there are none)
+    /// without a device or uinput clone, for testing process_frames();
+    /// run() can't be used and a resync keeps the last known state
+    UinputProxy(const input_absinfo& abs_x, const input_absinfo& abs_y,
+                const input_absinfo* abs_mt_x = NULL, const input_absinfo* abs_mt_y = NULL);
+    ~UinputProxy();
+
+    /// Use an evdev style calibration (as "Evdev Axis Calibration",
+    /// "Evdev Axes Swap" and "Evdev Axis Inversion")
+    void set_calibration(const XYinfo& axys);
+
+    /// Use a 2x3 matrix on coordinates normalized to 0..1
+    /// (the first two rows of a "Coordinate Transformation Matrix")
+    void set_matrix(const float m[6]);
+
+    /// Correct the remaining (non-linear) error with the grid of
+    /// --correction-output, after the calibration. Returns false if
+    /// the file can't be read.
+    bool set_correction(const char* filename);
+
+    /// Forward events until SIGINT or SIGTERM, SIGUSR1 prints the histogram.
+    /// Returns false on error.
+    bool run();
+
+    const LatencyHistogram& get_histogram() const
+    { return histogram; }
+
+    /// the transform of the single-touch axes
+    const AxisTransform& get_transform() const
+    { return st; }
+
+    /*
+     * Transform the complete frames in 'ev' in place, adding the iovecs to
+     * write them (and 'extra', max_extra events) to 'iov' (max_iov).
+     * Returns the number of events used, the rest belongs to a frame that
+     * is not complete yet; a full buffer of one frame is transformed as it is.
+     * Stops after a resync, call again for the events after it.
+     */
+    int process_frames(input_event* ev, int n, struct iovec* iov, int& niov,
+                       input_event* extra);
+
+private:
+    struct Point {
+        int x, y;
+        bool has_x, has_y;
+    };
+
+    bool create_clone(const char* name);
+    void compile(AxisTransform& t, const float m[6], const input_absinfo& ax,
+                 const input_absinfo& ay);
+    int process_frame(input_event* ev, int n, struct iovec* iov, int& niov,
+                      input_event* extra);
+    int resync(const input_event& syn, struct iovec* iov, int& niov,
+               input_event* extra);
+    long frame_latency(const input_event& syn) const;
+
+    bool verbose;
+    int fd, uinput_fd;
+    clockid_t clock;
+
+    input_absinfo abs_x, abs_y, abs_mt_x, abs_mt_y;
+    bool has_mt;
+    int cur_slot;
+    /// events were dropped, discard them up to the next SYN_REPORT
+    bool dropped;
+
+    AxisTransform st, mt;
+    CorrectionGrid correction;
+    Point st_point;
+    Point mt_points[max_slots];
+
+    LatencyHistogram histogram;
+};
+
+#endif
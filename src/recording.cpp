@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "recording.hh"
+
+#include <cstring>
+
+static const char magic[4] = {'X', 'I', 'C', 'R'};
+static const int version = 3;
+
+SessionRecorder::SessionRecorder()
+  : fid(NULL)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    if (fid != NULL)
+        fclose(fid);
+}
+
+bool SessionRecorder::open(const char* filename0, const char* device, CalibratorBackend backend,
+                           const XYinfo& old_axys, int thr_misclick, int thr_doubleclick)
+{
+    filename = filename0;
+    fid = fopen(filename0, "wb");
+    if (fid == NULL) {
+        fprintf(stderr, "Error: Can't open '%s' for writing. Make sure you have the necessary rights\n", filename0);
+        return false;
+    }
+    gettimeofday(&start, NULL);
+
+    // write errors show in ferror(), checked by end()
+    fwrite(magic, sizeof(magic), 1, fid);
+    fputc(version, fid);
+
+    begin(REC_SESSION);
+    const size_t len = strlen(device);
+    put_uint(len);
+    fwrite(device, len, 1, fid);
+    put_uint(backend);
+    put_axys(old_axys);
+    put_uint(thr_misclick);
+    put_uint(thr_doubleclick);
+    return end();
+}
+
+void SessionRecorder::click(int x, int y, ClickDecision decision)
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_CLICK);
+    put_int(x);
+    put_int(y);
+    put_uint(decision);
+    end();
+}
+
+void SessionRecorder::reset()
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_RESET);
+    end();
+}
+
+void SessionRecorder::finish(int width, int height)
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_FINISH);
+    put_uint(width);
+    put_uint(height);
+    end();
+}
+
+void SessionRecorder::result(bool success, const XYinfo& new_axys)
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_RESULT);
+    put_uint(success);
+    if (success)
+        put_axys(new_axys);
+    end();
+}
+
+void SessionRecorder::verify_click(int x, int y)
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_VERIFY);
+    put_int(x);
+    put_int(y);
+    end();
+}
+
+void SessionRecorder::verified(float threshold_verify, int verify_grid, bool success)
+{
+    if (fid == NULL)
+        return;
+
+    begin(REC_VERIFIED);
+    put_float(threshold_verify);
+    put_uint(verify_grid);
+    put_uint(success);
+    end();
+}
+
+void SessionRecorder::begin(SessionRecordType type)
+{
+    fputc(type, fid);
+    if (type == REC_SESSION)
+        return;
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    put_uint((now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000);
+}
+
+bool SessionRecorder::end()
+{
+    if (fflush(fid) == 0 && !ferror(fid))
+        return true;
+
+    fprintf(stderr, "Error: unable to write the session recording to '%s', recording stopped\n", filename.c_str());
+    fclose(fid);
+    fid = NULL;
+    return false;
+}
+
+void SessionRecorder::put_uint(unsigned long v)
+{
+    while (v >= 0x80) {
+        fputc((v & 0x7f) | 0x80, fid);
+        v >>= 7;
+    }
+    fputc(v, fid);
+}
+
+void SessionRecorder::put_int(long v)
+{
+    // zigzag: small negative numbers stay small
+    put_uint(((unsigned long)v << 1) ^ (unsigned long)(v >> (sizeof(long) * 8 - 1)));
+}
+
+void SessionRecorder::put_float(float v)
+{
+    // exactly: verify() compares against it
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_uint(bits);
+}
+
+void SessionRecorder::put_axys(const XYinfo& axys)
+{
+    put_int(axys.x.min); put_int(axys.x.max);
+    put_int(axys.y.min); put_int(axys.y.max);
+    put_uint((axys.swap_xy ? 1 : 0) | (axys.x.invert ? 2 : 0) | (axys.y.invert ? 4 : 0));
+}
+
+
+SessionReader::SessionReader()
+  : fid(NULL), corrupt(false)
+{
+}
+
+SessionReader::~SessionReader()
+{
+    if (fid != NULL)
+        fclose(fid);
+}
+
+bool SessionReader::open(const char* filename)
+{
+    fid = fopen(filename, "rb");
+    if (fid == NULL) {
+        fprintf(stderr, "Error: Can't open '%s' for reading.\n", filename);
+        return false;
+    }
+
+    char header[5];
+    if (fread(header, sizeof(header), 1, fid) != 1 ||
+        memcmp(header, magic, sizeof(magic)) != 0 || header[4] != version) {
+        fprintf(stderr, "Error: '%s' is not a session recording.\n", filename);
+        return false;
+    }
+    return true;
+}
+
+bool SessionReader::next(SessionRecord& rec)
+{
+    int type = fgetc(fid);
+    if (type == magic[0]) {
+        // concatenated recordings: skip the header of the next one
+        char header[4];
+        if (fread(header, sizeof(header), 1, fid) != 1 ||
+            memcmp(header, magic + 1, sizeof(magic) - 1) != 0 || header[3] != version) {
+            corrupt = true;
+            return false;
+        }
+        type = fgetc(fid);
+    }
+    if (type == EOF)
+        return false;
+
+    // any failure from here on is a truncated or corrupt record
+    corrupt = true;
+    rec.type = (SessionRecordType) type;
+    rec.time_ms = 0;
+    unsigned long v;
+    switch (type) {
+        case REC_SESSION: {
+            if (!get_uint(v) || v > 4096)
+                return false;
+            rec.device.resize(v);
+            if (v > 0 && fread(&rec.device[0], v, 1, fid) != 1)
+                return false;
+            if (!get_uint(v) || v >= NUM_BACKENDS)
+                return false;
+            rec.backend = (CalibratorBackend) v;
+            unsigned long thr_misclick, thr_doubleclick;
+            if (!get_axys(rec.old_axys) || !get_uint(thr_misclick) || !get_uint(thr_doubleclick))
+                return false;
+            rec.thr_misclick = thr_misclick;
+            rec.thr_doubleclick = thr_doubleclick;
+            break;
+        }
+        case REC_CLICK:
+            if (!get_uint(rec.time_ms) || !get_int(rec.x) || !get_int(rec.y) ||
+                !get_uint(v) || v > CLICK_MISCLICK)
+                return false;
+            rec.decision = (ClickDecision) v;
+            break;
+        case REC_RESET:
+            if (!get_uint(rec.time_ms))
+                return false;
+            break;
+        case REC_FINISH: {
+            unsigned long w, h;
+            if (!get_uint(rec.time_ms) || !get_uint(w) || !get_uint(h))
+                return false;
+            rec.width = w;
+            rec.height = h;
+            break;
+        }
+        case REC_RESULT:
+            if (!get_uint(rec.time_ms) || !get_uint(v))
+                return false;
+            rec.success = (v != 0);
+            if (rec.success && !get_axys(rec.new_axys))
+                return false;
+            break;
+        case REC_VERIFY:
+            if (!get_uint(rec.time_ms) || !get_int(rec.x) || !get_int(rec.y))
+                return false;
+            break;
+        case REC_VERIFIED: {
+            unsigned long grid;
+            if (!get_uint(rec.time_ms) || !get_float(rec.threshold_verify) ||
+                !get_uint(grid) || grid > 4096 || !get_uint(v))
+                return false;
+            rec.verify_grid = grid;
+            rec.success = (v != 0);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    corrupt = false;
+    return true;
+}
+
+bool SessionReader::get_uint(unsigned long& v)
+{
+    v = 0;
+    for (unsigned shift = 0; shift < sizeof(v) * 8; shift += 7) {
+        const int c = fgetc(fid);
+        if (c == EOF)
+            return false;
+        v |= (unsigned long)(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool SessionReader::get_int(int& v)
+{
+    unsigned long u;
+    if (!get_uint(u))
+        return false;
+    v = (int)((long)(u >> 1) ^ -(long)(u & 1));
+    return true;
+}
+
+bool SessionReader::get_float(float& v)
+{
+    unsigned long u;
+    if (!get_uint(u) || u > 0xffffffffUL)
+        return false;
+    const uint32_t bits = u;
+    memcpy(&v, &bits, sizeof(v));
+    return true;
+}
+
+bool SessionReader::get_axys(XYinfo& axys)
+{
+    unsigned long flags;
+    if (!get_int(axys.x.min) || !get_int(axys.x.max) ||
+        !get_int(axys.y.min) || !get_int(axys.y.max) || !get_uint(flags))
+        return false;
+    axys.swap_xy = (flags & 1) != 0;
+    axys.x.invert = (flags & 2) != 0;
+    axys.y.invert = (flags & 4) != 0;
+    return true;
+}
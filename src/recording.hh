@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _recording_hh
+#define _recording_hh
+
+#include "calibrator.hh"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <sys/time.h>
+
+/*
+ * Recording of a calibration session, to replay it offline.
+ *
+ * File format: the magic "XICR" and a version byte, followed by records.
+ * Every record is a type byte and its fields; all numbers are LEB128
+ * varints, signed ones zigzag encoded, times in ms since the session start.
+ *
+ *   SESSION  device name (length + bytes), backend (CalibratorBackend),
+ *            old axys (min/max x, min/max y, flags: 1=swap_xy 2=invert_x
+ *            4=invert_y), misclick threshold, doubleclick threshold
+ *   CLICK    time, x, y, decision
+ *   RESET    time
+ *   FINISH   time, width, height
+ *   RESULT   time, success, the new axys if successful
+ *   VERIFY   time, x, y of a click of the verification pass
+ *   VERIFIED time, threshold (the bits of the float), verify grid, success
+ *            of the verification pass
+ *
+ * A file can hold several sessions, each starting with a SESSION record;
+ * concatenated recordings (cat a.rec b.rec) read as one.
+ */
+enum SessionRecordType {
+    REC_SESSION = 1,
+    REC_CLICK,
+    REC_RESET,
+    REC_FINISH,
+    REC_RESULT,
+    REC_VERIFY,
+    REC_VERIFIED
+};
+
+/// what add_click() did with a click
+enum ClickDecision {
+    CLICK_ACCEPTED = 0,
+    CLICK_DOUBLECLICK,
+    CLICK_MISCLICK
+};
+
+/// one decoded record, only the fields of its type are set
+struct SessionRecord {
+    SessionRecordType type;
+    unsigned long time_ms;
+
+    // SESSION
+    std::string device;
+    CalibratorBackend backend;
+    XYinfo old_axys;
+    int thr_misclick, thr_doubleclick;
+
+    // CLICK, VERIFY
+    int x, y;
+    ClickDecision decision;
+
+    // FINISH
+    int width, height;
+
+    // RESULT, VERIFIED
+    bool success;
+    XYinfo new_axys;
+
+    // VERIFIED
+    float threshold_verify;
+    int verify_grid;
+};
+
+/// Writes a session as it happens, flushed after every record
+/// (the GUIs leave with exit()); after a write error it reports it
+/// and records nothing more
+class SessionRecorder
+{
+public:
+    SessionRecorder();
+    ~SessionRecorder();
+
+    /// open the file and write the SESSION record, returns false on failure
+    bool open(const char* filename, const char* device, CalibratorBackend backend,
+              const XYinfo& old_axys, int thr_misclick, int thr_doubleclick);
+
+    void click(int x, int y, ClickDecision decision);
+    void reset();
+    void finish(int width, int height);
+    void result(bool success, const XYinfo& new_axys);
+    void verify_click(int x, int y);
+    void verified(float threshold_verify, int verify_grid, bool success);
+
+private:
+    void begin(SessionRecordType type);
+    /// flush the record, false (and the file closed) on a write error
+    bool end();
+    void put_uint(unsigned long v);
+    void put_int(long v);
+    void put_float(float v);
+    void put_axys(const XYinfo& axys);
+
+    FILE* fid;
+    std::string filename;
+    struct timeval start;
+};
+
+/// Reads the records of a recording back
+class SessionReader
+{
+public:
+    SessionReader();
+    ~SessionReader();
+
+    /// open the file and check its header, returns false on failure
+    bool open(const char* filename);
+
+    /// read the next record, returns false at the end or on a corrupt record
+    bool next(SessionRecord& rec);
+
+    /// whether next() stopped on a corrupt record rather than the end
+    bool is_corrupt() const
+    { return corrupt; }
+
+private:
+    bool get_uint(unsigned long& v);
+    bool get_int(int& v);
+    bool get_float(float& v);
+    bool get_axys(XYinfo& axys);
+
+    FILE* fid;
+    bool corrupt;
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "shm_publish.hh"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/file.h>
+
+CalibrationPublisher::CalibrationPublisher(const char* device0)
+  : fd(-1), seg(NULL)
+{
+    strncpy(device, device0, sizeof(device) - 1);
+    device[sizeof(device) - 1] = '\0';
+
+    char name[256];
+    xicshm_segment_name(device0, name, sizeof(name));
+
+    fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: can't create shared memory segment '%s': %s\n", name, strerror(errno));
+        return;
+    }
+
+    flock(fd, LOCK_EX);
+    struct stat st;
+    if (fstat(fd, &st) < 0 ||
+        (st.st_size < (off_t)sizeof(xicshm_segment) &&
+         ftruncate(fd, sizeof(xicshm_segment)) < 0)) {
+        fprintf(stderr, "Error: can't size shared memory segment '%s': %s\n", name, strerror(errno));
+        flock(fd, LOCK_UN);
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    void* p = mmap(NULL, sizeof(xicshm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "Error: can't map shared memory segment '%s': %s\n", name, strerror(errno));
+        flock(fd, LOCK_UN);
+        close(fd);
+        fd = -1;
+        return;
+    }
+    seg = (xicshm_segment*) p;
+
+    // a new segment (ftruncate() zero-fills it), or one of another version
+    if (seg->magic != XICSHM_MAGIC || seg->version != XICSHM_VERSION) {
+        const uint32_t seq = __atomic_load_n(&seg->seq, __ATOMIC_RELAXED) | 1;
+        __atomic_store_n(&seg->seq, seq, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memset(&seg->cal, 0, sizeof(seg->cal));
+        seg->version = XICSHM_VERSION;
+        seg->magic = XICSHM_MAGIC;
+        __atomic_store_n(&seg->seq, seq + 1, __ATOMIC_RELEASE);
+    }
+    flock(fd, LOCK_UN);
+}
+
+CalibrationPublisher::~CalibrationPublisher()
+{
+    if (seg != NULL)
+        munmap(seg, sizeof(xicshm_segment));
+    if (fd >= 0)
+        close(fd);
+}
+
+bool CalibrationPublisher::publish(const XYinfo& axys)
+{
+    return update(&axys, NULL);
+}
+
+bool CalibrationPublisher::publish(const float matrix[6])
+{
+    return update(NULL, matrix);
+}
+
+bool CalibrationPublisher::update(const XYinfo* axys, const float* matrix)
+{
+    if (seg == NULL)
+        return false;
+
+    // prepare the new snapshot first, keeping the odd window short
+    flock(fd, LOCK_EX);
+    xicshm_calibration cal = seg->cal;
+    memcpy(cal.device, device, sizeof(cal.device));
+    if (axys != NULL) {
+        cal.flags |= XICSHM_HAS_AXES;
+        cal.min_x = axys->x.min; cal.max_x = axys->x.max;
+        cal.min_y = axys->y.min; cal.max_y = axys->y.max;
+        cal.swap_xy = axys->swap_xy;
+        cal.invert_x = axys->x.invert;
+        cal.invert_y = axys->y.invert;
+    }
+    if (matrix != NULL) {
+        cal.flags |= XICSHM_HAS_MATRIX;
+        memcpy(cal.matrix, matrix, sizeof(cal.matrix));
+    }
+
+    // seqlock write: odd sequence, data, even sequence
+    // (rounded up, in case a previous writer died in its odd window)
+    const uint32_t seq = (__atomic_load_n(&seg->seq, __ATOMIC_RELAXED) + 1) & ~1u;
+    __atomic_store_n(&seg->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&seg->cal, &cal, sizeof(cal));
+    __atomic_store_n(&seg->seq, seq + 2, __ATOMIC_RELEASE);
+
+    flock(fd, LOCK_UN);
+    return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _shm_publish_hh
+#define _shm_publish_hh
+
+#include "calibrator.hh"
+#include "xinput_calibrator_shm.h"
+
+/*
+ * Writer of the live calibration of one device in shared memory,
+ * see xinput_calibrator_shm.h for the layout and the reader side.
+ *
+ * The segment is kept after exit, so consumers still find the last
+ * calibration; concurrent writers are serialized with flock().
+ */
+class CalibrationPublisher
+{
+public:
+    /// Create or open the segment of the given device
+    CalibrationPublisher(const char* device);
+    ~CalibrationPublisher();
+
+    /// whether the segment could be created
+    bool is_open() const
+    { return seg != NULL; }
+
+    /// publish an evdev style calibration, keeps the matrix if any
+    bool publish(const XYinfo& axys);
+    /// publish a matrix on normalized coordinates, keeps the axes if any
+    bool publish(const float matrix[6]);
+
+private:
+    bool update(const XYinfo* axys, const float* matrix);
+
+    int fd;
+    xicshm_segment* seg;
+    char device[sizeof(((xicshm_calibration*)0)->device)];
+};
+
+#endif
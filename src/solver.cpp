@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "solver.hh"
+#include "recording.hh"
+#include "calibrator/Tester.hpp"
+#include "calibrator/DriverEmulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+/// Calibrator::finish(), through CalibratorTester
+class GenericSolver : public CalibrationSolver
+{
+public:
+    virtual const char* name() const
+    { return "generic"; }
+
+    virtual bool solve(const ClickSet& set, XYinfo& new_axys) const
+    {
+        CalibratorTester calib("solver", set.old_axys);
+        return run(calib, set, new_axys);
+    }
+
+protected:
+    static bool run(Calibrator& calib, const ClickSet& set, XYinfo& new_axys)
+    {
+        for (int i = 0; i != NUM_POINTS; i++)
+            calib.add_click(set.x[i], set.y[i]);
+        if (!calib.finish(set.width, set.height))
+            return false;
+        new_axys = calib.get_calibrated_axys();
+        return true;
+    }
+};
+
+/// CalibratorEvdev::finish(), through its driver policy
+class EvdevSolver : public GenericSolver
+{
+public:
+    virtual const char* name() const
+    { return "evdev"; }
+
+    virtual bool solve(const ClickSet& set, XYinfo& new_axys) const
+    {
+        CalibratorDriverTester<Evdev270Driver> calib("solver", set.old_axys);
+        return run(calib, set, new_axys);
+    }
+
+    virtual bool supports(const ClickSet&) const
+    { return true; }
+};
+
+/// only the upper-left and lower-right clicks, as 2-point calibrations do
+class TwoPointSolver : public GenericSolver
+{
+public:
+    virtual const char* name() const
+    { return "two-point"; }
+
+    virtual bool solve(const ClickSet& set, XYinfo& new_axys) const
+    {
+        ClickSet corners(set);
+        corners.x[UR] = set.x[LR]; corners.y[UR] = set.y[UL];
+        corners.x[LL] = set.x[UL]; corners.y[LL] = set.y[LR];
+        CalibratorTester calib("solver", set.old_axys);
+        return run(calib, corners, new_axys);
+    }
+
+    /// a swap mirrors the screen about the diagonal both clicks lie on:
+    /// it can not be seen, so sets known to be swapped are left out
+    virtual bool supports(const ClickSet& set) const
+    { return CalibrationSolver::supports(set) && !(set.has_truth && set.truth.swap_xy); }
+};
+
+static std::vector<const CalibrationSolver*> make_solvers()
+{
+    static const GenericSolver generic;
+    static const EvdevSolver evdev;
+    static const TwoPointSolver two_point;
+    std::vector<const CalibrationSolver*> solvers;
+    solvers.push_back(&generic);
+    solvers.push_back(&evdev);
+    solvers.push_back(&two_point);
+    return solvers;
+}
+
+// built in one initialization, so concurrent first calls are safe
+const std::vector<const CalibrationSolver*>& get_solvers()
+{
+    static const std::vector<const CalibrationSolver*> solvers = make_solvers();
+    return solvers;
+}
+
+// raw device value of a screen coordinate, the way the X server maps it;
+// the invert flags mirror the axis range
+static float to_raw(float v, const AxisInfo& axis, int size)
+{
+    if (axis.invert)
+        return scaleAxis(v, axis.min, axis.max, size, 0);
+    return scaleAxis(v, axis.max, axis.min, size, 0);
+}
+static float to_screen(float raw, const AxisInfo& axis, int size)
+{
+    if (axis.invert)
+        return scaleAxis(raw, size, 0, axis.min, axis.max);
+    return scaleAxis(raw, size, 0, axis.max, axis.min);
+}
+
+static bool is_degenerate(const XYinfo& axys)
+{
+    return axys.x.min == axys.x.max || axys.y.min == axys.y.max;
+}
+
+bool point_error(const ClickSet& set, const XYinfo& new_axys,
+                 float px, float py, double& error)
+{
+    if (!set.has_truth || is_degenerate(new_axys))
+        return false;
+
+    // where a touch at (px, py) ends up: its raw values, swapped back
+    // to the device axes when the truth swaps them, then through new_axys
+    float a = to_raw(px, set.truth.x, set.width);
+    float b = to_raw(py, set.truth.y, set.height);
+    if (set.truth.swap_xy != new_axys.swap_xy)
+        std::swap(a, b);
+    const float sx = to_screen(a, new_axys.x, set.width);
+    const float sy = to_screen(b, new_axys.y, set.height);
+    error = sqrt((sx - px)*(sx - px) + (sy - py)*(sy - py));
+    return true;
+}
+
+bool calibration_error(const ClickSet& set, const XYinfo& new_axys,
+                       double& rms, double& max)
+{
+    if (is_degenerate(new_axys))
+        return false;
+
+    double sum = 0;
+    int n = 0;
+    max = 0;
+
+    if (set.has_truth) {
+        const int grid = 9;
+        for (int j = 0; j != grid; j++) {
+            for (int i = 0; i != grid; i++) {
+                double error;
+                point_error(set, new_axys, i * (set.width - 1) / (float)(grid - 1),
+                            j * (set.height - 1) / (float)(grid - 1), error);
+                sum += error * error;
+                max = std::max(max, error * error);
+                n++;
+            }
+        }
+    } else {
+        // where the clicks would have ended up, see Calibrator::remap_click()
+        for (int i = 0; i != NUM_POINTS; i++) {
+            int tx, ty;
+            get_calibration_target(i, set.width, set.height, tx, ty);
+            float a = to_raw(set.x[i], set.old_axys.x, set.width);
+            float b = to_raw(set.y[i], set.old_axys.y, set.height);
+            if (new_axys.swap_xy != set.old_axys.swap_xy)
+                std::swap(a, b);
+            const float sx = to_screen(a, new_axys.x, set.width);
+            const float sy = to_screen(b, new_axys.y, set.height);
+            const double d2 = (sx - tx)*(sx - tx) + (sy - ty)*(sy - ty);
+            sum += d2;
+            max = std::max(max, d2);
+            n++;
+        }
+    }
+
+    rms = sqrt(sum / n);
+    max = sqrt(max);
+    return true;
+}
+
+bool load_click_sets(const char* file, std::vector<ClickSet>& sets)
+{
+    SessionReader reader;
+    if (!reader.open(file))
+        return false;
+
+    SessionRecord rec;
+    ClickSet set;
+    set.has_truth = false;
+    int session = 0, num = 0;
+    while (reader.next(rec)) {
+        switch (rec.type) {
+            case REC_SESSION:
+                set.backend = rec.backend;
+                set.old_axys = rec.old_axys;
+                session++;
+                num = 0;
+                break;
+            case REC_CLICK:
+                if (rec.decision == CLICK_MISCLICK) {
+                    num = 0;
+                } else if (rec.decision == CLICK_ACCEPTED && num < NUM_POINTS) {
+                    set.x[num] = rec.x;
+                    set.y[num] = rec.y;
+                    num++;
+                }
+                break;
+            case REC_RESET:
+                num = 0;
+                break;
+            case REC_FINISH:
+                if (num == NUM_POINTS && rec.width > 0 && rec.height > 0) {
+                    char source[32];
+                    snprintf(source, sizeof(source), ":%i", session);
+                    set.source = std::string(file) + source;
+                    set.width = rec.width;
+                    set.height = rec.height;
+                    sets.push_back(set);
+                }
+                break;
+            case REC_RESULT:
+            case REC_VERIFY:
+            case REC_VERIFIED:
+                break;
+        }
+    }
+
+    if (reader.is_corrupt()) {
+        fprintf(stderr, "Error: corrupt record in '%s'.\n", file);
+        return false;
+    }
+    return true;
+}
+
+// 64-bit constants without 'long long' literals, those are not C++98
+#define U64(hi, lo) (((uint64_t)(hi) << 32) | (uint64_t)(lo))
+
+uint64_t SplitMix64::next()
+{
+    uint64_t z = (state += U64(0x9E3779B9, 0x7F4A7C15));
+    z = (z ^ (z >> 30)) * U64(0xBF58476D, 0x1CE4E5B9);
+    z = (z ^ (z >> 27)) * U64(0x94D049BB, 0x133111EB);
+    return z ^ (z >> 31);
+}
+
+double SplitMix64::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double SplitMix64::gaussian()
+{
+    // Box-Muller, one of the pair is enough here
+    const double u1 = 1.0 - uniform();
+    const double u2 = uniform();
+    return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+}
+
+void make_synthetic_set(SplitMix64& rng, const NoiseModel& noise, ClickSet& set)
+{
+    static const int screens[][2] = {
+        {800, 480}, {1024, 768}, {1280, 800}, {1920, 1080}, {3840, 2160}
+    };
+    const int s = rng.next() % (sizeof(screens)/sizeof(screens[0]));
+    set.source = "synthetic";
+    set.width = screens[s][0];
+    set.height = screens[s][1];
+
+    // uncalibrated 12-bit device, whose touch surface covers less than
+    // the screen and may be mounted mirrored or turned (swapped axes);
+    // its current calibration may invert the axes, as evdev does
+    set.old_axys = XYinfo(0, 4095, 0, 4095);
+    set.old_axys.x.invert = rng.uniform() < 0.25;
+    set.old_axys.y.invert = rng.uniform() < 0.25;
+    set.backend = (set.old_axys.x.invert || set.old_axys.y.invert) ?
+                  BACKEND_EVDEV : BACKEND_GENERIC;
+    set.has_truth = true;
+    set.truth = XYinfo(rng.next() % 400, 4095 - rng.next() % 400,
+                       rng.next() % 400, 4095 - rng.next() % 400);
+    if (rng.uniform() < 0.25)
+        std::swap(set.truth.x.min, set.truth.x.max);
+    if (rng.uniform() < 0.25)
+        std::swap(set.truth.y.min, set.truth.y.max);
+    set.truth.swap_xy = rng.uniform() < 0.25;
+
+    // touch the targets, the device then reports the raw values
+    for (int i = 0; i != NUM_POINTS; i++) {
+        int tx, ty;
+        get_calibration_target(i, set.width, set.height, tx, ty);
+        double px = tx + noise.bias_x + noise.jitter * rng.gaussian();
+        double py = ty + noise.bias_y + noise.jitter * rng.gaussian();
+        if (noise.outlier_rate > 0 && rng.uniform() < noise.outlier_rate) {
+            px += noise.outlier_size * (2 * rng.uniform() - 1);
+            py += noise.outlier_size * (2 * rng.uniform() - 1);
+        }
+
+        float rx = to_raw(px, set.truth.x, set.width);
+        float ry = to_raw(py, set.truth.y, set.height);
+        if (noise.quantization > 0) {
+            // in raw units: the pixel resolution scaled to the device range
+            const double qx = noise.quantization * fabs(set.truth.x.max - set.truth.x.min) / set.width;
+            const double qy = noise.quantization * fabs(set.truth.y.max - set.truth.y.min) / set.height;
+            rx = qx * floor(rx / qx + 0.5);
+            ry = qy * floor(ry / qy + 0.5);
+        }
+        // the device axes, as the truth sees them swapped
+        if (set.truth.swap_xy)
+            std::swap(rx, ry);
+
+        set.x[i] = (int) floor(to_screen(rx, set.old_axys.x, set.width) + 0.5);
+        set.y[i] = (int) floor(to_screen(ry, set.old_axys.y, set.height) + 0.5);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _solver_hh
+#define _solver_hh
+
+#include "calibrator.hh"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/// The clicks of one calibration, as passed to finish()
+struct ClickSet {
+    /// where it comes from, eg. file:session
+    std::string source;
+    /// the backend it was recorded with; synthetic sets are evdev ones
+    /// when their old axes are inverted, generic otherwise
+    CalibratorBackend backend;
+    XYinfo old_axys;
+    int width, height;
+    /// the accepted clicks, in the order UL, UR, LL, LR
+    int x[NUM_POINTS], y[NUM_POINTS];
+    /// synthetic sets know the calibration they should find
+    bool has_truth;
+    XYinfo truth;
+};
+
+/*
+ * A way to compute a new calibration from a click set.
+ *
+ * Solvers are stateless (they may run concurrently on different sets);
+ * add new ones to get_solvers() to include them in xinput_calibrator_shootout.
+ */
+class CalibrationSolver
+{
+public:
+    virtual ~CalibrationSolver() {}
+
+    virtual const char* name() const = 0;
+
+    /// compute the new axys, returns false on failure
+    virtual bool solve(const ClickSet& set, XYinfo& new_axys) const = 0;
+
+    /// whether solve() understands the set; only evdev inverts axes
+    virtual bool supports(const ClickSet& set) const
+    { return !set.old_axys.x.invert && !set.old_axys.y.invert; }
+};
+
+/// all known solvers
+const std::vector<const CalibrationSolver*>& get_solvers();
+
+
+/// error of a calibration in pixels: against the truth on a grid over the
+/// screen for synthetic sets, otherwise between the targets and the clicks
+/// remapped to the new axys; returns false if the axys are degenerate
+bool calibration_error(const ClickSet& set, const XYinfo& new_axys,
+                       double& rms, double& max);
+
+/// error in pixels of a touch at screen point (px, py), for synthetic sets
+bool point_error(const ClickSet& set, const XYinfo& new_axys,
+                 float px, float py, double& error);
+
+/// append the click sets of every finish() in a recording (see recording.hh),
+/// returns false if it could not be read
+bool load_click_sets(const char* file, std::vector<ClickSet>& sets);
+
+/// splitmix64, small and good enough for seeded simulations
+class SplitMix64
+{
+public:
+    SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next();
+    /// uniform in [0, 1)
+    double uniform();
+    /// standard normal
+    double gaussian();
+
+private:
+    uint64_t state;
+};
+
+/// How synthetic clicks deviate from the targets, in pixels
+struct NoiseModel {
+    /// standard deviation of the Gaussian jitter
+    double jitter;
+    /// constant offset, eg. parallax
+    double bias_x, bias_y;
+    /// the device resolution, clicks are rounded to multiples of it (0=off)
+    double quantization;
+    /// probability of a gross outlier, and its maximal size
+    double outlier_rate, outlier_size;
+
+    NoiseModel(double jitter0 = 0)
+      : jitter(jitter0), bias_x(0), bias_y(0), quantization(0),
+        outlier_rate(0), outlier_size(0) {}
+};
+
+/// a random calibration, clicked with the given noise
+void make_synthetic_set(SplitMix64& rng, const NoiseModel& noise, ClickSet& set);
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef _sweep_hh
+#define _sweep_hh
+
+#include "calibrator.hh"
+#include "calibrator/DriverEmulation.hpp"
+
+#include <algorithm>
+#include <stddef.h>
+
+/// Statistics of a sweep, the error is the largest difference between
+/// a corner of the target rectangle and where the driver puts it
+struct SweepStats {
+    unsigned long runs;
+    /// runs with an error above the slack
+    unsigned long failures;
+    int max_error;
+    double sum_error;
+
+    SweepStats() : runs(0), failures(0), max_error(0), sum_error(0) {}
+
+    double mean_error() const
+    { return runs ? sum_error/runs : 0; }
+};
+
+/*
+ * Calibrate from every old calibration with the clicks of every raw
+ * rectangle (the raw values an exact driver would put on the targets), as
+ * tester.cpp does, but for one driver policy (see DriverEmulation.hpp):
+ * no Calibrator objects, no allocation and no virtual calls.
+ *
+ * The screen is screen.x.max x screen.y.max pixels.
+ */
+template <class Driver>
+void sweep_driver(const XYinfo* old_axes, size_t n_axes,
+                  const XYinfo* raws, size_t n_raws,
+                  const XYinfo& screen, const XYinfo& device,
+                  int slack, SweepStats& stats)
+{
+    const int width = screen.x.max, height = screen.y.max;
+    const int delta_x = width/(float)num_blocks;
+    const int delta_y = height/(float)num_blocks;
+    const XYinfo target(delta_x, width-delta_x, delta_y, height-delta_y);
+
+    for (size_t a = 0; a != n_axes; a++) {
+        const XYinfo& old_axys = old_axes[a];
+
+        for (size_t r = 0; r != n_raws; r++) {
+            const XYinfo& raw = raws[r];
+
+            // clicked from raw, with the old calibration
+            const XYinfo clicked = driver_emulate<Driver>(raw, old_axys, screen, device);
+            const int x[NUM_POINTS] = {clicked.x.min, clicked.x.max, clicked.x.min, clicked.x.max};
+            const int y[NUM_POINTS] = {clicked.y.min, clicked.y.min, clicked.y.max, clicked.y.max};
+
+            const XYinfo new_axys = Driver::calibrate(old_axys, x, y, width, height);
+            const XYinfo result = driver_emulate<Driver>(raw, new_axys, screen, device);
+
+            int diff = abs(target.x.min - result.x.min);
+            diff = std::max(diff, abs(target.x.max - result.x.max));
+            diff = std::max(diff, abs(target.y.min - result.y.min));
+            diff = std::max(diff, abs(target.y.max - result.y.max));
+
+            stats.runs++;
+            stats.sum_error += diff;
+            if (diff > stats.max_error)
+                stats.max_error = diff;
+            if (diff > slack)
+                stats.failures++;
+        }
+    }
+}
+
+#endif
@@ -1,10 +1,275 @@
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 #include <vector>
 
 #include "calibrator.hh"
+#include "correction.hh"
+#include "inventory.hh"
+#include "recording.hh"
+#include "shm_publish.hh"
+#include "solver.hh"
+#include "sweep.hh"
+#include "xinput_calibrator.h"
 #include "calibrator/Tester.hpp"
+#include "calibrator/EvdevAxys.hpp"
 #include "calibrator/EvdevTester.hpp"
+#include "calibrator/FinishPipeline.hpp"
+#include "xserver/FakeXServer.hpp"
+#ifdef HAVE_LINUX_FB_H
+#include "gui/fb.hpp"
+#endif
+#if defined(HAVE_LINUX_UINPUT_H) && defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_SIGNALFD_H)
+#define TEST_PROXY
+#include "proxy.hh"
+#endif
+
+#include <X11/extensions/XInput.h>
+
+#ifdef TEST_PROXY
+// fill 'ev' with the events {type, code, value}, returns their number
+static int make_events(input_event* ev, const int events[][3], int n)
+{
+    memset(ev, 0, n * sizeof(input_event));
+    for (int i = 0; i != n; i++) {
+        ev[i].type = events[i][0];
+        ev[i].code = events[i][1];
+        ev[i].value = events[i][2];
+    }
+    return n;
+}
+
+// a raw value through an evdev style calibration of 'axis' to 0..4095
+static int proxy_scale(int v, const AxisInfo& axis)
+{
+    return (int) floor((v - axis.min) * 4095.0 / (axis.max - axis.min) + 0.5);
+}
+#endif
+
+// pincushion deformation, up to 12 pixels in the corners
+static int bow_x(int x, int y, int width, int height) {
+    float dy = (y - height/2.0) / (height/2.0);
+    return (int) (0.03 * (x - width/2.0) * dy*dy);
+}
+static int bow_y(int x, int y, int width, int height) {
+    float dx = (x - width/2.0) / (width/2.0);
+    return (int) (0.03 * (y - height/2.0) * dx*dx);
+}
+
+// the steps of calc_axys_float() on one axis, in long double
+static long double reference_axis(long double c_min, long double c_max,
+                                  const AxisInfo& old, int size) {
+    const long double block = size/(long double)num_blocks;
+    const long double scale = (c_max - c_min)/(size - 2*block);
+    return (old.max - old.min)*(c_min - block*scale)/size + old.min;
+}
+static void reference_axys(const XYinfo& old, const int* x, const int* y,
+                           int width, int height, bool evdev, long double v[4]) {
+    const bool swap = get_orientation_info(detect_orientation(x, y)).swap_xy;
+    long double x_min = swap ? (x[UL] + x[UR])/2.0L : (x[UL] + x[LL])/2.0L;
+    long double x_max = swap ? (x[LL] + x[LR])/2.0L : (x[UR] + x[LR])/2.0L;
+    long double y_min = swap ? (y[UL] + y[LL])/2.0L : (y[UL] + y[UR])/2.0L;
+    long double y_max = swap ? (y[UR] + y[LR])/2.0L : (y[LL] + y[LR])/2.0L;
+    if (evdev && old.x.invert) {
+        x_min = width - x_min;
+        x_max = width - x_max;
+    }
+    if (evdev && old.y.invert) {
+        y_min = height - y_min;
+        y_max = height - y_max;
+    }
+    v[0] = reference_axis(x_min, x_max, old.x, width);
+    v[1] = reference_axis(x_max, x_min, old.x, width);
+    v[2] = reference_axis(y_min, y_max, old.y, height);
+    v[3] = reference_axis(y_max, y_min, old.y, height);
+    if (swap) {
+        std::swap(v[0], v[2]);
+        std::swap(v[1], v[3]);
+    }
+}
+// the fixed-point calibration against the reference and the float one
+static bool check_fixed(const XYinfo& fixed, const XYinfo& flt, const XYinfo& old,
+                        const int* x, const int* y, int width, int height, bool evdev) {
+    long double ref[4];
+    reference_axys(old, x, y, width, height, evdev, ref);
+    const int f[4] = {fixed.x.min, fixed.x.max, fixed.y.min, fixed.y.max};
+    const int g[4] = {flt.x.min, flt.x.max, flt.y.min, flt.y.max};
+    int max_click = 0;
+    for (int i = 0; i != NUM_POINTS; i++)
+        max_click = std::max(max_click, std::max(abs(x[i]), abs(y[i])));
+
+    if (fixed.swap_xy != flt.swap_xy || fixed.x.invert != flt.x.invert ||
+        fixed.y.invert != flt.y.invert)
+        return false;
+    for (int i = 0; i != 4; i++) {
+        // exact ties are fractions with a denominator of 12*size
+        const long double tie = fabsl(fabsl(ref[i] - floorl(ref[i])) - 0.5L);
+        const int exact = tie < 1e-9L ? (ref[i] < 0 ? (int) floorl(ref[i]) : (int) ceill(ref[i]))
+                                      : (int) floorl(ref[i] + 0.5L);
+        const double bound = Calibrator::float_tie_bound(i < 2 ? old.x : old.y, max_click,
+                                                         i < 2 ? width : height);
+        if (f[i] != exact || (g[i] != f[i] && (tie > bound || fabsl(g[i] - ref[i]) > bound + 0.5))) {
+            printf("Error: value %i: fixed %i, float %i, exact %.6Lf (bound %g)\n",
+                   i, f[i], g[i], ref[i], bound);
+            return false;
+        }
+    }
+    return true;
+}
+
+// keeps the timed pipelines from being optimized away
+static volatile double pipeline_sink;
+
+// nanoseconds per click set of a finish pipeline (prefix)
+template <class Pipeline, class State>
+static double time_pipeline(const char* name, const std::vector<ClickSet>& sets) {
+    const int rounds = 20;
+    timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int r = 0; r != rounds; r++) {
+        for (unsigned i = 0; i != sets.size(); i++) {
+            const ClickSet& set = sets[i];
+            State st(set.old_axys);
+            Pipeline::apply(FinishInput(set.old_axys, set.x, set.y, set.width, set.height), st);
+            pipeline_sink = st.x_min + st.new_axis.x.min;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    const double ns = ((t1.tv_sec - t0.tv_sec)*1e9 + (t1.tv_nsec - t0.tv_nsec)) / (rounds*sets.size());
+    printf("\t%-24s %6.1f ns\n", name, ns);
+    return ns;
+}
+
+// a touchscreen mounted turned by 'info': each target touched, clicked through
+// the old calibration, calibrated, and processed again lands on the target
+template <class Driver>
+static bool check_mount(const OrientationInfo& info, const XYinfo& old,
+                        const XYinfo& screen, const XYinfo& device, int slack,
+                        XYinfo& new_axis) {
+    const int width = screen.x.max, height = screen.y.max;
+    int tx[NUM_POINTS], ty[NUM_POINTS], x[NUM_POINTS], y[NUM_POINTS];
+    int raw_x[NUM_POINTS], raw_y[NUM_POINTS];
+    for (int i = 0; i != NUM_POINTS; i++) {
+        get_calibration_target(i, width, height, tx[i], ty[i]);
+        // target relative to the center, turned, with some jitter
+        const float a = (tx[i] - width/2.0f)/width, b = (ty[i] - height/2.0f)/height;
+        float pa = info.swap_xy ? b : a, pb = info.swap_xy ? a : b;
+        if (info.swap_xy ? info.invert_y : info.invert_x) pa = -pa;
+        if (info.swap_xy ? info.invert_x : info.invert_y) pb = -pb;
+        raw_x[i] = (int) ((pa + 0.5f)*device.x.max) + (i*7) % 5 - 2;
+        raw_y[i] = (int) ((pb + 0.5f)*device.y.max) + (i*3) % 5 - 2;
+
+        const XYinfo raw(raw_x[i], raw_x[i], raw_y[i], raw_y[i]);
+        const XYinfo clicked = driver_emulate<Driver>(raw, old, screen, device);
+        x[i] = clicked.x.min;
+        y[i] = clicked.y.min;
+    }
+
+    new_axis = Driver::calibrate(old, x, y, width, height);
+    for (int i = 0; i != NUM_POINTS; i++) {
+        const XYinfo raw(raw_x[i], raw_x[i], raw_y[i], raw_y[i]);
+        const XYinfo result = driver_emulate<Driver>(raw, new_axis, screen, device);
+        // plus the jitter, up to 2 device units
+        if (abs(result.x.min - tx[i]) > slack + 2 || abs(result.y.min - ty[i]) > slack + 2)
+            return false;
+    }
+    return true;
+}
+
+// the writer and the readers of the shared memory check: every snapshot
+// the readers take must be the one the writer published as its generation,
+// never a mix of two. The writer publishes the axes k, then a matrix of k's,
+// for k=1, 2, ... from generation 'first' (of k=0)
+struct ShmRace {
+    const char* device;
+    const xicshm_segment* seg;
+    uint32_t first;
+    int done;
+    long reads;
+    bool torn;
+};
+static void* shm_writer(void* arg) {
+    ShmRace* race = (ShmRace*) arg;
+    CalibrationPublisher publisher(race->device);
+    for (int k = 1; k != 50000; k++) {
+        const float matrix[6] = {(float)k, (float)k, (float)k, (float)k, (float)k, (float)k};
+        publisher.publish(XYinfo(k, k + 1, k + 2, k + 3, k & 1, k & 2, k & 4));
+        publisher.publish(matrix);
+    }
+    __atomic_store_n(&race->done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+static void* shm_reader(void* arg) {
+    ShmRace* race = (ShmRace*) arg;
+    uint32_t last = 0;
+    long reads = 0;
+    while (!__atomic_load_n(&race->done, __ATOMIC_ACQUIRE)) {
+        xicshm_calibration cal;
+        uint32_t gen;
+        if (xicshm_read(race->seg, &cal, &gen) != 0) {
+            __atomic_store_n(&race->torn, true, __ATOMIC_RELAXED);
+            break;
+        }
+        const int k = (gen - race->first + 1) / 2;
+        const float matrix_k = ((gen - race->first) & 1) ? k - 1 : k;
+        if (gen < last || cal.min_x != k ||
+            cal.max_x != k + 1 || cal.min_y != k + 2 || cal.max_y != k + 3 ||
+            cal.swap_xy != (k & 1) || cal.invert_x != ((k & 2) != 0) ||
+            cal.invert_y != ((k & 4) != 0) ||
+            cal.matrix[0] != matrix_k || cal.matrix[5] != matrix_k) {
+            __atomic_store_n(&race->torn, true, __ATOMIC_RELAXED);
+            break;
+        }
+        last = gen;
+        reads++;
+    }
+    __atomic_fetch_add(&race->reads, reads, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// one thread of the reentrancy check: every old axis and raw coordinate
+// through both calibrators, each with the context of the job
+struct ReentrancyJob {
+    const std::vector<XYinfo>* old_axes;
+    const std::vector<XYinfo>* raw_coords;
+    CalibratorContext context;
+    std::vector<XYinfo> results;
+    bool own_context;
+};
+static void* run_calibrations(void* arg) {
+    ReentrancyJob* job = (ReentrancyJob*) arg;
+    const XYinfo screen_res(0, 800, 0, 600), dev_res(0, 1000, 0, 1000);
+    job->own_context = true;
+    for (unsigned a = 0; a != job->old_axes->size(); a++) {
+        for (unsigned c = 0; c != job->raw_coords->size(); c++) {
+            const XYinfo& raw = (*job->raw_coords)[c];
+            CalibratorTester generic("Tester", (*job->old_axes)[a], 0, 0,
+                                     OUTYPE_AUTO, 0, job->context);
+            CalibratorEvdevTester evdev("Tester", (*job->old_axes)[a], 0, 0,
+                                        OUTYPE_AUTO, 0, job->context);
+            CalibratorTesterInterface* calibs[2] = {&generic, &evdev};
+            for (int t = 0; t != 2; t++) {
+                XYinfo clicked = calibs[t]->emulate_driver(raw, false, screen_res, dev_res);
+                calibs[t]->add_click(clicked.x.min, clicked.y.min);
+                calibs[t]->add_click(clicked.x.max, clicked.y.min);
+                calibs[t]->add_click(clicked.x.min, clicked.y.max);
+                calibs[t]->add_click(clicked.x.max, clicked.y.max);
+                calibs[t]->finish(800, 600);
+                job->results.push_back(calibs[t]->emulate_driver(raw, true, screen_res, dev_res));
+            }
+            if (generic.get_context().sysfs_input != job->context.sysfs_input ||
+                evdev.get_context().sysfs_input != job->context.sysfs_input)
+                job->own_context = false;
+        }
+    }
+    return NULL;
+}
 
 int main() {
     // screen dimensions
@@ -119,4 +384,1021 @@ int main() {
     } // loop over calibrators
 
     delete calib;
+
+    // non-linear correction: a panel that bows near the edges
+    printf("CorrectionGrid\n");
+    const int grid_n = 9;
+    std::vector<int> grid_tx, grid_ty, grid_cx, grid_cy;
+    for (int row = 0; row != grid_n; row++) {
+        for (int col = 0; col != grid_n; col++) {
+            int tx = target.x.min + col * (target.x.max - target.x.min) / (grid_n - 1);
+            int ty = target.y.min + row * (target.y.max - target.y.min) / (grid_n - 1);
+            grid_tx.push_back(tx);
+            grid_ty.push_back(ty);
+            grid_cx.push_back(tx + bow_x(tx, ty, width, height));
+            grid_cy.push_back(ty + bow_y(tx, ty, width, height));
+        }
+    }
+    CorrectionGrid grid;
+    if (grid.fit(grid_n, grid_n, grid_tx, grid_ty, grid_cx, grid_cy, 1 << 20, height) ||
+        grid.fit(grid_n, grid_n, grid_tx, grid_ty, grid_cx, grid_cy, width, -1)) {
+        printf("Error: fitted the correction grid for an impossible screen\n");
+        exit(1);
+    }
+    if (!grid.fit(grid_n, grid_n, grid_tx, grid_ty, grid_cx, grid_cy, width, height)) {
+        printf("Error: unable to fit the correction grid\n");
+        exit(1);
+    }
+
+    char grid_file[] = "/tmp/tester_grid_XXXXXX";
+    int fd = mkstemp(grid_file);
+    CorrectionGrid loaded;
+    if (fd < 0 || !grid.save(grid_file) || !loaded.load(grid_file)) {
+        printf("Error: unable to save and load the correction grid\n");
+        exit(1);
+    }
+    // and through the library
+    xicalib_correction* lib_grid = xicalib_correction_load(grid_file);
+    int lib_w = 0, lib_h = 0;
+    if (lib_grid != NULL)
+        xicalib_correction_size(lib_grid, &lib_w, &lib_h);
+    if (lib_w != width || lib_h != height) {
+        printf("Error: unable to load the correction grid through the library\n");
+        exit(1);
+    }
+
+    // headers of grids too large to allocate, or to count the nodes of
+    const int32_t huge_grids[2][5] = {
+        {32768, 32768, 0, 32769, 32769},
+        {0x7fffffff, 1, 0, 0x40000001, 2},
+    };
+    for (int i = 0; i != 2; i++) {
+        FILE* f = fopen(grid_file, "wb");
+        unsigned char header[28] = {'X', 'I', 'C', 'G', 1, 0, 0, 0};
+        for (int j = 0; j != 5; j++)
+            for (int b = 0; b != 4; b++)
+                header[8 + 4*j + b] = (huge_grids[i][j] >> (8*b)) & 0xff;
+        CorrectionGrid huge;
+        if (f == NULL || fwrite(header, sizeof(header), 1, f) != 1 || fclose(f) != 0 ||
+            huge.load(grid_file, false) || xicalib_correction_load(grid_file) != NULL) {
+            printf("Error: correction grid %i of an impossible size loaded\n", i);
+            exit(1);
+        }
+    }
+    close(fd);
+    unlink(grid_file);
+
+    int grid_maxdiff = 0;
+    for (int y = target.y.min; y <= target.y.max; y += 5) {
+        for (int x = target.x.min; x <= target.x.max; x += 5) {
+            int cx = x + bow_x(x, y, width, height);
+            int cy = y + bow_y(x, y, width, height);
+            int lx = cx, ly = cy;
+            int ax = cx, ay = cy;
+            grid.correct(cx, cy);
+            loaded.correct(lx, ly);
+            xicalib_correction_apply(lib_grid, &ax, &ay);
+            if (lx != cx || ly != cy || ax != cx || ay != cy) {
+                printf("Error: loaded grid differs at (%i, %i)\n", x, y);
+                exit(1);
+            }
+            grid_maxdiff = std::max(grid_maxdiff, std::max(abs(cx - x), abs(cy - y)));
+        }
+    }
+    if (grid_maxdiff > slack) {
+        printf("Error: difference between target and corrected click: %i > %i\n", grid_maxdiff, slack);
+        exit(1);
+    }
+    xicalib_correction_free(lib_grid);
+    printf("%i. OK\n", grid_maxdiff);
+
+    // shared memory publication, read back through the public reader
+    printf("CalibrationPublisher\n");
+    char shm_device[64];
+    snprintf(shm_device, sizeof(shm_device), "tester %i", (int)getpid());
+    {
+        CalibrationPublisher publisher(shm_device);
+        const XYinfo shm_axys(10, 990, 20, 980, true, false, true);
+        const float shm_matrix[6] = {1, 0, 0.5f, 0, -1, 1};
+        const xicshm_segment* seg = NULL;
+        xicshm_calibration cal;
+        if (!publisher.publish(shm_axys) || (seg = xicshm_open(shm_device)) == NULL) {
+            printf("Error: unable to publish the calibration in shared memory\n");
+            exit(1);
+        }
+        uint32_t gen = 0, new_gen = 0;
+        if (xicshm_read(seg, &cal, &gen) != 0) {
+            printf("Error: unable to read the published calibration\n");
+            exit(1);
+        }
+        publisher.publish(shm_matrix);
+        if (xicshm_generation(seg) == gen || xicshm_read(seg, &cal, &new_gen) != 0 ||
+            new_gen == gen ||
+            cal.flags != (XICSHM_HAS_AXES | XICSHM_HAS_MATRIX) ||
+            cal.min_x != 10 || cal.max_y != 980 || !cal.swap_xy || cal.invert_x || !cal.invert_y ||
+            memcmp(cal.matrix, shm_matrix, sizeof(shm_matrix)) != 0 ||
+            strcmp(cal.device, shm_device) != 0) {
+            printf("Error: published calibration differs\n");
+            exit(1);
+        }
+
+        // readers racing a writer
+        const float zero_matrix[6] = {0, 0, 0, 0, 0, 0};
+        publisher.publish(XYinfo(0, 1, 2, 3));
+        publisher.publish(zero_matrix);
+        ShmRace race = {shm_device, seg, xicshm_generation(seg), 0, 0, false};
+        pthread_t shm_threads[4];
+        for (int i = 0; i != 4; i++) {
+            if (pthread_create(&shm_threads[i], NULL, i == 0 ? shm_writer : shm_reader, &race) != 0) {
+                printf("Error: unable to start the shared memory threads\n");
+                exit(1);
+            }
+        }
+        for (int i = 0; i != 4; i++)
+            pthread_join(shm_threads[i], NULL);
+        if (race.torn || race.reads == 0) {
+            printf("Error: torn or failed read of the shared memory (%li reads)\n", race.reads);
+            exit(1);
+        }
+
+        // a writer that died while updating: readers give up,
+        // until the next update
+        char seg_name[256];
+        xicshm_segment_name(shm_device, seg_name, sizeof(seg_name));
+        const int seg_fd = shm_open(seg_name, O_RDWR, 0);
+        xicshm_segment* dead = (xicshm_segment*) (seg_fd < 0 ? MAP_FAILED :
+            mmap(NULL, sizeof(xicshm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, seg_fd, 0));
+        if (dead == MAP_FAILED) {
+            printf("Error: unable to map the shared memory\n");
+            exit(1);
+        }
+        close(seg_fd);
+        __atomic_fetch_or(&dead->seq, 1, __ATOMIC_RELEASE);
+        if (xicshm_read(seg, &cal, NULL) != -1 || !publisher.publish(shm_axys) ||
+            xicshm_read(seg, &cal, NULL) != 0 || cal.min_x != 10) {
+            printf("Error: wrong read of the shared memory of a dead writer\n");
+            exit(1);
+        }
+        munmap(dead, sizeof(xicshm_segment));
+        xicshm_close(seg);
+    }
+    char shm_name[256];
+    xicshm_segment_name(shm_device, shm_name, sizeof(shm_name));
+    shm_unlink(shm_name);
+    printf("OK\n");
+
+    // session recording, read back
+    printf("SessionRecorder\n");
+    char rec_file[] = "/tmp/tester_rec_XXXXXX";
+    fd = mkstemp(rec_file);
+    XYinfo rec_axys;
+    {
+        CalibratorEvdevTester rec_calib("Tester", old_axes[0], 5, 7);
+        if (fd < 0 || !rec_calib.set_record_output(rec_file)) {
+            printf("Error: unable to record the session\n");
+            exit(1);
+        }
+        rec_calib.add_click(100, 100);
+        rec_calib.add_click(102, 101);  // double-click
+        rec_calib.add_click(900, 100);
+        rec_calib.add_click(100, 700);
+        rec_calib.add_click(900, 700);
+        rec_calib.finish(width, height);
+        // one pixel off every verification target
+        rec_calib.set_threshold_verify(1.5f);
+        for (int i = 0; i != NUM_VERIFY_POINTS; i++) {
+            int tx, ty;
+            rec_calib.get_verify_target(i, width, height, tx, ty);
+            rec_calib.add_verify_click(tx + 1, ty);
+        }
+        if (!rec_calib.verify(width, height)) {
+            printf("Error: the recorded verification failed\n");
+            exit(1);
+        }
+        rec_axys = rec_calib.get_calibrated_axys();
+    }
+    close(fd);
+
+    const SessionRecordType rec_types[] = {REC_SESSION, REC_CLICK, REC_CLICK,
+        REC_CLICK, REC_CLICK, REC_CLICK, REC_FINISH, REC_RESULT,
+        REC_VERIFY, REC_VERIFY, REC_VERIFY, REC_VERIFY, REC_VERIFY, REC_VERIFIED};
+    const int num_rec = sizeof(rec_types)/sizeof(rec_types[0]);
+    SessionReader reader;
+    SessionRecord rec;
+    int n_rec = 0;
+    if (!reader.open(rec_file)) {
+        printf("Error: unable to read the recorded session\n");
+        exit(1);
+    }
+    while (reader.next(rec)) {
+        if (n_rec == num_rec || rec.type != rec_types[n_rec] ||
+            (n_rec == 0 && (rec.device != "Tester" || rec.backend != BACKEND_EVDEV ||
+                            rec.thr_misclick != 5 || rec.thr_doubleclick != 7)) ||
+            (n_rec == 2 && (rec.x != 102 || rec.decision != CLICK_DOUBLECLICK)) ||
+            (n_rec == 6 && (rec.width != width || rec.height != height)) ||
+            (n_rec == 7 && (!rec.success || rec.new_axys.x.min != rec_axys.x.min ||
+                            rec.new_axys.y.max != rec_axys.y.max)) ||
+            (n_rec == 8 && (rec.x != width/2 + 1 || rec.y != height/8)) ||
+            (n_rec == 13 && (rec.threshold_verify != 1.5f || rec.verify_grid != 0 || !rec.success))) {
+            printf("Error: recorded session differs at record %i\n", n_rec);
+            exit(1);
+        }
+        n_rec++;
+    }
+    unlink(rec_file);
+    if (reader.is_corrupt() || n_rec != num_rec) {
+        printf("Error: recorded session is incomplete\n");
+        exit(1);
+    }
+    // a full disk is an error, not a silently truncated recording
+    if (access("/dev/full", W_OK) == 0) {
+        CalibratorTester full_calib("Tester", old_axes[0]);
+        if (full_calib.set_record_output("/dev/full")) {
+            printf("Error: recorded to a full disk\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // latency trace: one timestamp per stage, in order
+    printf("LatencyTrace\n");
+    char trace_file[] = "/tmp/tester_trace_XXXXXX";
+    fd = mkstemp(trace_file);
+    {
+        CalibratorTester trace_calib("Tester", old_axes[0]);
+        if (fd < 0 || !trace_calib.set_latency_trace(trace_file) ||
+            !trace_calib.get_latency_trace()) {
+            printf("Error: unable to write the latency trace\n");
+            exit(1);
+        }
+        trace_calib.trace_latency("receipt");
+        trace_calib.add_click(100, 100);
+        trace_calib.add_click(900, 100);
+        trace_calib.add_click(100, 700);
+        trace_calib.add_click(900, 700);
+        trace_calib.finish(width, height);
+    }
+    close(fd);
+
+    FILE* trace = fopen(trace_file, "r");
+    char stage[16];
+    long usec, prev_usec = 0;
+    const char* trace_stages[] = {"receipt", "finish"};
+    int n_trace = 0;
+    while (trace != NULL && fscanf(trace, "%15s %ld", stage, &usec) == 2) {
+        if (n_trace == 2 || strcmp(stage, trace_stages[n_trace]) != 0 || usec < prev_usec) {
+            printf("Error: latency trace differs at line %i\n", n_trace);
+            exit(1);
+        }
+        prev_usec = usec;
+        n_trace++;
+    }
+    if (trace != NULL)
+        fclose(trace);
+    unlink(trace_file);
+    if (n_trace != 2) {
+        printf("Error: latency trace is incomplete\n");
+        exit(1);
+    }
+    printf("OK\n");
+    // every solver on noiseless synthetic click sets
+    printf("Solvers\n");
+    SplitMix64 rng(1);
+    const std::vector<const CalibrationSolver*>& solvers = get_solvers();
+    for (int i = 0; i != 100; i++) {
+        ClickSet set;
+        make_synthetic_set(rng, NoiseModel(), set);
+        for (unsigned v = 0; v != solvers.size(); v++) {
+            XYinfo solved;
+            double rms, max;
+            if (!solvers[v]->supports(set))
+                continue;
+            if (!solvers[v]->solve(set, solved) || !calibration_error(set, solved, rms, max) ||
+                rms > slack) {
+                printf("Error: solver %s on synthetic set %i\n", solvers[v]->name(), i);
+                printf("\tTruth: "); set.truth.print();
+                printf("\tSolved: "); solved.print();
+                exit(1);
+            }
+        }
+    }
+    printf("OK\n");
+
+    // device discovery and the evdev backend, against an in-memory X server
+    printf("FakeXServer\n");
+    FakeXServer xserver;
+    XYinfo fake_axys(0, 1000, 0, 800);
+    const long fake_calib[] = {0, 1000, 0, 800};
+    const long fake_invert[] = {1, 0};
+    xserver.add_device(2, "Virtual core pointer", IsXPointer, &fake_axys);
+    xserver.add_device(6, "Fake mouse", IsXExtensionPointer);
+    xserver.add_device(9, "Fake touchscreen", IsXExtensionPointer, &fake_axys);
+    xserver.set_property(9, "Evdev Axis Calibration", 32, 4, fake_calib);
+    xserver.set_property(9, "Evdev Axis Inversion", 8, 2, fake_invert);
+    {
+        // by id, only that device is queried
+        if (CalibratorEvdev::find_device_id(&xserver, "Fake touchscreen", false) != 9 ||
+            CalibratorEvdev::find_device_id(&xserver, "6", false) != 6 ||
+            CalibratorEvdev::find_device_id(&xserver, "2", true) != (XID)-1 ||
+            CalibratorEvdev::find_device_id(&xserver, "7", false) != (XID)-1 ||
+            CalibratorEvdev::find_device_id(&xserver, "Nonexistent", false) != (XID)-1 ||
+            xserver.get_num_lists() != 2) {
+            printf("Error: wrong device found on the fake X server\n");
+            exit(1);
+        }
+
+        // inverted X axis, clicks exactly on the targets:
+        // the inversion moves into the calibration
+        CalibratorEvdev evdev("Fake touchscreen", fake_axys, (XID)-1, 0, 0,
+                              OUTYPE_XINPUT, 0, false, 0, &xserver);
+        const int width = 1000, height = 800;
+        evdev.add_click(125, 100);
+        evdev.add_click(875, 100);
+        evdev.add_click(125, 700);
+        evdev.add_click(875, 700);
+        const FakeXServer::Property* calib;
+        const FakeXServer::Property* invert;
+        if (!evdev.finish(width, height) ||
+            (calib = xserver.get_property(9, "Evdev Axis Calibration")) == NULL ||
+            (invert = xserver.get_property(9, "Evdev Axis Inversion")) == NULL ||
+            xserver.get_property(9, "Evdev Axes Swap") != NULL ||
+            xserver.get_num_changes() != 2 || xserver.get_num_syncs() != 1 ||
+            calib->values.size() != 4 || calib->values[0] != 1000 || calib->values[1] != 0 ||
+            calib->values[2] != 0 || calib->values[3] != 800 ||
+            invert->values[0] != 0 || invert->values[1] != 0) {
+            printf("Error: wrong properties on the fake X server\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // the structured --list, against a fake server and a fake sysfs
+    printf("Inventory\n");
+    {
+        FakeXServer listing;
+        const long calib[] = {42, 929, 20, 888};
+        const long swap[] = {1};
+        const long invert[] = {0, 1};
+        listing.add_device(2, "Virtual core pointer", IsXPointer, &dev_res);
+        listing.add_device(6, "Fake mouse", IsXExtensionPointer);
+        listing.add_device(9, "Fake touchscreen", IsXExtensionPointer, &dev_res);
+        listing.add_device(11, "Usbtouchscreen", IsXExtensionPointer, &dev_res);
+        listing.add_device(12, "Serial \"touch\"", IsXExtensionPointer, &dev_res);
+        listing.set_property(9, "Evdev Axis Calibration", 32, 4, calib);
+        listing.set_property(9, "Evdev Axes Swap", 8, 1, swap);
+        listing.set_property(9, "Evdev Axis Inversion", 8, 2, invert);
+
+        char sysfs[] = "/tmp/xinput_calibrator_sysfs.XXXXXX";
+        if (mkdtemp(sysfs) == NULL) {
+            printf("Error: can't create a temporary directory\n");
+            exit(1);
+        }
+        const std::string event3 = std::string(sysfs) + "/event3";
+        (void) mkdir(event3.c_str(), 0700);
+        (void) mkdir((event3 + "/device").c_str(), 0700);
+        FILE* name = fopen((event3 + "/device/name").c_str(), "w");
+        fprintf(name, "Fake touchscreen\n");
+        fclose(name);
+
+        std::vector<DeviceInventory> all = take_inventory(&listing, NULL, sysfs, "device/name");
+        std::vector<DeviceInventory> by_node = take_inventory(&listing, "event3", sysfs, "device/name");
+        const int num_lists = listing.get_num_lists();
+        std::vector<DeviceInventory> by_id = take_inventory(&listing, "12", sysfs, "device/name");
+        FILE* out = tmpfile();
+        print_inventory(out, by_id, LIST_LINES);
+        char line[512] = "";
+        rewind(out);
+        if (fgets(line, sizeof(line), out) == NULL)
+            line[0] = '\0';
+        fclose(out);
+        remove((event3 + "/device/name").c_str());
+        rmdir((event3 + "/device").c_str());
+        rmdir(event3.c_str());
+        rmdir(sysfs);
+
+        if (all.size() != 3 || by_node.size() != 1 || by_id.size() != 1 ||
+            all[0].id != 9 || strcmp(all[0].backend, "evdev") != 0 || all[0].event_node != "event3" ||
+            all[0].calibration.x.min != 42 || all[0].calibration.y.max != 888 ||
+            !all[0].calibration.swap_xy || all[0].calibration.x.invert || !all[0].calibration.y.invert ||
+            strcmp(all[1].backend, "usbtouchscreen") != 0 || !all[1].event_node.empty() ||
+            strcmp(all[2].backend, "xorg") != 0 || by_node[0].id != 9 ||
+            listing.get_num_lists() != num_lists ||
+            strcmp(line, "{\"id\": 12, \"name\": \"Serial \\\"touch\\\"\", \"event\": null, "
+                   "\"backend\": \"xorg\", \"range\": [0, 1000, 0, 1000], "
+                   "\"calibration\": [0, 1000, 0, 1000], \"swap_xy\": false, "
+                   "\"invert_x\": false, \"invert_y\": false}\n") != 0) {
+            printf("Error: wrong inventory: %s", line);
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // following RandR: each point of the panel lands where the turned
+    // screen shows it, one sync per rotation, none for a resize
+    printf("ScreenRotation\n");
+    {
+        FakeXServer rotating;
+        const XYinfo base(42, 929, 20, 888);
+        const long base_calib[] = {42, 929, 20, 888};
+        const long no_swap[] = {0};
+        rotating.add_device(9, "Fake touchscreen", IsXExtensionPointer, &dev_res);
+        rotating.set_property(9, "Evdev Axis Calibration", 32, 4, base_calib);
+        rotating.set_property(9, "Evdev Axes Swap", 8, 1, no_swap);
+        CalibratorEvdev evdev("Fake touchscreen", dev_res, (XID)-1, 0, 0,
+                              OUTYPE_XINPUT, 0, false, 0, &rotating);
+
+        const int turns[4] = {SCREEN_ROTATE_0, SCREEN_ROTATE_90, SCREEN_ROTATE_180, SCREEN_ROTATE_270};
+        const int reflections[3] = {0, SCREEN_REFLECT_X, SCREEN_REFLECT_Y};
+        for (int t = 0; t != 4; t++) {
+            for (int f = 0; f != 3; f++) {
+                const int rotation = turns[t] | reflections[f];
+                const XYinfo axys = evdev.rederive_axys(base, SCREEN_ROTATE_0, rotation);
+                const bool sideways = turns[t] == SCREEN_ROTATE_90 || turns[t] == SCREEN_ROTATE_270;
+                const XYinfo screen(0, sideways ? height : width, 0, sideways ? width : height);
+                for (int i = 1; i != 5; i++) {
+                    // a point on the panel, and the raw value it had with base
+                    const float u = i/5.0f, v = (5 - i)/6.0f;
+                    const int raw_x = base.x.min + (int) (u*(base.x.max - base.x.min));
+                    const int raw_y = base.y.min + (int) (v*(base.y.max - base.y.min));
+                    // where the screen shows it, undoing the reflection then the rotation
+                    float pu = (rotation & SCREEN_REFLECT_X) ? 1 - u : u;
+                    float pv = (rotation & SCREEN_REFLECT_Y) ? 1 - v : v;
+                    float su = pu, sv = pv;
+                    if (turns[t] == SCREEN_ROTATE_90) { su = 1 - pv; sv = pu; }
+                    if (turns[t] == SCREEN_ROTATE_180) { su = 1 - pu; sv = 1 - pv; }
+                    if (turns[t] == SCREEN_ROTATE_270) { su = pv; sv = 1 - pu; }
+
+                    const XYinfo result = driver_emulate<Evdev270Driver>(
+                        XYinfo(raw_x, raw_x, raw_y, raw_y), axys, screen, dev_res);
+                    if (abs(result.x.min - (int) (su*screen.x.max)) > slack ||
+                        abs(result.y.min - (int) (sv*screen.y.max)) > slack) {
+                        printf("Error: rotation %i: (%f, %f) of the panel at %i, %i instead of %i, %i\n",
+                               rotation, u, v, result.x.min, result.y.min,
+                               (int) (su*screen.x.max), (int) (sv*screen.y.max));
+                        printf("\tNew axis: "); axys.print();
+                        exit(1);
+                    }
+                }
+            }
+        }
+
+        // turned, resized only, and back
+        rotating.add_screen_change(SCREEN_ROTATE_90);
+        rotating.add_screen_change(SCREEN_ROTATE_90);
+        rotating.add_screen_change(SCREEN_ROTATE_0);
+        const FakeXServer::Property* calib;
+        const FakeXServer::Property* swap;
+        if (!evdev.follow_screen_changes() ||
+            rotating.get_num_syncs() != 2 || rotating.get_num_changes() != 4 ||
+            (calib = rotating.get_property(9, "Evdev Axis Calibration")) == NULL ||
+            (swap = rotating.get_property(9, "Evdev Axes Swap")) == NULL ||
+            swap->values[0] != 0 || abs(calib->values[0] - base.x.min) > 1 ||
+            abs(calib->values[1] - base.x.max) > 1 || abs(calib->values[2] - base.y.min) > 1 ||
+            abs(calib->values[3] - base.y.max) > 1) {
+            printf("Error: wrong properties after following the screen rotation\n");
+            exit(1);
+        }
+
+        // without RandR there is nothing to follow
+        rotating.set_randr(false);
+        if (evdev.follow_screen_changes()) {
+            printf("Error: followed the screen rotation without RandR\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // the policy-based sweeps, over the same calibrations and coordinates
+    printf("DriverSweep\n");
+    {
+        SweepStats stats[3];
+        sweep_driver<Xf86Driver>(&old_axes[0], old_axes.size(), &raw_coords[0],
+                                 raw_coords.size(), screen_res, dev_res, slack, stats[0]);
+        sweep_driver<Evdev270Driver>(&old_axes[0], old_axes.size(), &raw_coords[0],
+                                     raw_coords.size(), screen_res, dev_res, slack, stats[1]);
+        sweep_driver<UsbtouchscreenDriver>(&old_axes[0], old_axes.size(), &raw_coords[0],
+                                           raw_coords.size(), screen_res, dev_res, slack, stats[2]);
+        const char* names[3] = {Xf86Driver::name(), Evdev270Driver::name(),
+                                UsbtouchscreenDriver::name()};
+        for (int i = 0; i != 3; i++) {
+            if (stats[i].runs != old_axes.size()*raw_coords.size() || stats[i].failures != 0) {
+                printf("Error: %s sweep: %lu of %lu runs off by more than %i pixels (max %i)\n",
+                       names[i], stats[i].failures, stats[i].runs, slack, stats[i].max_error);
+                exit(1);
+            }
+        }
+    }
+    printf("OK\n");
+
+    // the fixed-point calibration, bit-for-bit against the exact value
+    // and against the float one up to the ties
+    printf("FixedPoint\n");
+    SplitMix64 fixed_rng(7);
+    for (int i = 0; i != 200000; i++) {
+        const int w = 2 + fixed_rng.next() % 5000, h = 2 + fixed_rng.next() % 5000;
+        const int range = i % 2 ? 70000 : 2000;
+        XYinfo old(fixed_rng.next() % (2*range) - range, fixed_rng.next() % (2*range) - range,
+                   fixed_rng.next() % (2*range) - range, fixed_rng.next() % (2*range) - range,
+                   fixed_rng.next() % 2, fixed_rng.next() % 2, fixed_rng.next() % 2);
+        int x[NUM_POINTS], y[NUM_POINTS];
+        for (int p = 0; p != NUM_POINTS; p++) {
+            x[p] = fixed_rng.next() % (w + 1);
+            y[p] = fixed_rng.next() % (h + 1);
+        }
+        if (!check_fixed(Calibrator::calc_axys_fixed(old, x, y, w, h),
+                         Calibrator::calc_axys_float(old, x, y, w, h), old, x, y, w, h, false) ||
+            !check_fixed(EvdevAxys::calc_axys_fixed(old, x, y, w, h),
+                         EvdevAxys::calc_axys_float(old, x, y, w, h), old, x, y, w, h, true)) {
+            printf("Error: fixed-point calibration %i, screen %ix%i, old axis: ", i, w, h);
+            old.print();
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // each finish stage on its own: the difference between pipeline prefixes
+    printf("FinishStages\n");
+    {
+        std::vector<ClickSet> sets(10000);
+        SplitMix64 stage_rng(3);
+        for (unsigned i = 0; i != sets.size(); i++)
+            make_synthetic_set(stage_rng, NoiseModel(2), sets[i]);
+
+        // pipeline prefixes, each line adds one stage
+        time_pipeline<FinishPipeline<DetectOrientation>, FloatFinishState>("DetectOrientation", sets);
+        time_pipeline<FinishPipeline<DetectOrientation, CombineClicks>,
+                      FloatFinishState>("+ CombineClicks", sets);
+        time_pipeline<FinishPipeline<DetectOrientation, CombineClicks, UndoEvdevInversion>,
+                      FloatFinishState>("+ UndoEvdevInversion", sets);
+        time_pipeline<FinishPipeline<DetectOrientation, CombineClicks, ExtrapolateBlocks>,
+                      FloatFinishState>("+ ExtrapolateBlocks", sets);
+        time_pipeline<FinishPipeline<DetectOrientation, CombineClicks, ExtrapolateBlocks, ScaleToOldAxis>,
+                      FloatFinishState>("+ ScaleToOldAxis", sets);
+        time_pipeline<FinishPipeline<DetectOrientation, CombineClicks, ExtrapolateBlocks, ScaleToOldAxis,
+                                     RoundAxis>, FloatFinishState>("+ RoundAxis", sets);
+        time_pipeline<GenericFinish, FloatFinishState>("+ SwapAxes (generic)", sets);
+        time_pipeline<EvdevFinish, FloatFinishState>("evdev", sets);
+        time_pipeline<GenericFixedFinish, FixedFinishState>("generic, fixed-point", sets);
+        time_pipeline<EvdevFixedFinish, FixedFinishState>("evdev, fixed-point", sets);
+    }
+    printf("OK\n");
+
+    // all eight orientations, and one that only a single pair of clicks contradicts
+    printf("Orientation\n");
+    {
+        std::vector<XYinfo> mount_old;
+        mount_old.push_back( XYinfo(0, 1000, 0, 1000) );
+        mount_old.push_back( XYinfo(1000, 0, 0, 1000) );
+        mount_old.push_back( XYinfo(0, 1000, 0, 1000, true) );
+        mount_old.push_back( XYinfo(42, 929, 20, 888) );
+        for (int o = 0; o != NUM_ORIENTATIONS; o++) {
+            const OrientationInfo& info = get_orientation_info((Orientation) o);
+            for (unsigned a = 0; a != mount_old.size(); a++) {
+                XYinfo axys;
+                if (!check_mount<Xf86Driver>(info, mount_old[a], screen_res, dev_res, slack, axys) ||
+                    (a == 0 && (axys.swap_xy != info.swap_xy ||
+                                (axys.x.min > axys.x.max) != info.invert_x ||
+                                (axys.y.min > axys.y.max) != info.invert_y))) {
+                    printf("Error: screen %s, not calibrated in one pass\n", info.name);
+                    printf("\tOld axis: "); mount_old[a].print();
+                    printf("\tNew axis: "); axys.print();
+                    exit(1);
+                }
+                if (!check_mount<Evdev270Driver>(info, mount_old[a], screen_res, dev_res, slack, axys)) {
+                    printf("Error: screen %s, not calibrated in one pass by evdev\n", info.name);
+                    printf("\tOld axis: "); mount_old[a].print();
+                    printf("\tNew axis: "); axys.print();
+                    exit(1);
+                }
+            }
+        }
+
+        int tx[NUM_POINTS], ty[NUM_POINTS];
+        for (int i = 0; i != NUM_POINTS; i++)
+            get_calibration_target(i, width, height, tx[i], ty[i]);
+        // upper-right click far off: UL-UR alone looks swapped
+        int x[NUM_POINTS] = {tx[UL], 380, tx[LL], tx[LR]};
+        int y[NUM_POINTS] = {ty[UL], 500, ty[LL], ty[LR]};
+        if (detect_orientation(x, y) != ORIENT_NORMAL) {
+            printf("Error: one bad click changed the orientation\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // the verification pass of a swapped mount on a non-square screen:
+    // the clicks are mapped to the new calibration axis by axis
+    printf("VerifySwapped\n");
+    {
+        const int w = 800, h = 400;
+        const XYinfo old_axys(0, 1000, 0, 1000);
+        // the panel's x runs along the screen's y, and the other way around
+        struct Mount {
+            static void click(int sx, int sy, int w, int h, int& x, int& y) {
+                const int raw_x = sy * 1000 / h, raw_y = sx * 1000 / w;
+                x = raw_x * w / 1000;
+                y = raw_y * h / 1000;
+            }
+        };
+        CalibratorTester swapped("Tester", old_axys);
+        for (int i = 0; i != NUM_POINTS; i++) {
+            int tx, ty, x, y;
+            xicalib_target(w, h, i, &tx, &ty);
+            Mount::click(tx, ty, w, h, x, y);
+            swapped.add_click(x, y);
+        }
+        swapped.set_threshold_verify(2);
+        if (!swapped.finish(w, h) || !swapped.get_calibrated_axys().swap_xy) {
+            printf("Error: the swapped mount is not calibrated\n");
+            exit(1);
+        }
+        ClickSet set;
+        set.backend = BACKEND_GENERIC;
+        set.old_axys = old_axys;
+        set.width = w; set.height = h;
+        set.has_truth = false;
+        for (int i = 0; i != swapped.get_num_verify_points(); i++) {
+            int tx, ty, x, y;
+            swapped.get_verify_target(i, w, h, tx, ty);
+            Mount::click(tx, ty, w, h, x, y);
+            swapped.add_verify_click(x, y);
+            if (i < NUM_POINTS) {
+                xicalib_target(w, h, i, &tx, &ty);
+                Mount::click(tx, ty, w, h, set.x[i], set.y[i]);
+            }
+        }
+        double rms, max;
+        if (!swapped.verify(w, h) ||
+            !calibration_error(set, swapped.get_calibrated_axys(), rms, max) || max > 2) {
+            printf("Error: the verification of the swapped mount fails\n");
+            printf("\tNew axis: "); swapped.get_calibrated_axys().print();
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+    // the same calibrations on several threads at once, each with its own
+    // context, against a run on this thread
+    printf("Reentrancy\n");
+    {
+        ReentrancyJob reference;
+        reference.old_axes = &old_axes;
+        reference.raw_coords = &raw_coords;
+        run_calibrations(&reference);
+
+        const int num_threads = 4;
+        ReentrancyJob jobs[num_threads];
+        pthread_t threads[num_threads];
+        for (int i = 0; i != num_threads; i++) {
+            char dir[32];
+            snprintf(dir, sizeof(dir), "/nonexistent/input%d", i);
+            jobs[i].old_axes = &old_axes;
+            jobs[i].raw_coords = &raw_coords;
+            jobs[i].context.sysfs_input = dir;
+            if (pthread_create(&threads[i], NULL, run_calibrations, &jobs[i]) != 0) {
+                printf("Error: can't start a calibration thread\n");
+                exit(1);
+            }
+        }
+        for (int i = 0; i != num_threads; i++)
+            pthread_join(threads[i], NULL);
+
+        for (int i = 0; i != num_threads; i++) {
+            if (!jobs[i].own_context) {
+                printf("Error: thread %i, a calibrator lost its context\n", i);
+                exit(1);
+            }
+            if (jobs[i].results.size() != reference.results.size()) {
+                printf("Error: thread %i, %lu calibrations instead of %lu\n", i,
+                       (unsigned long) jobs[i].results.size(),
+                       (unsigned long) reference.results.size());
+                exit(1);
+            }
+            for (unsigned r = 0; r != reference.results.size(); r++) {
+                const XYinfo& a = jobs[i].results[r];
+                const XYinfo& b = reference.results[r];
+                if (a.x.min != b.x.min || a.x.max != b.x.max ||
+                    a.y.min != b.y.min || a.y.max != b.y.max) {
+                    printf("Error: thread %i, calibration %u differs from the sequential one\n", i, r);
+                    printf("\tThread: "); a.print();
+                    printf("\tSequential: "); b.print();
+                    exit(1);
+                }
+            }
+        }
+    }
+    printf("OK\n");
+
+    // the C API of the library: the same calibration as the backends,
+    // the rejected clicks and the snippets
+    printf("CoreLibrary\n");
+    {
+        if (xicalib_api_version() != XICALIB_API_VERSION) {
+            printf("Error: library API version %i instead of %i\n",
+                   xicalib_api_version(), XICALIB_API_VERSION);
+            exit(1);
+        }
+        const struct xicalib_axis old_axis = { 42, 929, 20, 888, 0, 1, 0 };
+        const XYinfo old_axys(42, 929, 20, 888, false, true, false);
+        int x[NUM_POINTS], y[NUM_POINTS];
+        for (int i = 0; i != NUM_POINTS; i++) {
+            xicalib_target(width, height, i, &x[i], &y[i]);
+            x[i] += i - 2;
+            y[i] += 1 - i;
+        }
+
+        for (int driver = XICALIB_DRIVER_GENERIC; driver <= XICALIB_DRIVER_EVDEV; driver++) {
+            xicalib_session* s = xicalib_new("Tester", &old_axis, driver, 15, 7);
+            struct xicalib_axis new_axis;
+            char buf[MAX_LINE_LEN];
+            if (s == NULL || xicalib_finish(s, width, height, &new_axis) ||
+                xicalib_format(s, XICALIB_FORMAT_XORGCONFD, NULL, buf, sizeof(buf)) != -1) {
+                printf("Error: driver %i, a calibration without clicks\n", driver);
+                exit(1);
+            }
+            // a double-click, and a mis-click that drops the first click too
+            if (!xicalib_add_click(s, x[UL], y[UL]) || xicalib_add_click(s, x[UL] + 3, y[UL]) ||
+                xicalib_add_click(s, width/2, height/2) || xicalib_num_clicks(s) != 0) {
+                printf("Error: driver %i, wrong clicks taken\n", driver);
+                exit(1);
+            }
+            for (int i = 0; i != NUM_POINTS; i++)
+                xicalib_add_click(s, x[i], y[i]);
+
+            const XYinfo expected = driver == XICALIB_DRIVER_EVDEV ?
+                EvdevAxys::calc_axys(old_axys, x, y, width, height) :
+                Calibrator::calc_axys(old_axys, x, y, width, height);
+            if (!xicalib_finish(s, width, height, &new_axis) ||
+                new_axis.min_x != expected.x.min || new_axis.max_x != expected.x.max ||
+                new_axis.min_y != expected.y.min || new_axis.max_y != expected.y.max ||
+                new_axis.swap_xy != expected.swap_xy || new_axis.invert_x != expected.x.invert ||
+                new_axis.invert_y != expected.y.invert) {
+                printf("Error: driver %i, the library calibrates differently\n", driver);
+                printf("\tExpected: "); expected.print();
+                exit(1);
+            }
+
+            const int len = xicalib_format(s, XICALIB_FORMAT_HAL, "Panel", buf, sizeof(buf));
+            char min_x[32];
+            snprintf(min_x, sizeof(min_x), driver == XICALIB_DRIVER_EVDEV ? ">%d " : ">%d<",
+                     expected.x.min);
+            if (len != (int) strlen(buf) || strstr(buf, "\"Panel\"") == NULL ||
+                strstr(buf, min_x) == NULL ||
+                xicalib_format(s, XICALIB_FORMAT_HAL, "Panel", buf, 8) != len || strlen(buf) != 7 ||
+                (xicalib_format(s, XICALIB_FORMAT_XINPUT, NULL, buf, sizeof(buf)) < 0) !=
+                    (driver != XICALIB_DRIVER_EVDEV)) {
+                printf("Error: driver %i, wrong snippet from the library\n", driver);
+                exit(1);
+            }
+            xicalib_free(s);
+        }
+
+        int scaled;
+        float scaled_float;
+        if (!xicalib_scale_axis(500, 799, 0, 1000, 0, &scaled) || scaled != 399 ||
+            !xicalib_scale_axis(2000, 799, 0, 1000, 0, &scaled) || scaled != 799 ||
+            xicalib_scale_axis(500, 799, 0, 7, 7, &scaled) ||
+            !xicalib_scale_axis_float(2000, 799, 0, 1000, 0, &scaled_float) || scaled_float != 1598 ||
+            xicalib_new("Tester", &old_axis, 2, 0, 0) != NULL) {
+            printf("Error: wrong scaling or arguments taken by the library\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+
+#ifdef HAVE_LINUX_FB_H
+    // drawing on a file-backed framebuffer, and taps from evdev events
+    printf("Framebuffer\n");
+    char fb_file[] = "/tmp/tester_fb_XXXXXX";
+    fd = mkstemp(fb_file);
+    if (fd < 0) {
+        printf("Error: can't create the framebuffer file\n");
+        exit(1);
+    }
+    close(fd);
+    {
+        Framebuffer fb(fb_file, 64, 48);
+        const uint32_t gray = Framebuffer::rgb(190, 190, 190);
+        const uint32_t red = Framebuffer::rgb(255, 0, 0);
+        fb.fill_rect(0, 0, 64, 48, gray);
+        fb.fill_ring(32, 24, 10, 5, 0.25, red);
+        fb.draw_text(2, 2, "|", red);
+        if (fb.get_pixel(0, 0) != 0) {
+            printf("Error: drawn before present()\n");
+            exit(1);
+        }
+        fb.present(0, 0, 64, 40);
+
+        // the ring from 12 to 3 o'clock, the bar of '|' in column 3 of its glyph
+        if (fb.get_pixel(0, 0) != gray || fb.get_pixel(38, 18) != red ||
+            fb.get_pixel(26, 30) != gray || fb.get_pixel(32, 24) != gray ||
+            fb.get_pixel(5, 8) != red || fb.get_pixel(6, 8) != gray ||
+            fb.get_pixel(0, 44) != 0) {
+            printf("Error: wrong pixels in the framebuffer\n");
+            exit(1);
+        }
+
+        // XRGB8888 in the file
+        FILE* f = fopen(fb_file, "rb");
+        unsigned char px[4] = {0, 0, 0, 0};
+        if (f == NULL || fseek(f, (18*64 + 38)*4, SEEK_SET) != 0 ||
+            fread(px, 1, 4, f) != 4 || px[0] != 0 || px[1] != 0 || px[2] != 255) {
+            printf("Error: wrong pixel format in the framebuffer file\n");
+            exit(1);
+        }
+        fclose(f);
+    }
+    unlink(fb_file);
+    {
+        TouchInput touch(XYinfo(0, 4095, 0, 4095));
+        const int events[][3] = {
+            {EV_ABS, ABS_X, 100}, {EV_ABS, ABS_Y, 200}, {EV_KEY, BTN_TOUCH, 1},
+            {EV_SYN, SYN_REPORT, 0},        // tap at 100, 200
+            {EV_ABS, ABS_X, 150}, {EV_SYN, SYN_REPORT, 0},
+            {EV_KEY, BTN_TOUCH, 0}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_X, 3000}, {EV_KEY, BTN_TOUCH, 1},
+            {EV_SYN, SYN_REPORT, 0}         // tap at 3000, 200
+        };
+        std::vector<int> taps;
+        for (size_t i = 0; i < sizeof(events)/sizeof(events[0]); i++) {
+            input_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = events[i][0];
+            ev.code = events[i][1];
+            ev.value = events[i][2];
+            int x, y;
+            if (touch.decode(ev, x, y)) {
+                taps.push_back(x);
+                taps.push_back(y);
+            }
+        }
+        if (taps.size() != 4 || taps[0] != 100 || taps[1] != 200 ||
+            taps[2] != 3000 || taps[3] != 200) {
+            printf("Error: wrong taps from the evdev events\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+#endif
+
+#ifdef TEST_PROXY
+    // the uinput proxy, on frames of synthetic events
+    printf("UinputProxy\n");
+    {
+        input_absinfo abs_info;
+        memset(&abs_info, 0, sizeof(abs_info));
+        abs_info.maximum = 4095;
+        UinputProxy proxy(abs_info, abs_info, &abs_info, &abs_info);
+        const XYinfo proxy_axys(100, 3995, 200, 3895);
+        input_event ev[UinputProxy::max_events];
+        input_event extra[UinputProxy::max_extra];
+        struct iovec iov[UinputProxy::max_iov];
+        int niov = 0;
+
+        // calibrated in place: two frames, the start of a third one
+        proxy.set_calibration(proxy_axys);
+        const int plain[][3] = {
+            {EV_ABS, ABS_X, 100}, {EV_ABS, ABS_Y, 3895}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_X, 2000}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_Y, 1000}
+        };
+        int n = make_events(ev, plain, 6);
+        if (proxy.process_frames(ev, n, iov, niov, extra) != 5 || niov != 4 ||
+            ev[0].value != 0 || ev[1].value != 4095 ||
+            ev[3].value != proxy_scale(2000, proxy_axys.x) ||
+            iov[0].iov_base != ev || iov[0].iov_len != 2*sizeof(input_event) ||
+            iov[1].iov_base != &ev[2] || iov[2].iov_base != &ev[3] ||
+            iov[3].iov_base != &ev[4] || iov[3].iov_len != sizeof(input_event) ||
+            ev[5].value != 1000) {
+            printf("Error: wrong frames through the calibrated proxy\n");
+            exit(1);
+        }
+
+        // swapped: X follows the raw Y, a lone X gets its Y as an extra event
+        XYinfo swapped_axys = proxy_axys;
+        swapped_axys.swap_xy = true;
+        proxy.set_calibration(swapped_axys);
+        const int swapped[][3] = {
+            {EV_ABS, ABS_X, 1000}, {EV_ABS, ABS_Y, 2000}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_X, 1500}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_MT_SLOT, 1}, {EV_ABS, ABS_MT_POSITION_X, 1000},
+            {EV_ABS, ABS_MT_POSITION_Y, 2000}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_MT_POSITION_X, 1500}, {EV_SYN, SYN_REPORT, 0}
+        };
+        n = make_events(ev, swapped, 11);
+        niov = 0;
+        if (proxy.process_frames(ev, n, iov, niov, extra) != n || niov != 10 ||
+            ev[0].value != proxy_scale(2000, swapped_axys.x) ||
+            ev[1].value != proxy_scale(1000, swapped_axys.y) ||
+            ev[3].value != proxy_scale(2000, swapped_axys.x) ||
+            iov[3].iov_base != extra || iov[3].iov_len != sizeof(input_event) ||
+            extra[0].code != ABS_Y || extra[0].value != proxy_scale(1500, swapped_axys.y) ||
+            ev[6].value != proxy_scale(2000, swapped_axys.x) ||
+            ev[7].value != proxy_scale(1000, swapped_axys.y) ||
+            iov[8].iov_len != 3*sizeof(input_event) ||
+            extra[1].code != ABS_MT_SLOT || extra[1].value != 1 ||
+            extra[2].code != ABS_MT_POSITION_Y ||
+            extra[2].value != proxy_scale(1500, swapped_axys.y) ||
+            extra[3].code != ABS_MT_SLOT || extra[3].value != 1) {
+            printf("Error: wrong frames through the swapped proxy\n");
+            exit(1);
+        }
+
+        // swapped on axes of different ranges: as evdev, which rescales a
+        // swapped value from the range of its raw axis
+        {
+            input_absinfo abs_narrow = abs_info;
+            abs_narrow.maximum = 1023;
+            UinputProxy uneven(abs_info, abs_narrow);
+            const XYinfo device(0, 4095, 0, 1023);
+            XYinfo uneven_axys(100, 3995, 50, 970);
+            uneven_axys.swap_xy = true;
+            uneven.set_calibration(uneven_axys);
+            const int raw[][2] = {{1000, 200}, {3000, 900}, {2048, 512}};
+            for (int i = 0; i != 3; i++) {
+                const int frame[][3] = {
+                    {EV_ABS, ABS_X, raw[i][0]}, {EV_ABS, ABS_Y, raw[i][1]}, {EV_SYN, SYN_REPORT, 0}
+                };
+                n = make_events(ev, frame, 3);
+                niov = 0;
+                int vals[2] = {raw[i][0], raw[i][1]};
+                Evdev270Driver::process(device, uneven_axys, vals);
+                // evdev truncates twice (swap and calibration), the proxy rounds once
+                if (uneven.process_frames(ev, n, iov, niov, extra) != n ||
+                    abs(ev[0].value - vals[0]) > 2 || abs(ev[1].value - vals[1]) > 2) {
+                    printf("Error: swapped proxy on unequal axes: %i,%i instead of %i,%i\n",
+                           ev[0].value, ev[1].value, vals[0], vals[1]);
+                    exit(1);
+                }
+            }
+        }
+
+        // a frame larger than the buffer is transformed all the same
+        proxy.set_calibration(proxy_axys);
+        for (int i = 0; i != UinputProxy::max_events; i++) {
+            memset(&ev[i], 0, sizeof(ev[i]));
+            ev[i].type = EV_ABS;
+            ev[i].code = (i % 2) ? ABS_Y : ABS_X;
+            ev[i].value = 3000;
+        }
+        niov = 0;
+        if (proxy.process_frames(ev, UinputProxy::max_events, iov, niov, extra) != UinputProxy::max_events ||
+            niov != 1 || iov[0].iov_len != UinputProxy::max_events*sizeof(input_event) ||
+            ev[0].value != proxy_scale(3000, proxy_axys.x) ||
+            ev[UinputProxy::max_events - 1].value != proxy_scale(3000, proxy_axys.y)) {
+            printf("Error: the frame larger than the buffer is not transformed\n");
+            exit(1);
+        }
+
+        // after SYN_DROPPED, the rest of the frame is replaced by the state
+        const int dropped[][3] = {
+            {EV_ABS, ABS_X, 10}, {EV_SYN, SYN_DROPPED, 0},
+            {EV_ABS, ABS_X, 20}, {EV_SYN, SYN_REPORT, 0},
+            {EV_ABS, ABS_X, 3995}, {EV_SYN, SYN_REPORT, 0}
+        };
+        n = make_events(ev, dropped, 6);
+        niov = 0;
+        if (proxy.process_frames(ev, n, iov, niov, extra) != 4 || niov != 1 ||
+            iov[0].iov_base != extra || iov[0].iov_len != 3*sizeof(input_event) ||
+            extra[0].code != ABS_X || extra[0].value != proxy_scale(3000, proxy_axys.x) ||
+            extra[1].code != ABS_Y || extra[1].value != proxy_scale(3000, proxy_axys.y) ||
+            extra[2].type != EV_SYN || extra[2].code != SYN_REPORT) {
+            printf("Error: wrong resync after SYN_DROPPED\n");
+            exit(1);
+        }
+        niov = 0;
+        if (proxy.process_frames(ev + 4, n - 4, iov, niov, extra) != 2 || niov != 2 ||
+            ev[4].value != 4095) {
+            printf("Error: wrong frame after the resync\n");
+            exit(1);
+        }
+
+        // the correction grid, on top of an identity transform: the
+        // clicks are 8 pixels right and 4 up of a 1024x1024 screen
+        std::vector<int> proxy_tx, proxy_ty, proxy_cx, proxy_cy;
+        for (int row = 0; row != 3; row++) {
+            for (int col = 0; col != 3; col++) {
+                proxy_tx.push_back(col * 1023 / 2);
+                proxy_ty.push_back(row * 1023 / 2);
+                proxy_cx.push_back(col * 1023 / 2 + 8);
+                proxy_cy.push_back(row * 1023 / 2 - 4);
+            }
+        }
+        CorrectionGrid proxy_grid;
+        if (!proxy_grid.fit(3, 3, proxy_tx, proxy_ty, proxy_cx, proxy_cy, 1024, 1024)) {
+            printf("Error: unable to fit the correction grid of the proxy\n");
+            exit(1);
+        }
+        UinputProxy plain_proxy(abs_info, abs_info);
+        AxisTransform corrected = plain_proxy.get_transform();
+        corrected.correction = &proxy_grid;
+        int cx, cy;
+        corrected.apply(2082, 2082, cx, cy);
+        if (!corrected.mixes() || abs(cx - (2082 - 32)) > 1 || abs(cy - (2082 + 16)) > 1) {
+            printf("Error: wrong correction of the proxy transform\n");
+            exit(1);
+        }
+    }
+    printf("OK\n");
+#endif
 }
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _tracereader_hh
+#define _tracereader_hh
+
+#include <string>
+#include <stdlib.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Reading the --latency-trace of a calibrator process from a pipe,
+ * for the benchmarks that drive it.
+ */
+
+/// CLOCK_MONOTONIC in us, as in the latency trace
+inline long now_us()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec*1000000L + t.tv_nsec/1000;
+}
+
+/// the latency trace of one GUI process, read from a pipe
+class TraceReader
+{
+public:
+    TraceReader(int fd0, int timeout0)
+      : fd(fd0), timeout(timeout0), bytes(0) {}
+
+    /// read the next "<stage> <us>" line, false on EOF, error or timeout
+    bool next(std::string& stage, long& usec)
+    {
+        size_t eol;
+        while ((eol = buf.find('\n')) == std::string::npos) {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            if (poll(&pfd, 1, timeout) != 1)
+                return false;
+
+            char data[256];
+            const ssize_t n = read(fd, data, sizeof(data));
+            if (n <= 0)
+                return false;
+            buf.append(data, n);
+            bytes += n;
+        }
+        const std::string line = buf.substr(0, eol);
+        buf.erase(0, eol + 1);
+
+        const size_t sep = line.find(' ');
+        if (sep == std::string::npos)
+            return false;
+        stage = line.substr(0, sep);
+        usec = atol(line.c_str() + sep + 1);
+        return true;
+    }
+
+    /// skip to the next line of the given stage, false if there is none
+    bool wait_for(const char* wanted, long& usec)
+    {
+        std::string stage;
+        while (next(stage, usec)) {
+            if (stage == wanted)
+                return true;
+        }
+        return false;
+    }
+
+    /// bytes of trace read so far
+    unsigned long get_bytes() const
+    { return bytes; }
+
+private:
+    int fd;
+    int timeout;
+    unsigned long bytes;
+    std::string buf;
+};
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "xinput_calibrator.h"
+#include "calibrator.hh"
+#include "calibrator/EvdevAxys.hpp"
+#include "correction.hh"
+#include "output.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <string>
+
+static XYinfo to_xyinfo(const struct xicalib_axis& a)
+{
+    return XYinfo(a.min_x, a.max_x, a.min_y, a.max_y,
+                  a.swap_xy != 0, a.invert_x != 0, a.invert_y != 0);
+}
+
+static struct xicalib_axis from_xyinfo(const XYinfo& a)
+{
+    struct xicalib_axis axis;
+    axis.min_x = a.x.min; axis.max_x = a.x.max;
+    axis.min_y = a.y.min; axis.max_y = a.y.max;
+    axis.swap_xy = a.swap_xy;
+    axis.invert_x = a.x.invert;
+    axis.invert_y = a.y.invert;
+    return axis;
+}
+
+/*
+ * A Calibrator that keeps the new calibration to itself,
+ * with the finish pipeline of the driver
+ */
+struct xicalib_session: public Calibrator
+{
+    xicalib_session(const char* device_name0, const XYinfo& axys0, bool evdev0,
+                    int thr_misclick, int thr_doubleclick)
+      : Calibrator(device_name0, axys0, thr_misclick, thr_doubleclick,
+                   OUTYPE_AUTO, 0, false),
+        evdev(evdev0), finished(false) {}
+
+    const bool evdev;
+    // whether calibrated_axys holds the calibration of the clicks
+    bool finished;
+
+protected:
+    virtual bool finish_data(const XYinfo&)
+    { return true; }
+
+    virtual CalibratorBackend get_backend() const
+    { return evdev ? BACKEND_EVDEV : BACKEND_GENERIC; }
+
+    // as CalibratorEvdev::calc_new_axys(), which needs X for the rest
+    virtual XYinfo calc_new_axys(const XYinfo& axys, const int* x, const int* y,
+                                 int width, int height) const {
+        if (!evdev)
+            return Calibrator::calc_new_axys(axys, x, y, width, height);
+        return EvdevAxys::calc_axys(axys, x, y, width, height);
+    }
+};
+
+extern "C" int xicalib_api_version(void)
+{
+    return XICALIB_API_VERSION;
+}
+
+extern "C" xicalib_session* xicalib_new(const char* device_name,
+                                        const struct xicalib_axis* old_axis, int driver,
+                                        int threshold_misclick, int threshold_doubleclick)
+{
+    if (device_name == NULL || old_axis == NULL ||
+        (driver != XICALIB_DRIVER_GENERIC && driver != XICALIB_DRIVER_EVDEV))
+        return NULL;
+
+    try {
+        return new xicalib_session(device_name, to_xyinfo(*old_axis),
+                                   driver == XICALIB_DRIVER_EVDEV,
+                                   threshold_misclick, threshold_doubleclick);
+    } catch (const std::exception&) {
+        return NULL;
+    }
+}
+
+extern "C" void xicalib_free(xicalib_session* s)
+{
+    delete s;
+}
+
+extern "C" void xicalib_target(int width, int height, int i, int* x, int* y)
+{
+    get_calibration_target(i, width, height, *x, *y);
+}
+
+extern "C" int xicalib_add_click(xicalib_session* s, int x, int y)
+{
+    if (s->get_numclicks() == NUM_POINTS)
+        return 0;
+    s->finished = false;
+    return s->add_click(x, y);
+}
+
+extern "C" int xicalib_num_clicks(const xicalib_session* s)
+{
+    return s->get_numclicks();
+}
+
+extern "C" void xicalib_reset(xicalib_session* s)
+{
+    s->finished = false;
+    s->reset();
+}
+
+extern "C" int xicalib_finish(xicalib_session* s, int width, int height,
+                              struct xicalib_axis* new_axis)
+{
+    if (width <= 0 || height <= 0 || !s->finish(width, height))
+        return 0;
+
+    s->finished = true;
+    if (new_axis != NULL)
+        *new_axis = from_xyinfo(s->get_calibrated_axys());
+    return 1;
+}
+
+extern "C" int xicalib_format(const xicalib_session* s, int format, const char* product,
+                              char* buf, size_t size)
+{
+    if (!s->finished)
+        return -1;
+    if (product == NULL)
+        product = s->get_device_name();
+
+    std::string text;
+    try {
+        switch (format) {
+            case XICALIB_FORMAT_XORGCONFD:
+                text = format_xorgconfd(product, s->get_calibrated_axys(), s->evdev);
+                break;
+            case XICALIB_FORMAT_HAL:
+                text = format_hal(product, s->get_calibrated_axys(), s->evdev);
+                break;
+            case XICALIB_FORMAT_XINPUT:
+                if (!s->evdev)
+                    return -1;
+                text = format_xinput(s->get_device_name(), s->get_calibrated_axys());
+                break;
+            default:
+                return -1;
+        }
+    } catch (const std::exception&) {
+        return -1;
+    }
+
+    if (size > 0) {
+        const size_t n = std::min(text.size(), size - 1);
+        memcpy(buf, text.data(), n);
+        buf[n] = '\0';
+    }
+    return (int) text.size();
+}
+
+extern "C" int xicalib_scale_axis(int value, int to_max, int to_min,
+                                  int from_max, int from_min, int* result)
+{
+    if (from_max == from_min)
+        return 0;
+    *result = xf86ScaleAxis(value, to_max, to_min, from_max, from_min);
+    return 1;
+}
+
+extern "C" int xicalib_scale_axis_float(float value, int to_max, int to_min,
+                                        int from_max, int from_min, float* result)
+{
+    if (from_max == from_min)
+        return 0;
+    *result = scaleAxis(value, to_max, to_min, from_max, from_min);
+    return 1;
+}
+
+struct xicalib_correction: public CorrectionGrid
+{
+};
+
+extern "C" xicalib_correction* xicalib_correction_load(const char* filename)
+{
+    if (filename == NULL)
+        return NULL;
+
+    xicalib_correction* c = NULL;
+    try {
+        c = new xicalib_correction;
+        if (c->load(filename, false))
+            return c;
+    } catch (const std::exception&) {
+    }
+    delete c;
+    return NULL;
+}
+
+extern "C" void xicalib_correction_free(xicalib_correction* c)
+{
+    delete c;
+}
+
+extern "C" void xicalib_correction_size(const xicalib_correction* c, int* width, int* height)
+{
+    *width = c->get_width();
+    *height = c->get_height();
+}
+
+extern "C" void xicalib_correction_apply(const xicalib_correction* c, int* x, int* y)
+{
+    c->correct(*x, *y);
+}
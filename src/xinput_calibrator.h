@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The calibration core of xinput_calibrator as a library, with a C API and
+ * without X: the click validation, the calculation of the new calibration,
+ * the scaling of the X input drivers and the configuration snippets.
+ *
+ * One calibration, in C or C++ (link with `pkg-config --libs xinputcalibrator`):
+ *
+ *   struct xicalib_axis old_axis = { 0, 4095, 0, 4095, 0, 0, 0 }, new_axis;
+ *   xicalib_session* s = xicalib_new("My Touchscreen", &old_axis,
+ *                                    XICALIB_DRIVER_EVDEV, 15, 7);
+ *   while (xicalib_num_clicks(s) != XICALIB_NUM_POINTS) {
+ *       xicalib_target(width, height, xicalib_num_clicks(s), &tx, &ty);
+ *       ... show the target at tx, ty, wait for a tap at x, y ...
+ *       xicalib_add_click(s, x, y);
+ *   }
+ *   if (xicalib_finish(s, width, height, &new_axis))
+ *       xicalib_format(s, XICALIB_FORMAT_XORGCONFD, NULL, buf, sizeof(buf));
+ *   xicalib_free(s);
+ *
+ * The clicks are in screen coordinates, as the touchscreen reports them with
+ * its current calibration old_axis. Sessions are independent of each other;
+ * each one is used by one thread at a time. Nothing is printed, no file is
+ * written and the process is never exited.
+ */
+
+#ifndef _xinput_calibrator_h
+#define _xinput_calibrator_h
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* bumped with every incompatible change of the API, and the soname with it */
+#define XICALIB_API_VERSION 1
+
+/* the targets, in the order upper-left, upper-right, lower-left, lower-right */
+#define XICALIB_NUM_POINTS 4
+
+/* how the driver takes the calibration */
+#define XICALIB_DRIVER_GENERIC 0 /* MinX, MaxX, MinY, MaxY, SwapXY, InvertX, InvertY */
+#define XICALIB_DRIVER_EVDEV   1 /* "Evdev Axis Calibration" and "Evdev Axes Swap" */
+
+/* what xicalib_format() writes */
+#define XICALIB_FORMAT_XORGCONFD 0 /* an xorg.conf.d InputClass section */
+#define XICALIB_FORMAT_HAL       1 /* a HAL fdi policy */
+#define XICALIB_FORMAT_XINPUT    2 /* xinput commands, evdev only */
+
+/* a calibration of the touchscreen: its raw values at the screen edges */
+struct xicalib_axis {
+    int min_x, max_x, min_y, max_y;
+    int swap_xy, invert_x, invert_y;
+};
+
+typedef struct xicalib_session xicalib_session;
+typedef struct xicalib_correction xicalib_correction;
+
+/* XICALIB_API_VERSION of the library itself */
+int xicalib_api_version(void);
+
+/* start a calibration of the device with the current calibration old_axis;
+ * a threshold of 0 turns that check off. NULL on wrong arguments. */
+xicalib_session* xicalib_new(const char* device_name,
+                             const struct xicalib_axis* old_axis, int driver,
+                             int threshold_misclick, int threshold_doubleclick);
+void xicalib_free(xicalib_session* s);
+
+/* screen coordinates of target i on a width x height screen */
+void xicalib_target(int width, int height, int i, int* x, int* y);
+
+/* add the click on the next target: 1 if it is taken, 0 if it is rejected.
+ * A mis-click (not in line with the earlier clicks) also drops those,
+ * the calibration starts over at the first target. */
+int xicalib_add_click(xicalib_session* s, int x, int y);
+/* the number of clicks taken, the next target to show */
+int xicalib_num_clicks(const xicalib_session* s);
+/* drop all clicks */
+void xicalib_reset(xicalib_session* s);
+
+/* calculate the new calibration from the XICALIB_NUM_POINTS clicks;
+ * 1 on success, 0 if the clicks are missing or the screen is empty */
+int xicalib_finish(xicalib_session* s, int width, int height,
+                   struct xicalib_axis* new_axis);
+
+/* write the new calibration in the given format to buf, nul-terminated
+ * and truncated to size, for the device 'product' (its sysfs name, the
+ * device name of xicalib_new() when NULL). Returns the length of the whole
+ * text, as snprintf(), or -1 before xicalib_finish() or for a format the
+ * driver has no use for. */
+int xicalib_format(const xicalib_session* s, int format, const char* product,
+                   char* buf, size_t size);
+
+/* xf86ScaleAxis() of the X server: value from the range from_min..from_max
+ * to to_min..to_max, clipped to it; the way the drivers scale the raw
+ * values to the screen. 0 if the from range is empty, 1 otherwise. */
+int xicalib_scale_axis(int value, int to_max, int to_min,
+                       int from_max, int from_min, int* result);
+/* the same without the rounding and the clipping */
+int xicalib_scale_axis_float(float value, int to_max, int to_min,
+                             int from_max, int from_min, float* result);
+
+/* read the non-linear correction grid written by xinput_calibrator
+ * --correction-output, NULL if the file can't be read or isn't one */
+xicalib_correction* xicalib_correction_load(const char* filename);
+void xicalib_correction_free(xicalib_correction* c);
+/* the screen size the grid was fitted for */
+void xicalib_correction_size(const xicalib_correction* c, int* width, int* height);
+/* correct screen coordinates x, y (calibrated, on a screen of that size) */
+void xicalib_correction_apply(const xicalib_correction* c, int* x, int* y);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Live calibration published in POSIX shared memory.
+ *
+ * xinput_calibrator --publish-shm writes the calibration of a device to the
+ * segment named by xicshm_segment_name(), every time it calibrates it. Updates are guarded by a seqlock: readers copy a
+ * consistent snapshot without locking and never block the writer.
+ *
+ * Reading, in C or C++ (link with -lrt on older glibc):
+ *
+ *   const struct xicshm_segment* seg = xicshm_open("My Touchscreen");
+ *   struct xicshm_calibration cal;
+ *   uint32_t gen;
+ *   if (xicshm_read(seg, &cal, &gen) != 0)
+ *       ... // the writer died while updating
+ *   ...
+ *   if (xicshm_generation(seg) != gen)
+ *       xicshm_read(seg, &cal, &gen); // recalibrated
+ *   ...
+ *   xicshm_close(seg);
+ *
+ * Needs GCC or clang, for the __atomic builtins.
+ */
+
+#ifndef _xinput_calibrator_shm_h
+#define _xinput_calibrator_shm_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define XICSHM_MAGIC   0x53434958 /* "XICS" */
+#define XICSHM_VERSION 1
+
+/* xicshm_read() gives up after this many tries, far more than an update takes */
+#define XICSHM_READ_TRIES 100000
+
+/* which parts of struct xicshm_calibration are set */
+#define XICSHM_HAS_AXES   1
+#define XICSHM_HAS_MATRIX 2
+
+struct xicshm_calibration {
+    uint32_t flags;
+    /* as "Evdev Axis Calibration", "Evdev Axes Swap" and "Evdev Axis Inversion" */
+    int32_t min_x, max_x, min_y, max_y;
+    int32_t swap_xy, invert_x, invert_y;
+    /* first two rows of a "Coordinate Transformation Matrix" */
+    float matrix[6];
+    /* the device name, nul-terminated */
+    char device[64];
+};
+
+struct xicshm_segment {
+    uint32_t magic;
+    uint32_t version;
+    /* odd while the writer is updating 'cal' */
+    uint32_t seq;
+    uint32_t reserved;
+    struct xicshm_calibration cal;
+};
+
+/* name of the segment of the given device, non-alphanumerics replaced by '_' */
+static inline void xicshm_segment_name(const char* device, char* buf, size_t len)
+{
+    size_t i;
+    int n = snprintf(buf, len, "/xinput_calibrator-");
+    for (i = 0; device[i] != '\0' && n + i + 1 < len; i++) {
+        const char c = device[i];
+        buf[n + i] = ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                      (c >= '0' && c <= '9')) ? c : '_';
+    }
+    buf[n + i] = '\0';
+}
+
+/* map the segment of the given device read-only, NULL if not published */
+static inline const struct xicshm_segment* xicshm_open(const char* device)
+{
+    char name[256];
+    struct stat st;
+    void* p;
+    int fd;
+
+    xicshm_segment_name(device, name, sizeof(name));
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(struct xicshm_segment)) {
+        close(fd);
+        return NULL;
+    }
+    p = mmap(NULL, sizeof(struct xicshm_segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+    if (((const struct xicshm_segment*)p)->magic != XICSHM_MAGIC ||
+        ((const struct xicshm_segment*)p)->version != XICSHM_VERSION) {
+        munmap(p, sizeof(struct xicshm_segment));
+        return NULL;
+    }
+    return (const struct xicshm_segment*)p;
+}
+
+static inline void xicshm_close(const struct xicshm_segment* seg)
+{
+    munmap((void*)seg, sizeof(struct xicshm_segment));
+}
+
+/* changes on every update, compare to detect a recalibration */
+static inline uint32_t xicshm_generation(const struct xicshm_segment* seg)
+{
+    return __atomic_load_n(&seg->seq, __ATOMIC_ACQUIRE) >> 1;
+}
+
+/* copy a consistent snapshot and its generation (if 'generation' is not NULL);
+ * returns 0, or -1 if there was none in XICSHM_READ_TRIES tries: the writer
+ * died while updating, the next update repairs the segment */
+static inline int xicshm_read(const struct xicshm_segment* seg,
+                              struct xicshm_calibration* out, uint32_t* generation)
+{
+    uint32_t before, after;
+    long tries;
+    for (tries = 0; tries != XICSHM_READ_TRIES; tries++) {
+        before = __atomic_load_n(&seg->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            /* an update in progress, let the writer finish */
+            sched_yield();
+            continue;
+        }
+        memcpy(out, (const void*)&seg->cal, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&seg->seq, __ATOMIC_RELAXED);
+        if (before == after) {
+            if (generation != NULL)
+                *generation = before >> 1;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+#endif
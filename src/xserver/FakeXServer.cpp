@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "xserver/FakeXServer.hpp"
+
+#include <X11/extensions/XInput.h>
+
+FakeXServer::FakeXServer()
+  : rotation(SCREEN_ROTATE_0), randr(true), vendor_name("The X.Org Foundation"), release_nr(11000000),
+    num_changes(0), num_syncs(0), num_lists(0)
+{
+}
+
+void FakeXServer::add_device(XID id, const char* name, int use, const XYinfo* axys)
+{
+    Device dev;
+    dev.info.id = id;
+    dev.info.name = name;
+    dev.info.use = use;
+    if (axys != NULL) {
+        dev.info.absolute = true;
+        dev.info.num_axes = 2;
+        dev.info.axys = *axys;
+    }
+    dev.opened = false;
+    devices.push_back(dev);
+}
+
+void FakeXServer::set_property(XID id, const char* name, int format,
+                               int n, const long* values)
+{
+    Device* dev = find(id);
+    if (dev == NULL)
+        return;
+
+    Property& prop = dev->properties[name];
+    prop.format = format;
+    prop.values.assign(values, values + n);
+}
+
+const FakeXServer::Property* FakeXServer::get_property(XID id, const char* name) const
+{
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i].info.id != id)
+            continue;
+
+        std::map<std::string, Property>::const_iterator it =
+            devices[i].properties.find(name);
+        return it == devices[i].properties.end() ? NULL : &it->second;
+    }
+    return NULL;
+}
+
+FakeXServer::Device* FakeXServer::find(XID id)
+{
+    for (size_t i = 0; i < devices.size(); i++)
+        if (devices[i].info.id == id)
+            return &devices[i];
+    return NULL;
+}
+
+bool FakeXServer::query_xinput(int& major, int& minor)
+{
+    major = 2;
+    minor = 0;
+    return true;
+}
+
+std::vector<XInputDevice> FakeXServer::list_devices()
+{
+    num_lists++;
+    std::vector<XInputDevice> result;
+    for (size_t i = 0; i < devices.size(); i++)
+        result.push_back(devices[i].info);
+    return result;
+}
+
+bool FakeXServer::query_device(XID id, XInputDevice& dev)
+{
+    const Device* found = find(id);
+    if (found == NULL)
+        return false;
+
+    dev = found->info;
+    return true;
+}
+
+bool FakeXServer::open_device(XID id)
+{
+    Device* dev = find(id);
+    // like the X server, master devices can not be opened
+    if (dev == NULL || dev->info.use == IsXPointer || dev->info.use == IsXKeyboard)
+        return false;
+
+    dev->opened = true;
+    return true;
+}
+
+bool FakeXServer::get_int_property(XID id, const char* name,
+                                   int& format, std::vector<long>& values)
+{
+    format = 0;
+    values.clear();
+
+    Device* dev = find(id);
+    if (dev == NULL || !dev->opened)
+        return false;
+
+    std::map<std::string, Property>::const_iterator it = dev->properties.find(name);
+    if (it != dev->properties.end()) {
+        format = it->second.format;
+        values = it->second.values;
+    }
+    return true;
+}
+
+bool FakeXServer::set_int_property(XID id, const char* name,
+                                   int format, const std::vector<long>& values)
+{
+    Device* dev = find(id);
+    if (dev == NULL || !dev->opened || values.empty())
+        return false;
+    if (format != 8 && format != 16 && format != 32)
+        return false;
+
+    num_changes++;
+    Property& prop = dev->properties[name];
+    prop.format = format;
+    prop.values = values;
+    return true;
+}
+
+void FakeXServer::sync()
+{
+    num_syncs++;
+}
+
+int FakeXServer::screen_rotation()
+{
+    return rotation;
+}
+
+bool FakeXServer::wait_screen_change(int& new_rotation)
+{
+    if (!randr || screen_changes.empty())
+        return false;
+
+    rotation = new_rotation = screen_changes.front();
+    screen_changes.pop_front();
+    return true;
+}
+
+std::string FakeXServer::vendor()
+{
+    return vendor_name;
+}
+
+int FakeXServer::vendor_release()
+{
+    return release_nr;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef FAKE_XSERVER_HPP
+#define FAKE_XSERVER_HPP
+
+#include "xserver/XServer.hpp"
+
+#include <deque>
+#include <map>
+
+/***************************************
+ * In-memory XServer, for running the calibrators without a display.
+ *
+ * Devices, their integer properties and screen changes are set up by
+ * the caller, property changes are kept and counted.
+ ***************************************/
+class FakeXServer : public XServer
+{
+public:
+    struct Property {
+        int format;
+        std::vector<long> values;
+
+        Property() : format(0) {}
+    };
+
+    FakeXServer();
+
+    /// add a device, with absolute axes when axys is given
+    void add_device(XID id, const char* name, int use, const XYinfo* axys = NULL);
+
+    /// set a property, as if by the driver
+    void set_property(XID id, const char* name, int format,
+                      int n, const long* values);
+
+    /// the property, or NULL if the device does not have it
+    const Property* get_property(XID id, const char* name) const;
+
+    void set_vendor(const char* name, int release)
+    { vendor_name = name; release_nr = release; }
+
+    /// whether the server has RandR, on by default
+    void set_randr(bool has_randr)
+    { randr = has_randr; }
+
+    /// queue a RandR screen change, to the given rotation
+    void add_screen_change(int rotation)
+    { screen_changes.push_back(rotation); }
+
+    /// number of set_int_property() calls
+    int get_num_changes() const
+    { return num_changes; }
+    int get_num_syncs() const
+    { return num_syncs; }
+    /// number of list_devices() calls
+    int get_num_lists() const
+    { return num_lists; }
+
+    virtual bool is_connected() const
+    { return true; }
+
+    virtual bool query_xinput(int& major, int& minor);
+    virtual std::vector<XInputDevice> list_devices();
+    virtual bool query_device(XID id, XInputDevice& dev);
+    virtual bool open_device(XID id);
+    virtual bool get_int_property(XID id, const char* name,
+                                  int& format, std::vector<long>& values);
+    virtual bool set_int_property(XID id, const char* name,
+                                  int format, const std::vector<long>& values);
+    virtual void sync();
+    virtual int screen_rotation();
+    virtual bool has_screen_changes()
+    { return randr; }
+    virtual bool wait_screen_change(int& rotation);
+    virtual std::string vendor();
+    virtual int vendor_release();
+
+private:
+    struct Device {
+        XInputDevice info;
+        bool opened;
+        std::map<std::string, Property> properties;
+    };
+
+    Device* find(XID id);
+
+    std::vector<Device> devices;
+    int rotation;
+    bool randr;
+    std::deque<int> screen_changes;
+    std::string vendor_name;
+    int release_nr;
+    int num_changes;
+    int num_syncs;
+    int num_lists;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef XSERVER_HPP
+#define XSERVER_HPP
+
+#include "calibrator.hh"
+
+#include <X11/Xlib.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// An XInput device, as listed by the server
+struct XInputDevice {
+    XID id;
+    std::string name;
+    /// IsXPointer, IsXKeyboard, IsXExtensionDevice, ...
+    int use;
+    /// whether the first valuator class reports absolute values
+    bool absolute;
+    int num_axes;
+    /// range of the first two axes
+    XYinfo axys;
+
+    XInputDevice() : id(0), use(0), absolute(false), num_axes(0) {}
+
+    /// whether it has two axes that report absolute values
+    bool is_calibratable() const
+    {
+        return absolute && num_axes >= 2 &&
+               !(axys.x.min == -1 && axys.x.max == -1) &&
+               !(axys.y.min == -1 && axys.y.max == -1);
+    }
+};
+
+/***************************************
+ * The X server calls used by the calibrators:
+ * device listing, device properties, screen rotation and server vendor.
+ *
+ * XlibServer talks to the real server, FakeXServer keeps everything
+ * in memory so the backends can be tested without a display.
+ ***************************************/
+class XServer
+{
+public:
+    virtual ~XServer() {}
+
+    /// whether the connection to the server is up
+    virtual bool is_connected() const = 0;
+
+    /// whether the XInput extension is available, and its version
+    /// (-1 if unknown)
+    virtual bool query_xinput(int& major, int& minor) = 0;
+
+    /// list all input devices
+    virtual std::vector<XInputDevice> list_devices() = 0;
+
+    /// get one input device, without listing the others;
+    /// returns false if there is no such device
+    virtual bool query_device(XID id, XInputDevice& dev) = 0;
+
+    /// open the device, for its properties; returns false if it can't be opened
+    virtual bool open_device(XID id) = 0;
+
+    /// get an integer property of an opened device; format is 0 when the
+    /// device has no such property, or it is not of type INTEGER.
+    /// Returns false if the request failed.
+    virtual bool get_int_property(XID id, const char* name,
+                                  int& format, std::vector<long>& values) = 0;
+
+    /// replace an integer property of an opened device, format 8, 16 or 32
+    virtual bool set_int_property(XID id, const char* name,
+                                  int format, const std::vector<long>& values) = 0;
+
+    /// wait until the server processed all requests
+    virtual void sync() = 0;
+
+    /// the RandR rotation of the screen (ScreenRotation flags),
+    /// SCREEN_ROTATE_0 without RandR
+    virtual int screen_rotation() = 0;
+
+    /// whether the server sends screen change events (RandR)
+    virtual bool has_screen_changes() = 0;
+
+    /// wait for the next RRScreenChangeNotify and get the new rotation;
+    /// returns false when there will be none (no RandR)
+    virtual bool wait_screen_change(int& rotation) = 0;
+
+    virtual std::string vendor() = 0;
+    virtual int vendor_release() = 0;
+
+    /// whether the server reads xorg.conf.d (X.Org 1.8 and later),
+    /// false if it can't be asked
+    bool has_xorgconfd_support() {
+        if (!is_connected()) {
+            fprintf(stderr, "Unable to connect to X server\n");
+            return false;
+        }
+        return vendor().find("X.Org") != std::string::npos &&
+               vendor_release() >= 10800000;
+    }
+};
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "xserver/XlibServer.hpp"
+
+#include <X11/Xatom.h>
+#include <ctype.h>
+#include <cstdlib>
+#include <pthread.h>
+
+#ifdef HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif
+
+#ifdef HAVE_X11_XRANDR
+// for the screen rotation
+#include <X11/extensions/Xrandr.h>
+#endif
+
+XlibServer::XlibServer()
+  : xi2(-1), xi_error_base(0), screen_changes_selected(false)
+{
+    display = XOpenDisplay(NULL);
+}
+
+XlibServer::~XlibServer()
+{
+    if (display == NULL)
+        return;
+
+    for (std::map<XID, XDevice*>::iterator it = devices.begin();
+         it != devices.end(); ++it)
+        XCloseDevice(display, it->second);
+    XCloseDisplay(display);
+}
+
+bool XlibServer::query_xinput(int& major, int& minor)
+{
+    int xi_opcode, event, error;
+    if (!XQueryExtension(display, "XInputExtension", &xi_opcode, &event, &error))
+        return false;
+
+    major = minor = -1;
+    XExtensionVersion *version = XGetExtensionVersion(display, INAME);
+    if (version && (version != (XExtensionVersion*) NoSuchExtension)) {
+        major = version->major_version;
+        minor = version->minor_version;
+        XFree(version);
+    }
+    return true;
+}
+
+// all devices through XInput 1
+static std::vector<XInputDevice> list_devices_xi1(Display* display)
+{
+    std::vector<XInputDevice> result;
+
+    int ndevices;
+    XDeviceInfoPtr list = XListInputDevices(display, &ndevices);
+    for (int i=0; i<ndevices; i++)
+    {
+        XInputDevice dev;
+        dev.id = list[i].id;
+        dev.name = list[i].name;
+        dev.use = list[i].use;
+
+        // the first valuator class gives the axes
+        XAnyClassPtr any = (XAnyClassPtr) (list[i].inputclassinfo);
+        for (int j=0; j<list[i].num_classes; j++)
+        {
+            if (any->c_class == ValuatorClass) {
+                XValuatorInfoPtr V = (XValuatorInfoPtr) any;
+                XAxisInfoPtr ax = (XAxisInfoPtr) V->axes;
+
+                dev.absolute = (V->mode == Absolute);
+                dev.num_axes = V->num_axes;
+                if (V->num_axes >= 2) {
+                    dev.axys.x.min = ax[0].min_value;
+                    dev.axys.x.max = ax[0].max_value;
+                    dev.axys.y.min = ax[1].min_value;
+                    dev.axys.y.max = ax[1].max_value;
+                }
+                break;
+            }
+
+            /*
+             * Increment 'any' to point to the next item in the linked
+             * list.  The length is in bytes, so 'any' must be cast to
+             * a character pointer before being incremented.
+             */
+            any = (XAnyClassPtr) ((char *) any + any->length);
+        }
+
+        result.push_back(dev);
+    }
+    if (list != NULL)
+        XFreeDeviceList(list);
+
+    return result;
+}
+
+bool XlibServer::has_xi2()
+{
+#ifdef HAVE_XI2
+    if (xi2 == -1) {
+        int opcode, event;
+        int major = 2, minor = 0;
+        xi2 = XQueryExtension(display, "XInputExtension", &opcode, &event, &xi_error_base) &&
+              XIQueryVersion(display, &major, &minor) == Success && major >= 2;
+    }
+    return xi2 == 1;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_XI2
+// the device as XInput 1 would describe it: valuators 0 and 1 give the axes
+static XInputDevice device_xi2(const XIDeviceInfo& info)
+{
+    XInputDevice dev;
+    dev.id = info.deviceid;
+    dev.name = info.name;
+    switch (info.use) {
+        case XIMasterPointer:  dev.use = IsXPointer; break;
+        case XIMasterKeyboard: dev.use = IsXKeyboard; break;
+        case XISlavePointer:   dev.use = IsXExtensionPointer; break;
+        case XISlaveKeyboard:  dev.use = IsXExtensionKeyboard; break;
+        default:               dev.use = IsXExtensionDevice;
+    }
+
+    for (int i = 0; i < info.num_classes; i++) {
+        if (info.classes[i]->type != XIValuatorClass)
+            continue;
+
+        const XIValuatorClassInfo* v = (const XIValuatorClassInfo*) info.classes[i];
+        dev.num_axes++;
+        if (v->number == 0) {
+            dev.absolute = (v->mode == XIModeAbsolute);
+            dev.axys.x.min = (int) v->min;
+            dev.axys.x.max = (int) v->max;
+        } else if (v->number == 1) {
+            dev.axys.y.min = (int) v->min;
+            dev.axys.y.max = (int) v->max;
+        }
+    }
+    return dev;
+}
+
+// set by catch_bad_device() while querying a single device; the error
+// handler is one for the whole process, so the queries take turns and
+// the lock also guards the display, error code and handler it defers to
+static pthread_mutex_t bad_device_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool bad_device;
+static Display* bad_device_display;
+static int bad_device_error;
+static XErrorHandler bad_device_old_handler;
+static int catch_bad_device(Display* dpy, XErrorEvent* ev)
+{
+    // any other error, or one of another display, is not ours to hide
+    if (dpy != bad_device_display || ev->error_code != bad_device_error)
+        return bad_device_old_handler != NULL ? bad_device_old_handler(dpy, ev) : 0;
+    bad_device = true;
+    return 0;
+}
+#endif // HAVE_XI2
+
+std::vector<XInputDevice> XlibServer::list_devices()
+{
+#ifdef HAVE_XI2
+    if (has_xi2()) {
+        std::vector<XInputDevice> result;
+        int ndevices;
+        XIDeviceInfo* info = XIQueryDevice(display, XIAllDevices, &ndevices);
+        for (int i = 0; i < ndevices; i++)
+            result.push_back(device_xi2(info[i]));
+        if (info != NULL)
+            XIFreeDeviceInfo(info);
+        return result;
+    }
+#endif
+    return list_devices_xi1(display);
+}
+
+bool XlibServer::query_device(XID id, XInputDevice& dev)
+{
+#ifdef HAVE_XI2
+    if (has_xi2()) {
+        // XIAllDevices and XIAllMasterDevices are not devices
+        if (id < 2)
+            return false;
+
+        // an unknown id is a BadDevice error, not a fatal one here
+        pthread_mutex_lock(&bad_device_lock);
+        bad_device = false;
+        bad_device_display = display;
+        bad_device_error = xi_error_base + XI_BadDevice;
+        bad_device_old_handler = XSetErrorHandler(catch_bad_device);
+        int ndevices = 0;
+        XIDeviceInfo* info = XIQueryDevice(display, id, &ndevices);
+        XSetErrorHandler(bad_device_old_handler);
+        const bool failed = bad_device;
+        pthread_mutex_unlock(&bad_device_lock);
+
+        const bool found = !failed && info != NULL && ndevices == 1 &&
+                           (XID) info[0].deviceid == id;
+        if (found)
+            dev = device_xi2(info[0]);
+        if (info != NULL)
+            XIFreeDeviceInfo(info);
+        return found;
+    }
+#endif
+    // XInput 1 has no request for a single device
+    std::vector<XInputDevice> list = list_devices_xi1(display);
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].id == id) {
+            dev = list[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool XlibServer::open_device(XID id)
+{
+    if (devices.find(id) != devices.end())
+        return true;
+
+    XDevice* dev = XOpenDevice(display, id);
+    if (!dev)
+        return false;
+
+    devices[id] = dev;
+    return true;
+}
+
+// (from the xinput project)
+Atom XlibServer::parse_atom(const char *name)
+{
+    Bool is_atom = True;
+    int i;
+
+    for (i = 0; name[i] != '\0'; i++) {
+        if (!isdigit(name[i])) {
+            is_atom = False;
+            break;
+        }
+    }
+
+    if (is_atom)
+        return atoi(name);
+    else
+        return XInternAtom(display, name, False);
+}
+
+bool XlibServer::get_int_property(XID id, const char* name,
+                                  int& format, std::vector<long>& values)
+{
+    format = 0;
+    values.clear();
+
+#ifndef HAVE_XI_PROP
+    return false;
+#else
+    std::map<XID, XDevice*>::iterator it = devices.find(id);
+    if (it == devices.end())
+        return false;
+
+    Atom            act_type;
+    int             act_format;
+    unsigned long   nitems, bytes_after;
+    unsigned char   *data;
+
+    if (XGetDeviceProperty(display, it->second, parse_atom(name), 0, 1000, False,
+                           AnyPropertyType, &act_type, &act_format,
+                           &nitems, &bytes_after, &data) != Success)
+        return false;
+
+    if (act_type == XA_INTEGER) {
+        format = act_format;
+        for (unsigned long i = 0; i < nitems; i++) {
+            // Xlib returns format 16 and 32 data as short and long arrays
+            switch (act_format) {
+                case 8:
+                    values.push_back(((char*)data)[i]);
+                    break;
+                case 16:
+                    values.push_back(((short*)data)[i]);
+                    break;
+                case 32:
+                    values.push_back(((long*)data)[i]);
+                    break;
+            }
+        }
+    }
+
+    XFree(data);
+    return true;
+#endif // HAVE_XI_PROP
+}
+
+// Set Integer property on X (from the xinput project)
+bool XlibServer::set_int_property(XID id, const char* name,
+                                  int format, const std::vector<long>& values)
+{
+#ifndef HAVE_XI_PROP
+    return false;
+#else
+    std::map<XID, XDevice*>::iterator it = devices.find(id);
+    if (it == devices.end())
+        return false;
+
+    if (values.size() < 1)
+    {
+        fprintf(stderr, "Wrong usage of set_int_property, need at least 1 value\n");
+        return false;
+    }
+
+    Atom prop = parse_atom(name);
+    if (prop == None) {
+        fprintf(stderr, "invalid property %s\n", name);
+        return false;
+    }
+
+    union {
+        unsigned char *c;
+        short *s;
+        long *l;
+    } data;
+
+    data.c = (unsigned char*)calloc(values.size(), sizeof(long));
+
+    for (size_t i = 0; i < values.size(); i++) {
+      switch (format) {
+        case 8:
+            data.c[i] = values[i];
+            break;
+        case 16:
+            data.s[i] = values[i];
+            break;
+        case 32:
+            data.l[i] = values[i];
+            break;
+
+        default:
+            fprintf(stderr, "unexpected size for property %s\n", name);
+            free(data.c);
+            return false;
+      }
+    }
+
+    XChangeDeviceProperty(display, it->second, prop, XA_INTEGER, format,
+                          PropModeReplace, data.c, values.size());
+    free(data.c);
+    return true;
+#endif // HAVE_XI_PROP
+}
+
+void XlibServer::sync()
+{
+    XSync(display, False);
+}
+
+int XlibServer::screen_rotation()
+{
+#ifdef HAVE_X11_XRANDR
+    Rotation current = RR_Rotate_0;
+    XRRRotations(display, DefaultScreen(display), &current);
+    return current;
+#else
+    return SCREEN_ROTATE_0;
+#endif
+}
+
+bool XlibServer::has_screen_changes()
+{
+#ifdef HAVE_X11_XRANDR
+    int event_base, error_base;
+    return XRRQueryExtension(display, &event_base, &error_base);
+#else
+    return false;
+#endif
+}
+
+bool XlibServer::wait_screen_change(int& rotation)
+{
+#ifndef HAVE_X11_XRANDR
+    return false;
+#else
+    int event_base, error_base;
+    if (!XRRQueryExtension(display, &event_base, &error_base))
+        return false;
+
+    if (!screen_changes_selected) {
+        XRRSelectInput(display, DefaultRootWindow(display), RRScreenChangeNotifyMask);
+        screen_changes_selected = true;
+    }
+
+    while (true) {
+        XEvent event;
+        XNextEvent(display, &event);
+        if (event.type == event_base + RRScreenChangeNotify) {
+            XRRUpdateConfiguration(&event);
+            rotation = ((XRRScreenChangeNotifyEvent*) &event)->rotation;
+            return true;
+        }
+    }
+#endif
+}
+
+std::string XlibServer::vendor()
+{
+    return ServerVendor(display);
+}
+
+int XlibServer::vendor_release()
+{
+    return VendorRelease(display);
+}
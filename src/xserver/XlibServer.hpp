@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 The xinput_calibrator authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef XLIB_SERVER_HPP
+#define XLIB_SERVER_HPP
+
+#include "xserver/XServer.hpp"
+
+#include <map>
+#include <X11/Xlib.h>
+#include <X11/extensions/XInput.h>
+
+/***************************************
+ * XServer on the $DISPLAY, through Xlib/libXi
+ *
+ * Devices are queried with XInput 2 (XIQueryDevice) when both
+ * libXi and the server have it, with XListInputDevices otherwise.
+ ***************************************/
+class XlibServer : public XServer
+{
+public:
+    XlibServer();
+    virtual ~XlibServer();
+
+    virtual bool is_connected() const
+    { return display != NULL; }
+
+    virtual bool query_xinput(int& major, int& minor);
+    virtual std::vector<XInputDevice> list_devices();
+    virtual bool query_device(XID id, XInputDevice& dev);
+    virtual bool open_device(XID id);
+    virtual bool get_int_property(XID id, const char* name,
+                                  int& format, std::vector<long>& values);
+    virtual bool set_int_property(XID id, const char* name,
+                                  int format, const std::vector<long>& values);
+    virtual void sync();
+    virtual int screen_rotation();
+    virtual bool has_screen_changes();
+    virtual bool wait_screen_change(int& rotation);
+    virtual std::string vendor();
+    virtual int vendor_release();
+
+private:
+    Atom parse_atom(const char* name);
+    /// whether XInput 2 can be used, announces it to the server on first use
+    bool has_xi2();
+
+    Display* display;
+    /// has_xi2(): -1 unknown, 0 no, 1 yes
+    int xi2;
+    /// the first error code of XInput, set by has_xi2()
+    int xi_error_base;
+    /// whether RRScreenChangeNotify events are selected
+    bool screen_changes_selected;
+    /// opened devices
+    std::map<XID, XDevice*> devices;
+};
+
+#endif